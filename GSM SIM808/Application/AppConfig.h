@@ -9,6 +9,9 @@
 #include "../HAL/Inc/LCD_I2C.h"
 #include "../MCAL/Inc/USART.h"
 #include "../HAL/Inc/GSM_SIM808.h"
+#include "../HAL/Inc/Power.h"
+#include "../HAL/Inc/Supply.h"
+#include "../HAL/Inc/Recovery.h"
 
 #ifndef MAIN_H_
 #define MAIN_H_
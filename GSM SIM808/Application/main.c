@@ -20,7 +20,7 @@ LCD_I2C_t I2C_LCD1 =
 
 USART_Config_t USART1 =
 {
-	.USART_BaudRate          = USART_115200bps,
+	.USART_BaudRate          = USART_38400bps,
 	.USART_Channel           = USART_CHANNEL1,
 	.USART_DataSize          = USART_8BitsDataSize,
 	.USART_InterruptStatus   = USART_InterruptEnabled,
@@ -32,7 +32,7 @@ USART_Config_t USART1 =
 
 USART_Config_t GSM_UART =
 {
-	.USART_BaudRate          = USART_115200bps,
+	.USART_BaudRate          = USART_38400bps,
 	.USART_Channel           = USART_CHANNEL0,
 	.USART_DataSize          = USART_8BitsDataSize,
 	.USART_InterruptStatus   = USART_InterruptEnabled,
@@ -42,6 +42,16 @@ USART_Config_t GSM_UART =
 	.USART_EndCharacter      = '\n'
 };
 
+ADC_Channel SupplyADC =
+{
+	.ResultAdjust     = Right_Adjusted,
+	.Prescaller       = CLK_32,
+	.VoltageReference = External_AVCC,
+	.InturruptMode    = ADCInterruptEnabled
+};
+
+static const ADC_Index ScanChannels[] = { SUPPLY_ADC_CHANNEL };
+
 const uint8 SmilecustomChar[] =
 {
 	0x00,
@@ -54,6 +64,27 @@ const uint8 SmilecustomChar[] =
 	0x00
 };
 
+/* Modem setup, run at startup and again by Recovery after a modem reset, which already restarted it */
+static Std_ReturnType App_ModemInit(boolean Restart)
+{
+	Std_ReturnType ret = (Restart == TRUE) ? GSM_Init(&GSM_UART, &USART1, PROFILE_AUTO)      /* APN picked from the SIM, or force an operator */
+	                                       : GSM_Reinit(&GSM_UART, &USART1, PROFILE_AUTO);
+
+	GSM_NegotiateBaudRate(&GSM_UART, NULL);                               /* Move the modem link to the best clean rate for F_CPU */
+	return ret;
+}
+
+static Std_ReturnType App_ModemRecovered(void)
+{
+	Std_ReturnType ret = App_ModemInit(FALSE);
+
+	if (ret == E_OK)
+	{
+		ret = Power_Init(&GSM_UART);                                      /* AT+CSCLK=1 is lost with the reset */
+	}
+	return ret;
+}
+
 const uint8 HeartcustomChar[] =
 {
 	0x00,
@@ -68,29 +99,32 @@ const uint8 HeartcustomChar[] =
 
 int main(void)
 {
+	Timer_Init();                                                 /* Time base for the trace stamps */
+	Trace_Init();
 	LCD_I2C_Init(&I2C_LCD1);
 	
 	LCD_I2C_WriteCustomChar(&I2C_LCD1, 1, 1, HeartcustomChar, 0);
-	LCD_I2C_WriteStringInPos(&I2C_LCD1, 1, 3, (const uint8*)"Welcome David");
+	LCD_I2C_WriteStringInPos_P(&I2C_LCD1, 1, 3, PSTR("Welcome David"));
 	LCD_I2C_WriteCustomChar(&I2C_LCD1, 1, 16, SmilecustomChar, 1);
 	_delay_ms(1500);
 	
-	/* Connect a UART module and set the termite baudrate 115200bps and end characters to Append CR-LF */
+	/* Connect a UART module and set the termite baudrate 38400bps and end characters to Append CR-LF */
 	USART_Init(&USART1);  
+	Log_Init(&USART1);                                            /* Debug lines are queued and sent when USART1 is idle */
 	
-	USART_Transmit_String(&USART1, (const uint8*)"\nGSM Module \nInitializing... \n");
+	USART_Transmit_String_P(&USART1, PSTR("\nGSM Module \nInitializing... \n"));
 	_delay_ms(1500);
 	
 	/* Connect the GSM module */
-	GSM_Init(&GSM_UART, &USART1, VODAFONE);                       /* Choose your SIM Operator */
+	App_ModemInit(TRUE);                                          /* A modem that does not come up is handled by Recovery_Process() */
+	Recovery_Init(&GSM_UART, App_ModemRecovered);                 /* AT probe, AT+CFUN=1,1 and PWRKEY cycle on a silent modem */
 	
 	USART_StringStatus_t GSMString_Status = USART_StringUnavailable;
-	USART_StringStatus_t UARTString_Status = USART_StringUnavailable;
+	Std_ReturnType GSMByte_Status = E_NOT_OK;
 	
-	uint8 GSMString[512];
-	uint8 UARTString[512];
-	LCD_I2C_WriteStringInPos(&I2C_LCD1, 2, 1, (const uint8*)"GSM Module Ready");
-	USART_Transmit_String(&USART1, (const uint8*)"\nGSM Module Ready\n");	
+	uint8 GSMString[256];
+	LCD_I2C_WriteStringInPos_P(&I2C_LCD1, 2, 1, PSTR("GSM Module Ready"));
+	USART_Transmit_String_P(&USART1, PSTR("\nGSM Module Ready\n"));	
 
     /* Establish a GPRS connection */
 	GSM_OpenGPRS(&GSM_UART);
@@ -102,42 +136,49 @@ int main(void)
 	
 	GSM_SendSMS(&GSM_UART, (const uint8*)"+201xxxxxxxx", (const uint8*)"Message From SIM808 By David");   /* Send Message to a specific number */
 	_delay_ms(2500);
-	GSM_MakeCall(&GSM_UART, (const uint8*)"+201xxxxxxxxx");                                               /* make a call to a specific number */
-	
+	GSM_MakeCall(&GSM_UART, (const uint8*)"+201xxxxxxxxx");                                               /* make a call to a specific number */
+	
+	/* Termite pass-through handled by the RX ISRs, the modem lines are still tapped for the URCs below */
+	USART_SetBridge(&USART1, USART_BridgeForward);
+	USART_SetBridge(&GSM_UART, USART_BridgeTap);
+	
+	Power_Init(&GSM_UART);                                        /* Modem slow clock under DTR, woken before each command */
+	
+	ADC_Init(&SupplyADC);
+	ADC_ScanStart(ScanChannels, 1, ADC_ScanOnDemand);            /* VBAT divider, one round per Supply_Process() */
+	Supply_Init(&GSM_UART, 0);                                    /* Defers large TCP sends while the supply sags */
+	
 	while (1)
 	{
-		USART_Receive_String(&GSM_UART, GSMString);                   /* Receive from GSM */
-		USART_Receive_String(&USART1, UARTString);                    /* Receive from UART */
-		
+		Trace_Drain(&USART1);                                         /* Trace frames go out while the debug TX ring has room */
+		Log_Process();
+		Power_Process();
+		Supply_Process();
+		Recovery_Process();                                           /* Silent modem: one recovery step per pass, watchdog armed */
+		GSMByte_Status = USART_Receive_String(&GSM_UART, GSMString);  /* Receive from GSM */
 		USART_StringReady(&GSM_UART, &GSMString_Status);
-		USART_StringReady(&USART1, &UARTString_Status);
 
 		if (GSMString_Status == USART_StringAvailable)
 		{
-			USART_Transmit_String(&USART1, GSMString);
+			GSM_DispatchURC(GSMString);                               /* UNDER-VOLTAGE and GNSS reports arrive between commands too */
 			
-			if (strstr((char*)GSMString, "+CMTI: \"SM\"") != NULL)  
-			{
-				LCD_I2C_WriteStringInPos(&I2C_LCD1, 2, 1, (const uint8*)" New Message !  ");    /* Display new message */
+			if (strstr_P((char*)GSMString, PSTR("+CMTI: \"SM\"")) != NULL)  
+			{
+				LCD_I2C_WriteStringInPos_P(&I2C_LCD1, 2, 1, PSTR(" New Message !  "));          /* Display new message */
 				_delay_ms(1000);
 				GSM_ReceiveSMS(&GSM_UART);
 			}
-			else if (strstr((char*)GSMString, "RING") != NULL)
+			else if (strstr_P((char*)GSMString, PSTR("RING")) != NULL)
 			{
-				LCD_I2C_WriteStringInPos(&I2C_LCD1, 2, 1, (const uint8*)" Incoming Call  ");    /* Display new call, to respond a call send ATA through the termite or ATH to reject the call*/
+				LCD_I2C_WriteStringInPos_P(&I2C_LCD1, 2, 1, PSTR(" Incoming Call  "));          /* Display new call, to respond a call send ATA through the termite or ATH to reject the call*/
 			}
 
-			/* Ensure String is properly null-terminated */
-			memset(GSMString, 0, sizeof(GSMString));
 			GSMString_Status = USART_StringUnavailable;
 		}
 		
-	    if (UARTString_Status == USART_StringAvailable)
+		if (GSMByte_Status != E_OK)
 		{
-			USART_Transmit_String(&GSM_UART, UARTString);
-			/* Ensure String is properly null-terminated */
-			memset(UARTString, 0, sizeof(UARTString));
-			UARTString_Status = USART_StringUnavailable;
+			Power_Idle();                                             /* Nothing queued, sleep until the next byte or tick */
 		}
 	}
 	
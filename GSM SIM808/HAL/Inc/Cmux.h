@@ -0,0 +1,68 @@
+
+/********************************************************************************************************
+ *  [FILE NAME]   :      <Cmux.h>                                                                       *
+ *  [AUTHOR]      :      <David S. Alexander>                                                           *
+ *  [DATE CREATED]:      <Oct 18, 2026>                                                                 *
+ *  [Description] :      <Header file for the GSM 07.10 basic mode multiplexer>                         *
+ ********************************************************************************************************/
+
+
+#ifndef CMUX_H_
+#define CMUX_H_
+
+/*******************************************************************************
+ *                                 Includes                                    *
+ *******************************************************************************/
+
+#include "GSM_SIM808.h"
+
+/*******************************************************************************
+ *                             Macro Declarations                              *
+ *******************************************************************************/
+
+#define CMUX_DLCS                 USART_VIRTUAL_CHANNELS   /* DLCI 1..CMUX_DLCS are USART_CHANNEL_VIRTUAL0.. */
+#define CMUX_FRAME_MAX            31           /* N1, the 07.10 default for AT+CMUX=0, longest info field sent */
+#define CMUX_RX_BUFFER_SIZE       128          /* Per DLC, uint8 ring indices, power of two <= 256 */
+#define CMUX_FC_HIGH_WATER        (CMUX_RX_BUFFER_SIZE - 48)   /* MSC FC=1 above, the gap absorbs frames in flight */
+#define CMUX_FC_LOW_WATER         (CMUX_RX_BUFFER_SIZE / 4)    /* MSC FC=0 once drained below */
+#define CMUX_CONTROL_MAX          8            /* Longest control channel message handled */
+#define CMUX_T1_MS                300          /* Wait for UA per SABM */
+#define CMUX_N2                   3            /* SABM attempts per DLC */
+#define CMUX_TX_STALL_MS          GSM_TX_STALL_MS   /* Longest wait for room in the USART TX ring per frame */
+
+#if CMUX_DLCS < 1
+#error "CMUX needs USART_VIRTUAL_CHANNELS >= 1"
+#endif
+
+/* Channel roles, each one is a regular USART channel for the rest of the driver */
+#define CMUX_DLC_AT               USART_CHANNEL_VIRTUAL0
+#define CMUX_DLC_DATA             USART_CHANNEL_VIRTUAL1
+#define CMUX_DLC_GNSS             USART_CHANNEL_VIRTUAL2
+
+/* USART_Config_t initializer for a DLC, e.g. USART_Config_t GSM_AT = CMUX_USART_CONFIG(CMUX_DLC_AT) */
+#define CMUX_USART_CONFIG(CHANNEL)     { .USART_Channel = (CHANNEL), .USART_InterruptStatus = USART_InterruptEnabled, \
+                                         .USART_OperationMode = USART_AsynchronousMode, .USART_EndCharacter = '\n' }
+
+/*******************************************************************************
+ *                         Data Types Declaration                              *
+ *******************************************************************************/
+
+typedef enum
+{
+	CMUX_Closed,
+	CMUX_Opening,
+	CMUX_Open
+
+} Cmux_State_t;
+
+/*******************************************************************************
+ *                            Functions Declaration                            *
+ *******************************************************************************/
+
+Std_ReturnType Cmux_Start(const USART_Config_t *USART);
+Std_ReturnType Cmux_Stop(void);
+Std_ReturnType Cmux_Process(void);
+Cmux_State_t   Cmux_GetState(USART_Channel_t Channel);
+uint16         Cmux_GetDropped(USART_Channel_t Channel);
+
+#endif /* CMUX_H_ */
@@ -0,0 +1,75 @@
+
+/********************************************************************************************************
+ *  [FILE NAME]   :      <GNSS_SIM808.h>                                                                *
+ *  [AUTHOR]      :      <David S. Alexander>                                                           *
+ *  [DATE CREATED]:      <Oct 18, 2026>                                                                 *
+ *  [Description] :      <Header file for the SIM808 GNSS receiver driver>                              *
+ ********************************************************************************************************/
+
+
+#ifndef GNSS_SIM808_H_
+#define GNSS_SIM808_H_
+
+/*******************************************************************************
+ *                                 Includes                                    *
+ *******************************************************************************/
+
+#include "GSM_SIM808.h"
+
+/*******************************************************************************
+ *                             Macro Declarations                              *
+ *******************************************************************************/
+
+#define GNSS_COORDINATE_SCALE   1000000L       /* Latitude/Longitude are degrees * 1e6 */
+#define GNSS_COS_STEP           10000000L      /* Cosine table step, 10 degrees */
+#define GNSS_COS_MIN            5000           /* Cosine clamp near the poles (~81 degrees) */
+
+/* Equirectangular projection of a degrees * 1e6 delta into meters (0.11132 m per unit in Q9) */
+#define GNSS_UDEG_TO_METERS(DELTA)   (((sint32)(DELTA) * 57L) >> 9)
+
+/*******************************************************************************
+ *                         Data Types Declaration                              *
+ *******************************************************************************/
+
+typedef enum
+{
+	GNSS_NoFix,
+	GNSS_FixValid
+
+} GNSS_FixStatus_t;
+
+/* Fixed-point copy of one +CGNSINF / +UGNSINF report */
+typedef struct
+{
+	GNSS_FixStatus_t                     GNSS_Status;
+	uint8                                GNSS_Sequence;          /* Incremented on every parsed report */
+	uint16                               GNSS_Year;
+	uint8                                GNSS_Month;
+	uint8                                GNSS_Day;
+	uint8                                GNSS_Hour;
+	uint8                                GNSS_Minute;
+	uint8                                GNSS_Second;
+	sint32                               GNSS_Latitude;          /* Degrees * 1e6, north positive */
+	sint32                               GNSS_Longitude;         /* Degrees * 1e6, east positive */
+	sint32                               GNSS_Altitude;          /* Meters * 10 above MSL */
+	uint16                               GNSS_Speed;             /* km/h * 100 */
+	uint16                               GNSS_Course;            /* Degrees * 100 */
+	uint16                               GNSS_HDOP;              /* HDOP * 100 */
+	uint8                                GNSS_SatellitesInView;
+	uint8                                GNSS_SatellitesUsed;
+
+} GNSS_Fix_t;
+
+/*******************************************************************************
+ *                            Functions Declaration                            *
+ *******************************************************************************/
+
+Std_ReturnType GNSS_Init(const USART_Config_t *USART, uint8 URCPeriod);
+Std_ReturnType GNSS_PowerOff(const USART_Config_t *USART);
+Std_ReturnType GNSS_Update(const USART_Config_t *USART);
+Std_ReturnType GNSS_ParseLine(const uint8 *line);
+Std_ReturnType GNSS_GetFix(GNSS_Fix_t *Fix);
+Std_ReturnType GNSS_GetPosition(sint32 *Latitude, sint32 *Longitude);
+uint16         GNSS_CosLatitude(sint32 Latitude);
+
+#endif /* GNSS_SIM808_H_ */
@@ -15,6 +15,10 @@
  *******************************************************************************/
 
 #include "../../MCAL/Inc/USART.h"
+#include "../../MCAL/Inc/EEPROM.h"
+#include "../../MCAL/Inc/Trace.h"
+#include "../../MCAL/Inc/Watchdog.h"
+#include "Log.h"
 #include <string.h>
 #include "stdio.h"
 
@@ -22,6 +26,22 @@
  *                             Macro Declarations                              *
  *******************************************************************************/
 
+#define GSM_MAX_URC_HANDLERS   6
+#define GSM_APN_CACHE_ADDRESS  0x0F00       /* 6 bytes in the EEPROM settings area above the Outbox */
+#define GSM_BAUD_ERROR_LIMIT   USART_BAUD_ERROR_WARN   /* Per mille accepted by GSM_NegotiateBaudRate() */
+#define GSM_BAUD_PROBES        3            /* AT attempts per rate while syncing */
+#define GSM_TX_STALL_MS        1000         /* Longest wait for room in the TX ring while pushing a payload */
+#define GSM_TRAILER_MS         100          /* Wait for the OK behind a matched "+CMD:" information response */
+#define GSM_LINE_SIZE          256          /* Longest modem line kept, the rest of a longer one is dropped */
+#define GSM_TCP_RX_BUFFER_SIZE 256          /* +IPD payload held for GSM_TCP_Receive(), power of two */
+
+#define GSM_RTO_ADDRESS        0x0F08       /* 4 bytes per GSM_CmdClass_t and a check byte, after the APN cache */
+#define GSM_RTO_SAVE_INTERVAL  3600000UL    /* Minimum ms between two EEPROM saves of the learned timeouts */
+#define GSM_RTO_SAVE_CHANGE    4            /* A class timeout must move by more than 1/4 of the saved one to be saved */
+#define GSM_RTO_BACKOFF_MAX    2            /* Timeout doublings after late answers, cleared by the next answer */
+
+#define GSM_ERR_ANY            0xFFFF       /* GSM_RetryTable code matching every code of its result kind */
+
 
 /*******************************************************************************
  *                         Data Types Declaration                              *
@@ -33,22 +53,139 @@ typedef enum
 	ORANGE,
 	ETISALAT,
 	VODAFONE,
-	PROFILE_INVALID
+	PROFILE_INVALID,
+	PROFILE_AUTO                        /* Operator detected from the SIM, see GSM_DetectAPN() */
 	
 } APN_Profile_t;
 
+typedef enum
+{
+	GSM_TCP_Closed,
+	GSM_TCP_Connected
+	
+} GSM_TCPState_t;
+
+/*
+ * Commands with a similar answer time share one adaptive timeout, learned
+ * like a TCP retransmission timeout from the latency of their answers.
+ */
+typedef enum
+{
+	GSM_CLASS_Local,                    /* Settings answered by the modem itself, ATE1, AT+CMGF */
+	GSM_CLASS_Query,                    /* SIM and buffer reads, AT+CIMI, AT+COPS?, AT+HTTPREAD */
+	GSM_CLASS_Network,                  /* Calls and SMS, ATD, AT+CMGS */
+	GSM_CLASS_Data,                     /* Payload round trips, SEND OK, +HTTPACTION */
+	GSM_CLASS_Bearer,                   /* PDP context and connection setup, AT+CIICR, CONNECT OK */
+	GSM_CLASS_COUNT
+
+} GSM_CmdClass_t;
+
+typedef struct
+{
+	uint16                               SmoothedMs;             /* EWMA of the answer time, 0 before the first answer */
+	uint16                               DeviationMs;            /* EWMA of the deviation from SmoothedMs */
+	uint32                               TimeoutMs;              /* Timeout the next wait of the class uses */
+	uint8                                Backoff;                /* Doublings after late answers */
+
+} GSM_Latency_t;
+
+/* How the last GSM wait ended, see GSM_GetResult() */
+typedef enum
+{
+	GSM_RESULT_Expected,                /* The awaited answer arrived */
+	GSM_RESULT_Ok,                      /* OK without the awaited answer */
+	GSM_RESULT_Error,                   /* Plain ERROR, a syntax or state error */
+	GSM_RESULT_CmeError,                /* +CME ERROR: <n>, equipment and network errors */
+	GSM_RESULT_CmsError,                /* +CMS ERROR: <n>, SMS errors */
+	GSM_RESULT_Timeout,
+	GSM_RESULT_Preempted                /* Gave way to urgent work, see GSM_SetPreempt() */
+
+} GSM_ResultKind_t;
+
+/* Numeric codes of AT+CMEE=1, the ones the driver meets in practice */
+typedef enum
+{
+	GSM_ERR_PhoneFailure       = 0,     /* +CME ERROR */
+	GSM_ERR_NotAllowed         = 3,
+	GSM_ERR_NotSupported       = 4,
+	GSM_ERR_SimNotInserted     = 10,
+	GSM_ERR_SimPinRequired     = 11,
+	GSM_ERR_SimPukRequired     = 12,
+	GSM_ERR_SimFailure         = 13,
+	GSM_ERR_SimBusy            = 14,
+	GSM_ERR_MemoryFull         = 20,
+	GSM_ERR_InvalidIndex       = 21,
+	GSM_ERR_NotFound           = 22,
+	GSM_ERR_NoNetwork          = 30,
+	GSM_ERR_NetworkTimeout     = 31,
+	GSM_ERR_EmergencyOnly      = 32,
+	GSM_ERR_Unknown            = 100,
+	GSM_ERR_SmsMeFailure       = 300,   /* +CMS ERROR */
+	GSM_ERR_SmsNotAllowed      = 302,
+	GSM_ERR_SmsSimNotInserted  = 310,
+	GSM_ERR_SmsSimBusy         = 314,
+	GSM_ERR_SmsMemoryFull      = 322,
+	GSM_ERR_SmsSmscUnknown     = 330,
+	GSM_ERR_SmsNoNetwork       = 331,
+	GSM_ERR_SmsNetworkTimeout  = 332,
+	GSM_ERR_SmsUnknown         = 500
+
+} GSM_Error_t;
+
+typedef struct
+{
+	GSM_ResultKind_t                     Kind;
+	uint16                               Code;                   /* GSM_Error_t for +CME and +CMS errors, else 0 */
+	uint8                                Retries;                /* Resends by the GSM_RetryTable policy */
+
+} GSM_Result_t;
+
+/* Prefixes passed to GSM_RegisterURC() are flash strings, e.g. PSTR("+CMTI:") */
+typedef void (*GSM_URCHandler_t)(const uint8 *line);
+
+/* Asked before every TCP send, FALSE defers a payload of Length bytes */
+typedef boolean (*GSM_SendGate_t)(uint16 Length);
+
+/* Asked during long interruptible operations, TRUE makes them give way to urgent work */
+typedef boolean (*GSM_Preempt_t)(void);
+
 /*******************************************************************************
  *                            Functions Declaration                            *
  *******************************************************************************/
 
 Std_ReturnType GSM_Init(const USART_Config_t *USART, const USART_Config_t *DEBUG_UART, APN_Profile_t Profile);
+Std_ReturnType GSM_Reinit(const USART_Config_t *USART, const USART_Config_t *DEBUG_UART, APN_Profile_t Profile);
 Std_ReturnType GSM_WaitForResponse(const USART_Config_t *USART, const char *expectedResponse, uint32 timeout);
+Std_ReturnType GSM_WaitForResponse_P(const USART_Config_t *USART, const char *expectedResponse, uint32 timeout);
+Std_ReturnType GSM_WaitForClass_P(const USART_Config_t *USART, const char *expectedResponse, GSM_CmdClass_t Class);
+Std_ReturnType GSM_Command_P(const USART_Config_t *USART, const char *Command, const char *expectedResponse, GSM_CmdClass_t Class);
+Std_ReturnType GSM_GetResult(GSM_Result_t *Result);
+uint32         GSM_GetTimeout(GSM_CmdClass_t Class);
+Std_ReturnType GSM_GetLatency(GSM_CmdClass_t Class, GSM_Latency_t *Latency);
+Std_ReturnType GSM_SyncBaudRate(const USART_Config_t *USART);
+Std_ReturnType GSM_NegotiateBaudRate(const USART_Config_t *USART, uint32 *BaudRate);
 Std_ReturnType GSM_SetAPNProfile(const USART_Config_t *USART, APN_Profile_t Profile);
+Std_ReturnType GSM_DetectAPN(const USART_Config_t *USART, boolean Force);
 Std_ReturnType GSM_MakeCall(const USART_Config_t *USART, const uint8* number);
 Std_ReturnType GSM_SendSMS(const USART_Config_t *USART, const uint8* number, const uint8* message);
 Std_ReturnType GSM_CheckNewSMS(const USART_Config_t *USART, const uint8 *buffer, uint8* State);
 Std_ReturnType GSM_ReceiveSMS(const USART_Config_t *USART);
 Std_ReturnType GSM_OpenGPRS(const USART_Config_t *USART);
 Std_ReturnType GSM_GetGPRS_Response(const USART_Config_t *USART);
+Std_ReturnType GSM_WaitForPrompt(const USART_Config_t *USART, uint32 timeout);
+Std_ReturnType GSM_TCP_Open(const USART_Config_t *USART, const uint8 *host, uint16 port);
+Std_ReturnType GSM_TCP_Send(const USART_Config_t *USART, const uint8 *data, uint16 length);
+Std_ReturnType GSM_TCP_Receive(const USART_Config_t *USART, uint8 *data, uint16 size, uint16 *length);
+Std_ReturnType GSM_TCP_GetState(GSM_TCPState_t *State);
+Std_ReturnType GSM_TCP_Close(const USART_Config_t *USART);
+Std_ReturnType GSM_SetSendGate(GSM_SendGate_t Gate);
+boolean        GSM_SendAllowed(uint16 Length);
+Std_ReturnType GSM_SetPreempt(GSM_Preempt_t Preempt);
+boolean        GSM_Preempted(void);
+boolean        GSM_Busy(void);
+Std_ReturnType GSM_RegisterURC(const char *prefix, GSM_URCHandler_t handler);
+Std_ReturnType GSM_DispatchURC(const uint8 *line);
+uint8          GSM_GetTimeouts(void);
+uint32         GSM_LastHeard(void);
 
 #endif /* GSM_SIM808_H_ */
\ No newline at end of file
@@ -0,0 +1,77 @@
+
+/********************************************************************************************************
+ *  [FILE NAME]   :      <Geofence.h>                                                                   *
+ *  [AUTHOR]      :      <David S. Alexander>                                                           *
+ *  [DATE CREATED]:      <Oct 18, 2026>                                                                 *
+ *  [Description] :      <Header file for the fixed-point geofence evaluator>                           *
+ ********************************************************************************************************/
+
+
+#ifndef GEOFENCE_H_
+#define GEOFENCE_H_
+
+/*******************************************************************************
+ *                                 Includes                                    *
+ *******************************************************************************/
+
+#include "GNSS_SIM808.h"
+
+/*******************************************************************************
+ *                             Macro Declarations                              *
+ *******************************************************************************/
+
+#define GEOFENCE_MAX_FENCES       16           /* Bounding boxes are cached in SRAM, 16 bytes per fence */
+#define GEOFENCE_MAX_RADIUS       40000UL      /* Meters, keeps dx^2 + dy^2 inside 32 bits */
+#define GEOFENCE_MAX_SPAN         500000L      /* Polygon vertex distance from any inside point, degrees * 1e6 */
+
+/* Flash table helpers, coordinates are degrees * 1e6 as in GNSS_Fix_t */
+#define GEOFENCE_CIRCLE(LAT, LON, RADIUS)      { GEOFENCE_Circle,  0, (RADIUS), { (LAT), (LON) }, NULL }
+#define GEOFENCE_POLYGON(VERTICES, COUNT)      { GEOFENCE_Polygon, (COUNT), 0, { 0, 0 }, (VERTICES) }
+
+/*******************************************************************************
+ *                         Data Types Declaration                              *
+ *******************************************************************************/
+
+typedef enum
+{
+	GEOFENCE_Circle,
+	GEOFENCE_Polygon
+
+} Geofence_Type_t;
+
+typedef enum
+{
+	GEOFENCE_Enter,
+	GEOFENCE_Exit
+
+} Geofence_Event_t;
+
+typedef struct
+{
+	sint32                               Latitude;
+	sint32                               Longitude;
+
+} Geofence_Point_t;
+
+/* One fence as stored in flash */
+typedef struct
+{
+	Geofence_Type_t                      Type;
+	uint8                                VertexCount;            /* Polygon only */
+	uint32                               Radius;                 /* Circle only, meters */
+	Geofence_Point_t                     Center;                 /* Circle only */
+	const Geofence_Point_t              *Vertices;               /* Polygon only, PROGMEM array */
+
+} Geofence_t;
+
+typedef void (*Geofence_Callback_t)(uint8 FenceIndex, Geofence_Event_t Event);
+
+/*******************************************************************************
+ *                            Functions Declaration                            *
+ *******************************************************************************/
+
+Std_ReturnType Geofence_Init(const Geofence_t *Fences, uint8 Count, Geofence_Callback_t Callback);
+Std_ReturnType Geofence_Evaluate(const GNSS_Fix_t *Fix);
+Std_ReturnType Geofence_IsInside(uint8 FenceIndex, boolean *Inside);
+
+#endif /* GEOFENCE_H_ */
@@ -81,6 +81,8 @@ Std_ReturnType LCD_I2C_WriteChar(const LCD_I2C_t *LCD, uint8 Data);
 Std_ReturnType LCD_I2C_WriteCharInPos(const LCD_I2C_t *LCD,uint8 Row, uint8 Column, uint8 Data);
 Std_ReturnType LCD_I2C_WriteString(const LCD_I2C_t *LCD, const uint8 *Str);
 Std_ReturnType LCD_I2C_WriteStringInPos(const LCD_I2C_t *LCD, uint8 Row, uint8 Column, const uint8 *Str);
+Std_ReturnType LCD_I2C_WriteString_P(const LCD_I2C_t *LCD, const char *Str);
+Std_ReturnType LCD_I2C_WriteStringInPos_P(const LCD_I2C_t *LCD, uint8 Row, uint8 Column, const char *Str);
 Std_ReturnType LCD_I2C_WriteCustomChar(const LCD_I2C_t *LCD, uint8 Row, uint8 Column, const uint8 ArrChar[], uint8 MemPos);
 Std_ReturnType LCD_I2C_WriteInteger(const LCD_I2C_t *LCD, sint32 Num);
 Std_ReturnType LCD_I2C_WriteIntegerInPos(const LCD_I2C_t *LCD, uint8 Row, uint8 Column, sint32 Num);
@@ -0,0 +1,99 @@
+
+/********************************************************************************************************
+ *  [FILE NAME]   :      <Log.h>                                                                        *
+ *  [AUTHOR]      :      <David S. Alexander>                                                           *
+ *  [DATE CREATED]:      <Oct 18, 2026>                                                                 *
+ *  [Description] :      <Header file for the deferred leveled debug log>                               *
+ ********************************************************************************************************/
+
+
+#ifndef LOG_H_
+#define LOG_H_
+
+/*******************************************************************************
+ *                                 Includes                                    *
+ *******************************************************************************/
+
+#include "../../MCAL/Inc/USART.h"
+#include <stdio.h>
+
+/*******************************************************************************
+ *                             Macro Declarations                              *
+ *******************************************************************************/
+
+#define LOG_LEVEL_NONE            0
+#define LOG_LEVEL_ERROR           1
+#define LOG_LEVEL_WARN            2
+#define LOG_LEVEL_INFO            3
+#define LOG_LEVEL_DEBUG           4
+
+#ifndef LOG_LEVEL
+#define LOG_LEVEL                 LOG_LEVEL_DEBUG      /* LOG_LEVEL_WARN for production, lower levels compile out */
+#endif
+
+#define LOG_MODULES               LOG_ALL              /* Modules compiled in, Log_SetMask() narrows it at run time */
+#define LOG_BUFFER_SIZE           256                  /* uint8 ring indices, power of two <= 256 */
+#define LOG_LINE_MAX              80                   /* Longer RAM lines are cut */
+#define LOG_DRAIN_MAX             64                   /* Bytes handed to the debug UART per Log_Process() */
+
+#define LOG_WRITE_(LEVEL, MODULE, TEXT, LINE)  do { if (((MODULE) & LOG_MODULES) != 0) Log_Write((LEVEL), (MODULE), PSTR(TEXT), (LINE)); } while (0)
+#define LOG_NONE_(MODULE, TEXT, LINE)          do { } while (0)
+
+/* TEXT is a string literal kept in flash, LINE is a RAM string appended up to its CR/LF */
+#if LOG_LEVEL >= LOG_LEVEL_ERROR
+#define LOG_ERROR_LINE(MODULE, TEXT, LINE)     LOG_WRITE_(LOG_LEVEL_ERROR, MODULE, TEXT, LINE)
+#else
+#define LOG_ERROR_LINE(MODULE, TEXT, LINE)     LOG_NONE_(MODULE, TEXT, LINE)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_WARN
+#define LOG_WARN_LINE(MODULE, TEXT, LINE)      LOG_WRITE_(LOG_LEVEL_WARN, MODULE, TEXT, LINE)
+#else
+#define LOG_WARN_LINE(MODULE, TEXT, LINE)      LOG_NONE_(MODULE, TEXT, LINE)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_INFO
+#define LOG_INFO_LINE(MODULE, TEXT, LINE)      LOG_WRITE_(LOG_LEVEL_INFO, MODULE, TEXT, LINE)
+#else
+#define LOG_INFO_LINE(MODULE, TEXT, LINE)      LOG_NONE_(MODULE, TEXT, LINE)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_DEBUG
+#define LOG_DEBUG_LINE(MODULE, TEXT, LINE)     LOG_WRITE_(LOG_LEVEL_DEBUG, MODULE, TEXT, LINE)
+#else
+#define LOG_DEBUG_LINE(MODULE, TEXT, LINE)     LOG_NONE_(MODULE, TEXT, LINE)
+#endif
+
+#define LOG_ERROR(MODULE, TEXT)                LOG_ERROR_LINE(MODULE, TEXT, NULL)
+#define LOG_WARN(MODULE, TEXT)                 LOG_WARN_LINE(MODULE, TEXT, NULL)
+#define LOG_INFO(MODULE, TEXT)                 LOG_INFO_LINE(MODULE, TEXT, NULL)
+#define LOG_DEBUG(MODULE, TEXT)                LOG_DEBUG_LINE(MODULE, TEXT, NULL)
+
+/*******************************************************************************
+ *                         Data Types Declaration                              *
+ *******************************************************************************/
+
+/* One bit per module, the name table in Log.c follows the bit order */
+typedef enum
+{
+	LOG_GSM   = 0x01,
+	LOG_GNSS  = 0x02,
+	LOG_MQTT  = 0x04,
+	LOG_TRACK = 0x08,
+	LOG_APP   = 0x10,
+	LOG_POWER = 0x20,
+	LOG_ALL   = 0x3F
+
+} Log_Module_t;
+
+/*******************************************************************************
+ *                            Functions Declaration                            *
+ *******************************************************************************/
+
+Std_ReturnType Log_Init(const USART_Config_t *USART);
+void           Log_SetMask(uint8 Mask);
+Std_ReturnType Log_Write(uint8 Level, uint8 Module, const char *Text, const uint8 *Line);
+Std_ReturnType Log_Process(void);
+uint16         Log_GetDropped(void);
+
+#endif /* LOG_H_ */
@@ -0,0 +1,97 @@
+
+/********************************************************************************************************
+ *  [FILE NAME]   :      <MQTT.h>                                                                       *
+ *  [AUTHOR]      :      <David S. Alexander>                                                           *
+ *  [DATE CREATED]:      <Oct 18, 2026>                                                                 *
+ *  [Description] :      <Header file for the MQTT 3.1.1 client over the SIM808 TCP path>               *
+ ********************************************************************************************************/
+
+
+#ifndef MQTT_H_
+#define MQTT_H_
+
+/*******************************************************************************
+ *                                 Includes                                    *
+ *******************************************************************************/
+
+#include "GSM_SIM808.h"
+
+/*******************************************************************************
+ *                             Macro Declarations                              *
+ *******************************************************************************/
+
+#define MQTT_TX_BUFFER_SIZE       256          /* One CIPSEND batch */
+#define MQTT_RX_BUFFER_SIZE       128          /* Largest inbound packet kept, longer ones are skipped */
+#define MQTT_MAX_INFLIGHT         2            /* QoS1 PUBLISH packets awaiting PUBACK */
+#define MQTT_INFLIGHT_SIZE        96           /* Largest QoS1 packet that can be retransmitted */
+#define MQTT_MAX_PUBACKS          4            /* Inbound QoS1 packets acknowledged per MQTT_Process() call */
+
+#define MQTT_BATCH_WINDOW         1000         /* ms a QoS0 batch may wait for more publishes */
+#define MQTT_RETRY_TIMEOUT        10000        /* ms before a QoS1 PUBLISH is resent with DUP */
+#define MQTT_CONNACK_TIMEOUT      10000        /* ms to wait for CONNACK */
+
+/* Control packet types (fixed header byte) */
+#define MQTT_PACKET_CONNECT       0x10
+#define MQTT_PACKET_CONNACK       0x20
+#define MQTT_PACKET_PUBLISH       0x30
+#define MQTT_PACKET_PUBACK        0x40
+#define MQTT_PACKET_SUBSCRIBE     0x82
+#define MQTT_PACKET_SUBACK        0x90
+#define MQTT_PACKET_PINGREQ       0xC0
+#define MQTT_PACKET_PINGRESP      0xD0
+#define MQTT_PACKET_DISCONNECT    0xE0
+
+/* CONNECT flags */
+#define MQTT_FLAG_USERNAME        0x80
+#define MQTT_FLAG_PASSWORD        0x40
+#define MQTT_FLAG_CLEAN_SESSION   0x02
+
+/* PUBLISH flags */
+#define MQTT_FLAG_DUP             0x08
+#define MQTT_FLAG_QOS1            0x02
+
+/*******************************************************************************
+ *                         Data Types Declaration                              *
+ *******************************************************************************/
+
+typedef enum
+{
+	MQTT_QoS0,
+	MQTT_QoS1
+
+} MQTT_QoS_t;
+
+typedef enum
+{
+	MQTT_Disconnected,
+	MQTT_Connecting,
+	MQTT_Connected
+
+} MQTT_State_t;
+
+typedef void (*MQTT_Callback_t)(const uint8 *Topic, uint16 TopicLength, const uint8 *Payload, uint16 PayloadLength);
+
+typedef struct
+{
+	const uint8                         *MQTT_ClientID;
+	const uint8                         *MQTT_Username;          /* NULL when not used */
+	const uint8                         *MQTT_Password;          /* NULL when not used */
+	uint16                               MQTT_KeepAlive;         /* Seconds, 0 disables PINGREQ */
+	boolean                              MQTT_CleanSession;
+	MQTT_Callback_t                      MQTT_Callback;          /* Incoming PUBLISH handler, may be NULL */
+
+} MQTT_Config_t;
+
+/*******************************************************************************
+ *                            Functions Declaration                            *
+ *******************************************************************************/
+
+Std_ReturnType MQTT_Connect(const USART_Config_t *USART, const MQTT_Config_t *MQTTcfg, const uint8 *host, uint16 port);
+Std_ReturnType MQTT_Publish(const USART_Config_t *USART, const uint8 *topic, const uint8 *payload, uint16 length, MQTT_QoS_t QoS);
+Std_ReturnType MQTT_Subscribe(const USART_Config_t *USART, const uint8 *topic, MQTT_QoS_t QoS);
+Std_ReturnType MQTT_Flush(const USART_Config_t *USART);
+Std_ReturnType MQTT_Process(const USART_Config_t *USART, uint16 ElapsedMs);
+Std_ReturnType MQTT_Disconnect(const USART_Config_t *USART);
+Std_ReturnType MQTT_GetState(MQTT_State_t *State);
+
+#endif /* MQTT_H_ */
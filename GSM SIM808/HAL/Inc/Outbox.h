@@ -0,0 +1,51 @@
+
+/********************************************************************************************************
+ *  [FILE NAME]   :      <Outbox.h>                                                                     *
+ *  [AUTHOR]      :      <David S. Alexander>                                                           *
+ *  [DATE CREATED]:      <Oct 18, 2026>                                                                 *
+ *  [Description] :      <Header file for the EEPROM store-and-forward telemetry queue>                 *
+ ********************************************************************************************************/
+
+
+#ifndef OUTBOX_H_
+#define OUTBOX_H_
+
+/*******************************************************************************
+ *                                 Includes                                    *
+ *******************************************************************************/
+
+#include "../../MCAL/Inc/EEPROM.h"
+
+/*******************************************************************************
+ *                             Macro Declarations                              *
+ *******************************************************************************/
+
+#define OUTBOX_EEPROM_BASE        0x0000
+#define OUTBOX_EEPROM_SIZE        3840U        /* The top 256 bytes stay free for settings */
+#define OUTBOX_META_CELLS         16           /* Tail marker copies, spreads the per-drain write */
+#define OUTBOX_SLOT_SIZE          32           /* Bytes per record including the 4-byte header */
+
+#define OUTBOX_META_CELL_SIZE     5
+#define OUTBOX_SLOT_BASE          (OUTBOX_EEPROM_BASE + (OUTBOX_META_CELLS * OUTBOX_META_CELL_SIZE))
+#define OUTBOX_SLOT_COUNT         ((OUTBOX_EEPROM_SIZE - (OUTBOX_META_CELLS * OUTBOX_META_CELL_SIZE)) / OUTBOX_SLOT_SIZE)
+#define OUTBOX_RECORD_MAX         (OUTBOX_SLOT_SIZE - 4)
+
+/*******************************************************************************
+ *                         Data Types Declaration                              *
+ *******************************************************************************/
+
+/* Delivers one record, E_NOT_OK stops the drain and keeps the record queued */
+typedef Std_ReturnType (*Outbox_Sender_t)(const uint8 *Data, uint8 Length);
+
+/*******************************************************************************
+ *                            Functions Declaration                            *
+ *******************************************************************************/
+
+Std_ReturnType Outbox_Init(void);
+Std_ReturnType Outbox_Push(const uint8 *Data, uint8 Length);
+Std_ReturnType Outbox_Peek(uint8 *Data, uint8 Size, uint8 *Length);
+Std_ReturnType Outbox_Pop(void);
+Std_ReturnType Outbox_Drain(Outbox_Sender_t Sender, uint8 MaxRecords, uint8 *Sent);
+Std_ReturnType Outbox_GetCount(uint8 *Count);
+
+#endif /* OUTBOX_H_ */
@@ -0,0 +1,43 @@
+
+/********************************************************************************************************
+ *  [FILE NAME]   :      <Power.h>                                                                      *
+ *  [AUTHOR]      :      <David S. Alexander>                                                           *
+ *  [DATE CREATED]:      <Oct 18, 2026>                                                                 *
+ *  [Description] :      <Header file for the MCU sleep and modem slow clock power manager>             *
+ ********************************************************************************************************/
+
+
+#ifndef POWER_H_
+#define POWER_H_
+
+/*******************************************************************************
+ *                                 Includes                                    *
+ *******************************************************************************/
+
+#include "GSM_SIM808.h"
+#include "../../MCAL/Inc/Sleep.h"
+
+/*******************************************************************************
+ *                             Macro Declarations                              *
+ *******************************************************************************/
+
+#define POWER_DTR                 DIO_PIN_ID(E, 5)                /* Output to the modem DTR, high lets it sleep once AT+CSCLK=1 */
+#define POWER_RI                  DIO_PIN_ID(E, SLEEP_WAKE_INT)   /* Modem RI, pulled low on calls, SMS and URCs, must be the wake interrupt pin */
+
+#define POWER_MODEM_WAKE_MS       50           /* DTR low until the modem UART takes commands */
+#define POWER_MODEM_IDLE_MS       5000UL       /* AT silence before DTR goes high */
+
+/*******************************************************************************
+ *                            Functions Declaration                            *
+ *******************************************************************************/
+
+Std_ReturnType Power_Init(const USART_Config_t *USART);
+Std_ReturnType Power_ModemWake(void);
+Std_ReturnType Power_ModemSleep(void);
+boolean        Power_ModemAsleep(void);
+Std_ReturnType Power_Process(void);
+boolean        Power_RingPending(void);
+void           Power_Idle(void);
+Std_ReturnType Power_DeepSleep(void);
+
+#endif /* POWER_H_ */
@@ -0,0 +1,96 @@
+
+/********************************************************************************************************
+ *  [FILE NAME]   :      <Recovery.h>                                                                   *
+ *  [AUTHOR]      :      <David S. Alexander>                                                           *
+ *  [DATE CREATED]:      <Oct 18, 2026>                                                                 *
+ *  [Description] :      <Header file for the watchdog supervised modem hang recovery>                  *
+ ********************************************************************************************************/
+
+
+#ifndef RECOVERY_H_
+#define RECOVERY_H_
+
+/*******************************************************************************
+ *                                 Includes                                    *
+ *******************************************************************************/
+
+#include "GSM_SIM808.h"
+#include "../../MCAL/Inc/Timer.h"
+#include "../../MCAL/Inc/Watchdog.h"
+
+/*******************************************************************************
+ *                             Macro Declarations                              *
+ *******************************************************************************/
+
+#define RECOVERY_PWRKEY           DIO_PIN_ID(E, 6)   /* Output to the modem PWRKEY */
+#define RECOVERY_PWRKEY_INVERTED  1                  /* 1: driven through a transistor, a high pin pulls PWRKEY low */
+#define RECOVERY_STATUS           DIO_PIN_ID(E, 7)   /* Modem STATUS, high while it is on */
+#define RECOVERY_HAS_STATUS       1                  /* 0 when STATUS is not wired, the power cycle then runs blind */
+
+#define RECOVERY_TIMEOUT_LIMIT    3            /* Silent GSM waits in a row that start a recovery */
+#define RECOVERY_SILENCE_MS       90000UL      /* No modem line for this long sends an AT probe */
+#define RECOVERY_CFUN_BOOT_MS     8000UL       /* Boot time after AT+CFUN=1,1 before the baud sync */
+#define RECOVERY_PWRKEY_MS        1200         /* PWRKEY low time, the SIM808 needs at least 1 s */
+#define RECOVERY_OFF_MS           2000UL       /* Wait for the power down before the next pulse */
+#define RECOVERY_POWER_BOOT_MS    4000UL       /* Boot time after power on before the baud sync */
+#define RECOVERY_RETRY_MS         60000UL      /* Pause after a failed ladder before the next attempt */
+#define RECOVERY_QUEUE_SIZE       6            /* Commands held while the modem is down or busy */
+#define RECOVERY_WATCHDOG         WATCHDOG_2S  /* Armed while a recovery step runs */
+
+/*******************************************************************************
+ *                         Data Types Declaration                              *
+ *******************************************************************************/
+
+/* Escalation ladder, each step runs only when the one before did not bring the modem back */
+typedef enum
+{
+	RECOVERY_Healthy,
+	RECOVERY_Probe,                            /* AT at the current rate, then a baud rate scan */
+	RECOVERY_SoftReset,                        /* AT+CFUN=1,1 */
+	RECOVERY_PowerCycle,                       /* PWRKEY off and on again */
+	RECOVERY_Failed                            /* Ladder exhausted, retried after RECOVERY_RETRY_MS */
+
+} Recovery_Step_t;
+
+/* Held commands run highest priority first, in submit order within one priority */
+typedef enum
+{
+	RECOVERY_PriorityBackground,               /* Telemetry, gives way to everything else */
+	RECOVERY_PriorityNormal,
+	RECOVERY_PriorityUrgent                    /* Alarms and hang-ups, cut in on long HTTP and TCP operations */
+
+} Recovery_Priority_t;
+
+/* Re-runs the application's modem setup after a reset, e.g. GSM_Reinit() and Power_Init() */
+typedef Std_ReturnType (*Recovery_Reinit_t)(void);
+
+/* A multi-command operation held like a command, e.g. a wrapper around GSM_SendSMS() */
+typedef Std_ReturnType (*Recovery_Job_t)(void);
+
+typedef struct
+{
+	Recovery_Step_t                      Step;
+	uint8                                Recoveries;             /* Modem brought back, saturates */
+	uint8                                Failures;               /* Exhausted ladders, saturates */
+	Recovery_Step_t                      LastStep;               /* Step that brought the modem back last */
+	uint32                               LastDurationMs;         /* Detection to working modem of the last recovery */
+	uint8                                ResetCause;             /* Watchdog_ResetCause() at Recovery_Init() */
+	uint8                                Preemptions;            /* Long operations cut short by urgent work, saturates */
+	uint8                                Dropped;                /* Held commands pushed out by more urgent ones, saturates */
+	uint32                               UrgentLatencyMs;        /* Submit to answer of the last urgent command */
+	uint32                               UrgentLatencyMaxMs;
+
+} Recovery_Status_t;
+
+/*******************************************************************************
+ *                            Functions Declaration                            *
+ *******************************************************************************/
+
+Std_ReturnType Recovery_Init(const USART_Config_t *USART, Recovery_Reinit_t Reinit);
+Std_ReturnType Recovery_Process(void);
+Std_ReturnType Recovery_Submit(const char *Command, const char *Expected, uint16 Timeout, Recovery_Priority_t Priority);
+Std_ReturnType Recovery_SubmitJob(Recovery_Job_t Job, Recovery_Priority_t Priority);
+boolean        Recovery_ModemReady(void);
+Std_ReturnType Recovery_GetStatus(Recovery_Status_t *Status);
+
+#endif /* RECOVERY_H_ */
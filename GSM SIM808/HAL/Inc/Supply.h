@@ -0,0 +1,70 @@
+
+/********************************************************************************************************
+ *  [FILE NAME]   :      <Supply.h>                                                                     *
+ *  [AUTHOR]      :      <David S. Alexander>                                                           *
+ *  [DATE CREATED]:      <Oct 18, 2026>                                                                 *
+ *  [Description] :      <Header file for the supply voltage health monitor and send throttle>          *
+ ********************************************************************************************************/
+
+
+#ifndef SUPPLY_H_
+#define SUPPLY_H_
+
+/*******************************************************************************
+ *                                 Includes                                    *
+ *******************************************************************************/
+
+#include "GSM_SIM808.h"
+#include "../../MCAL/Inc/ADC.h"
+#include "../../MCAL/Inc/Timer.h"
+
+/*******************************************************************************
+ *                             Macro Declarations                              *
+ *******************************************************************************/
+
+#define SUPPLY_NO_ADC             0xFF         /* Supply_Init() slot when no divider is fitted */
+#define SUPPLY_ADC_CHANNEL        ADC_CHANNEL0 /* Divider tap on the modem VBAT rail */
+#define SUPPLY_ADC_FULL_SCALE_MV  10000UL      /* mV at full scale: 5 V AVCC reference behind a 1:2 divider */
+
+#define SUPPLY_LOW_MV             3600         /* Large sends wait below this */
+#define SUPPLY_CRITICAL_MV        3450         /* Nothing is sent below this, the SIM808 powers down at 3.4 V */
+#define SUPPLY_HYSTERESIS_MV      100          /* A level is left upwards only above its threshold plus this */
+#define SUPPLY_RECOVER_MS         10000UL      /* Time the voltage has to stay recovered */
+#define SUPPLY_WARNING_HOLD_MS    60000UL      /* An UNDER-VOLTAGE URC keeps the state Low at least this long */
+#define SUPPLY_POLL_MS            60000UL      /* AT+CBC period while Good */
+#define SUPPLY_POLL_LOW_MS        10000UL      /* AT+CBC period while Low or Critical */
+#define SUPPLY_BURST_BYTES        64           /* Sends up to this size still go out while Low */
+
+/*******************************************************************************
+ *                         Data Types Declaration                              *
+ *******************************************************************************/
+
+typedef enum
+{
+	SUPPLY_Good,
+	SUPPLY_Low,                                /* Only sends up to SUPPLY_BURST_BYTES */
+	SUPPLY_Critical                            /* All sends deferred */
+
+} Supply_State_t;
+
+typedef struct
+{
+	Supply_State_t                       State;
+	uint16                               ModemMv;                /* Last AT+CBC voltage, 0 until read */
+	uint8                                ModemPercent;           /* Last AT+CBC charge level */
+	uint16                               LocalMv;                /* Last ADC reading, 0 without a divider */
+	uint8                                Warnings;               /* UNDER-VOLTAGE URCs since Supply_Init(), saturates */
+
+} Supply_Status_t;
+
+/*******************************************************************************
+ *                            Functions Declaration                            *
+ *******************************************************************************/
+
+Std_ReturnType Supply_Init(const USART_Config_t *USART, uint8 ADCSlot);
+Std_ReturnType Supply_Process(void);
+Supply_State_t Supply_GetState(void);
+Std_ReturnType Supply_GetStatus(Supply_Status_t *Status);
+boolean        Supply_SendAllowed(uint16 Length);
+
+#endif /* SUPPLY_H_ */
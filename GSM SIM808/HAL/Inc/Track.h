@@ -0,0 +1,51 @@
+
+/********************************************************************************************************
+ *  [FILE NAME]   :      <Track.h>                                                                      *
+ *  [AUTHOR]      :      <David S. Alexander>                                                           *
+ *  [DATE CREATED]:      <Oct 18, 2026>                                                                 *
+ *  [Description] :      <Header file for the GNSS track simplification and batching buffer>            *
+ ********************************************************************************************************/
+
+
+#ifndef TRACK_H_
+#define TRACK_H_
+
+/*******************************************************************************
+ *                                 Includes                                    *
+ *******************************************************************************/
+
+#include "GNSS_SIM808.h"
+
+/*******************************************************************************
+ *                             Macro Declarations                              *
+ *******************************************************************************/
+
+#define TRACK_BATCH_SIZE          128          /* Encoded bytes per upload */
+#define TRACK_WINDOW_SIZE         16           /* Fixes buffered before a point is forced out */
+#define TRACK_DEADBAND            10           /* Meters, closer fixes are treated as jitter */
+#define TRACK_TOLERANCE           15           /* Meters, max deviation of dropped fixes from the kept path */
+#define TRACK_MAX_DELTA           250000L      /* Degrees * 1e6 (~28 km) between kept points, keeps the math in 32 bits */
+#define TRACK_QUANTUM             10           /* Encoded coordinate unit, degrees * 1e5 */
+
+#define TRACK_FORMAT_VERSION      1
+
+/*
+ * Batch layout:
+ *   [0]      TRACK_FORMAT_VERSION
+ *   [1..4]   Latitude  / TRACK_QUANTUM, sint32 little endian
+ *   [5..8]   Longitude / TRACK_QUANTUM, sint32 little endian
+ *   [9..11]  UTC second of day, little endian
+ *   then per point: zigzag varint dLatitude, dLongitude, dSeconds
+ */
+
+/*******************************************************************************
+ *                            Functions Declaration                            *
+ *******************************************************************************/
+
+Std_ReturnType Track_Init(void);
+Std_ReturnType Track_AddFix(const GNSS_Fix_t *Fix);
+Std_ReturnType Track_Flush(void);
+Std_ReturnType Track_GetBatch(const uint8 **Data, uint16 *Length);
+Std_ReturnType Track_ClearBatch(void);
+
+#endif /* TRACK_H_ */
@@ -0,0 +1,596 @@
+
+/********************************************************************************************************
+ *  [FILE NAME]   :      <Cmux.c>                                                                       *
+ *  [AUTHOR]      :      <David S. Alexander>                                                           *
+ *  [DATE CREATED]:      <Oct 18, 2026>                                                                 *
+ *  [Description] :      <Source file for the GSM 07.10 basic mode multiplexer>                         *
+ ********************************************************************************************************/
+
+#include "../Inc/Cmux.h"
+
+/*
+ * Basic mode frame: F9 | Address | Control | Length | Info | FCS | F9
+ *   Address : DLCI << 2 | C/R << 1 | EA, commands from this side carry C/R = 1
+ *   Length  : Info length << 1 | EA, one byte since N1 <= 127
+ *   FCS     : reversed CRC-8 (0x07) over Address, Control and Length for UIH
+ * The FCS never covers the info field, so received bytes go straight into the
+ * DLC ring and are only committed once the FCS checks out.
+ */
+
+#define CMUX_FLAG                 0xF9
+#define CMUX_EA                   0x01
+#define CMUX_CR                   0x02
+#define CMUX_PF                   0x10
+
+#define CMUX_SABM                 0x2F
+#define CMUX_UA                   0x63
+#define CMUX_DM                   0x0F
+#define CMUX_DISC                 0x43
+#define CMUX_UIH                  0xEF
+
+#define CMUX_FCS_INIT             0xFF
+#define CMUX_FCS_GOOD             0xCF
+
+/* Control channel message types with EA set, C/R is added for commands */
+#define CMUX_MSG_TEST             0x21
+#define CMUX_MSG_CLD              0xC1
+#define CMUX_MSG_MSC              0xE1
+#define CMUX_MSG_NSC              0x11
+
+#define CMUX_V24_FC               0x02
+#define CMUX_V24_READY            0x8D         /* EA, RTC, RTR, DV */
+
+typedef enum
+{
+	CMUX_RxFlag,
+	CMUX_RxAddress,
+	CMUX_RxControl,
+	CMUX_RxLength,
+	CMUX_RxInfo,
+	CMUX_RxFcs,
+	CMUX_RxEnd
+
+} Cmux_RxState_t;
+
+typedef struct
+{
+	uint8        RX_Buffer[CMUX_RX_BUFFER_SIZE];
+	uint8        RX_Head;                  /* Committed frames end here */
+	uint8        RX_Tail;
+	uint8        TX_Frame[CMUX_FRAME_MAX];
+	uint8        TX_Length;
+	Cmux_State_t State;
+	boolean      RemoteStopped;            /* The modem sent MSC FC=1 */
+	boolean      LocalStopped;             /* We sent MSC FC=1 */
+	uint16       Dropped;                  /* Received bytes lost on a full ring */
+
+} Cmux_Dlc_t;
+
+static const USART_Config_t *Cmux_USART = NULL;
+static Cmux_State_t   Cmux_ControlState = CMUX_Closed;
+static Cmux_Dlc_t     Cmux_Dlcs[CMUX_DLCS];
+
+static Cmux_RxState_t Cmux_RxState = CMUX_RxFlag;
+static uint8          Cmux_RxDlci;
+static uint8          Cmux_RxControl;
+static uint8          Cmux_RxRemaining;
+static uint8          Cmux_RxFcs;
+static uint8          Cmux_RxPending;          /* Uncommitted head of the target ring */
+static boolean        Cmux_RxOverflow;
+static uint8          Cmux_Message[CMUX_CONTROL_MAX];
+static uint8          Cmux_MessageLength;
+
+static Std_ReturnType Cmux_Transmit_Byte(uint8 Channel, uint8 data);
+static Std_ReturnType Cmux_Receive_Byte(uint8 Channel, uint8* data);
+static uint8          Cmux_TransmitSpace(uint8 Channel);
+static void           Cmux_Flush(uint8 Channel);
+
+static const USART_VirtualDriver_t Cmux_Driver =
+{
+	.Transmit_Byte = Cmux_Transmit_Byte,
+	.Receive_Byte  = Cmux_Receive_Byte,
+	.TransmitSpace = Cmux_TransmitSpace,
+	.Flush         = Cmux_Flush
+};
+
+static uint8 Cmux_Fcs(uint8 Fcs, uint8 Byte)
+{
+	Fcs ^= Byte;
+	for (uint8 Bit = 0; Bit < 8; Bit++)
+	{
+		Fcs = (Fcs & 0x01) ? (uint8)((Fcs >> 1) ^ 0xE0) : (uint8)(Fcs >> 1);
+	}
+
+	return Fcs;
+}
+
+static uint8 Cmux_RxUsed(const Cmux_Dlc_t *Dlc)
+{
+	return (uint8)(Dlc->RX_Head - Dlc->RX_Tail) % CMUX_RX_BUFFER_SIZE;
+}
+
+/* Blocks until the whole frame fits in the USART TX ring, so frames never interleave, E_NOT_OK after CMUX_TX_STALL_MS */
+static Std_ReturnType Cmux_SendFrame(uint8 Dlci, uint8 Control, const uint8 *Info, uint8 Length)
+{
+	uint8 Header[3];
+	uint8 Fcs = CMUX_FCS_INIT;
+	uint32 Start = Timer_GetMillis();
+	boolean Response = ((Control & ~CMUX_PF) == CMUX_UA || (Control & ~CMUX_PF) == CMUX_DM) ? TRUE : FALSE;
+
+	Header[0] = (uint8)((Dlci << 2) | ((Response == TRUE) ? 0 : CMUX_CR) | CMUX_EA);
+	Header[1] = Control;
+	Header[2] = (uint8)((Length << 1) | CMUX_EA);
+
+	while (USART_TransmitSpace(Cmux_USART) < (uint8)(Length + 6))
+	{
+		if ((uint32)(Timer_GetMillis() - Start) >= CMUX_TX_STALL_MS)
+		{
+			LOG_ERROR(LOG_GSM, "CMUX frame stalled, TX ring not draining");   /* Modem holds CTS or the link is dead */
+			return E_NOT_OK;
+		}
+		Watchdog_Kick();
+	}
+
+	USART_Transmit_Byte(Cmux_USART, CMUX_FLAG);
+	for (uint8 Index = 0; Index < 3; Index++)
+	{
+		USART_Transmit_Byte(Cmux_USART, Header[Index]);
+		Fcs = Cmux_Fcs(Fcs, Header[Index]);
+	}
+	for (uint8 Index = 0; Index < Length; Index++)
+	{
+		USART_Transmit_Byte(Cmux_USART, Info[Index]);
+	}
+	USART_Transmit_Byte(Cmux_USART, (uint8)(0xFF - Fcs));
+	USART_Transmit_Byte(Cmux_USART, CMUX_FLAG);
+
+	return E_OK;
+}
+
+static Std_ReturnType Cmux_SendMSC(uint8 Dlci, uint8 Signals)
+{
+	uint8 Message[4];
+
+	Message[0] = CMUX_MSG_MSC | CMUX_CR;
+	Message[1] = (2 << 1) | CMUX_EA;
+	Message[2] = (uint8)((Dlci << 2) | CMUX_CR | CMUX_EA);
+	Message[3] = Signals;
+	return Cmux_SendFrame(0, CMUX_UIH, Message, sizeof(Message));
+}
+
+static Std_ReturnType Cmux_FlushFrame(uint8 Channel)
+{
+	Cmux_Dlc_t *Dlc = &Cmux_Dlcs[Channel];
+
+	if (Dlc->TX_Length == 0)
+	{
+		return E_OK;
+	}
+	if (Dlc->State != CMUX_Open || Dlc->RemoteStopped == TRUE)
+	{
+		return E_NOT_OK;                                           /* Held until the modem lifts FC */
+	}
+
+	if (Cmux_SendFrame(Channel + 1, CMUX_UIH, Dlc->TX_Frame, Dlc->TX_Length) != E_OK)
+	{
+		return E_NOT_OK;                                           /* Frame kept for the next flush */
+	}
+	Dlc->TX_Length = 0;
+
+	return E_OK;
+}
+
+/* One message from the control channel, commands get their response here */
+static void Cmux_HandleMessage(void)
+{
+	uint8 Type = Cmux_Message[0];
+	uint8 Length = Cmux_Message[1] >> 1;
+	uint8 Dlci = 0;
+
+	if (Cmux_MessageLength < 2 || Length > (Cmux_MessageLength - 2))
+	{
+		return;                                                    /* Cut by CMUX_CONTROL_MAX */
+	}
+
+	if ((Type & CMUX_CR) == 0)
+	{
+		return;                                                    /* Response to one of ours, nothing waits for it */
+	}
+
+	switch (Type & ~CMUX_CR)
+	{
+		case CMUX_MSG_MSC:
+			Dlci = Cmux_Message[2] >> 2;
+			if (Length >= 2 && Dlci >= 1 && Dlci <= CMUX_DLCS)
+			{
+				Cmux_Dlcs[Dlci - 1].RemoteStopped = (Cmux_Message[3] & CMUX_V24_FC) ? TRUE : FALSE;
+			}
+			Cmux_Message[0] = CMUX_MSG_MSC;                        /* Echo back as the response */
+			Cmux_SendFrame(0, CMUX_UIH, Cmux_Message, Length + 2);
+			break;
+
+		case CMUX_MSG_TEST:
+			Cmux_Message[0] = CMUX_MSG_TEST;
+			Cmux_SendFrame(0, CMUX_UIH, Cmux_Message, Length + 2);
+			break;
+
+		case CMUX_MSG_CLD:
+			Cmux_Message[0] = CMUX_MSG_CLD;
+			Cmux_SendFrame(0, CMUX_UIH, Cmux_Message, 2);
+			Cmux_ControlState = CMUX_Closed;
+			for (uint8 Index = 0; Index < CMUX_DLCS; Index++)
+			{
+				Cmux_Dlcs[Index].State = CMUX_Closed;
+			}
+			break;
+
+		default:
+			Cmux_Message[2] = Type;                                /* Not supported, tell the modem which one */
+			Cmux_Message[1] = (1 << 1) | CMUX_EA;
+			Cmux_Message[0] = CMUX_MSG_NSC;
+			Cmux_SendFrame(0, CMUX_UIH, Cmux_Message, 3);
+			break;
+	}
+}
+
+static void Cmux_HandleFrame(void)
+{
+	Cmux_State_t *State = (Cmux_RxDlci == 0) ? &Cmux_ControlState : &Cmux_Dlcs[Cmux_RxDlci - 1].State;
+	Cmux_Dlc_t   *Dlc = NULL;
+
+	switch (Cmux_RxControl & ~CMUX_PF)
+	{
+		case CMUX_UA:
+			if (*State == CMUX_Opening)
+			{
+				*State = CMUX_Open;
+			}
+			else
+			{
+				*State = CMUX_Closed;                              /* Answer to our DISC */
+			}
+			break;
+
+		case CMUX_DM:
+			*State = CMUX_Closed;
+			break;
+
+		case CMUX_SABM:
+		case CMUX_DISC:
+			*State = ((Cmux_RxControl & ~CMUX_PF) == CMUX_SABM) ? CMUX_Open : CMUX_Closed;
+			Cmux_SendFrame(Cmux_RxDlci, CMUX_UA | CMUX_PF, NULL, 0);
+			break;
+
+		case CMUX_UIH:
+			if (Cmux_RxDlci == 0)
+			{
+				Cmux_HandleMessage();
+			}
+			else
+			{
+				Dlc = &Cmux_Dlcs[Cmux_RxDlci - 1];
+				Dlc->RX_Head = Cmux_RxPending;
+				if (Cmux_RxOverflow == TRUE && Dlc->Dropped < 0xFFFF)
+				{
+					Dlc->Dropped++;
+				}
+				if (Dlc->LocalStopped == FALSE && Cmux_RxUsed(Dlc) >= CMUX_FC_HIGH_WATER)
+				{
+					Dlc->LocalStopped = TRUE;
+					Cmux_SendMSC(Cmux_RxDlci, CMUX_V24_READY | CMUX_V24_FC);
+				}
+			}
+			break;
+
+		default:
+			break;
+	}
+}
+
+static void Cmux_Parse(uint8 Byte)
+{
+	Cmux_Dlc_t *Dlc = NULL;
+
+	switch (Cmux_RxState)
+	{
+		case CMUX_RxFlag:
+			if (Byte == CMUX_FLAG)
+			{
+				Cmux_RxState = CMUX_RxAddress;
+			}
+			break;
+
+		case CMUX_RxAddress:
+			if (Byte == CMUX_FLAG)
+			{
+				break;                                             /* Back to back flags */
+			}
+			Cmux_RxDlci = Byte >> 2;
+			Cmux_RxFcs = Cmux_Fcs(CMUX_FCS_INIT, Byte);
+			Cmux_RxState = ((Byte & CMUX_EA) && Cmux_RxDlci <= CMUX_DLCS) ? CMUX_RxControl : CMUX_RxFlag;
+			break;
+
+		case CMUX_RxControl:
+			Cmux_RxControl = Byte;
+			Cmux_RxFcs = Cmux_Fcs(Cmux_RxFcs, Byte);
+			Cmux_RxState = CMUX_RxLength;
+			break;
+
+		case CMUX_RxLength:
+			if ((Byte & CMUX_EA) == 0)
+			{
+				Cmux_RxState = CMUX_RxFlag;                        /* Two byte length, above any N1 we accept */
+				break;
+			}
+			Cmux_RxRemaining = Byte >> 1;
+			Cmux_RxFcs = Cmux_Fcs(Cmux_RxFcs, Byte);
+			Cmux_RxOverflow = FALSE;
+			Cmux_MessageLength = 0;
+			if (Cmux_RxDlci != 0)
+			{
+				Cmux_RxPending = Cmux_Dlcs[Cmux_RxDlci - 1].RX_Head;
+			}
+			Cmux_RxState = (Cmux_RxRemaining == 0) ? CMUX_RxFcs : CMUX_RxInfo;
+			break;
+
+		case CMUX_RxInfo:
+			if (Cmux_RxDlci == 0)
+			{
+				if (Cmux_MessageLength < CMUX_CONTROL_MAX)
+				{
+					Cmux_Message[Cmux_MessageLength++] = Byte;
+				}
+			}
+			else
+			{
+				Dlc = &Cmux_Dlcs[Cmux_RxDlci - 1];
+				if ((uint8)(Cmux_RxPending + 1) % CMUX_RX_BUFFER_SIZE != Dlc->RX_Tail)
+				{
+					Dlc->RX_Buffer[Cmux_RxPending] = Byte;
+					Cmux_RxPending = (uint8)(Cmux_RxPending + 1) % CMUX_RX_BUFFER_SIZE;
+				}
+				else
+				{
+					Cmux_RxOverflow = TRUE;
+				}
+			}
+			if (--Cmux_RxRemaining == 0)
+			{
+				Cmux_RxState = CMUX_RxFcs;
+			}
+			break;
+
+		case CMUX_RxFcs:
+			Cmux_RxState = (Cmux_Fcs(Cmux_RxFcs, Byte) == CMUX_FCS_GOOD) ? CMUX_RxEnd : CMUX_RxFlag;
+			break;
+
+		case CMUX_RxEnd:
+			if (Byte == CMUX_FLAG)
+			{
+				Cmux_HandleFrame();
+				Cmux_RxState = CMUX_RxAddress;                     /* The closing flag may open the next frame */
+			}
+			else
+			{
+				Cmux_RxState = CMUX_RxFlag;
+			}
+			break;
+
+		default:
+			Cmux_RxState = CMUX_RxFlag;
+			break;
+	}
+}
+
+static Std_ReturnType Cmux_Open(uint8 Dlci)
+{
+	Cmux_State_t *State = (Dlci == 0) ? &Cmux_ControlState : &Cmux_Dlcs[Dlci - 1].State;
+
+	for (uint8 Attempt = 0; Attempt < CMUX_N2; Attempt++)
+	{
+		*State = CMUX_Opening;
+		if (Cmux_SendFrame(Dlci, CMUX_SABM | CMUX_PF, NULL, 0) != E_OK)
+		{
+			continue;                                              /* Counts as an attempt without UA */
+		}
+
+		for (uint16 Elapsed = 0; Elapsed < CMUX_T1_MS && *State == CMUX_Opening; Elapsed++)
+		{
+			_delay_ms(1);
+			Cmux_Process();
+		}
+
+		if (*State == CMUX_Open)
+		{
+			return E_OK;
+		}
+	}
+
+	*State = CMUX_Closed;
+	return E_NOT_OK;
+}
+
+static Std_ReturnType Cmux_Transmit_Byte(uint8 Channel, uint8 data)
+{
+	Cmux_Dlc_t *Dlc = NULL;
+
+	if (Channel >= CMUX_DLCS || Cmux_Dlcs[Channel].State != CMUX_Open)
+	{
+		return E_NOT_OK;
+	}
+
+	Dlc = &Cmux_Dlcs[Channel];
+
+	if (Dlc->TX_Length == CMUX_FRAME_MAX && Cmux_FlushFrame(Channel) != E_OK)
+	{
+		return E_NOT_OK;                                           /* Frame full and the modem holds FC */
+	}
+
+	Dlc->TX_Frame[Dlc->TX_Length++] = data;
+	if (data == '\n')
+	{
+		Cmux_FlushFrame(Channel);                                  /* A line goes out as one frame */
+	}
+
+	return E_OK;
+}
+
+static Std_ReturnType Cmux_Receive_Byte(uint8 Channel, uint8* data)
+{
+	Cmux_Dlc_t *Dlc = NULL;
+
+	if (Channel >= CMUX_DLCS || NULL == data)
+	{
+		return E_NOT_OK;
+	}
+
+	Dlc = &Cmux_Dlcs[Channel];
+	Cmux_Process();
+	if (Dlc->RX_Head == Dlc->RX_Tail)
+	{
+		return E_NOT_OK;
+	}
+
+	*data = Dlc->RX_Buffer[Dlc->RX_Tail];
+	Dlc->RX_Tail = (uint8)(Dlc->RX_Tail + 1) % CMUX_RX_BUFFER_SIZE;
+
+	if (Dlc->LocalStopped == TRUE && Cmux_RxUsed(Dlc) <= CMUX_FC_LOW_WATER &&
+	    Cmux_SendMSC(Channel + 1, CMUX_V24_READY) == E_OK)
+	{
+		Dlc->LocalStopped = FALSE;                                 /* Retried with the next byte if the MSC stalled */
+	}
+
+	return E_OK;
+}
+
+static uint8 Cmux_TransmitSpace(uint8 Channel)
+{
+	if (Channel >= CMUX_DLCS || Cmux_Dlcs[Channel].State != CMUX_Open || Cmux_Dlcs[Channel].RemoteStopped == TRUE)
+	{
+		return 0;
+	}
+
+	return CMUX_FRAME_MAX - Cmux_Dlcs[Channel].TX_Length;
+}
+
+static void Cmux_Flush(uint8 Channel)
+{
+	if (Channel < CMUX_DLCS)
+	{
+		Cmux_Dlcs[Channel].RX_Tail = Cmux_Dlcs[Channel].RX_Head;
+	}
+}
+
+/**
+* @brief Switches the modem to multiplexer mode and opens every DLC.
+* @note  The USART must be interrupt driven, afterwards only the virtual channels may be used.
+*/
+Std_ReturnType Cmux_Start(const USART_Config_t *USART)
+{
+	Std_ReturnType ret = E_OK;
+
+	if (NULL == USART || USART->USART_InterruptStatus != USART_InterruptEnabled)
+	{
+		return E_NOT_OK;
+	}
+
+	USART_Transmit_String_P(USART, PSTR("AT+CMUX=0\r\n"));                 // Basic mode, default N1/T1/N2
+	ret = GSM_WaitForClass_P(USART, PSTR("OK"), GSM_CLASS_Local);
+
+	if (ret == E_OK)
+	{
+		Cmux_USART = USART;
+		Cmux_RxState = CMUX_RxFlag;
+		memset(Cmux_Dlcs, 0, sizeof(Cmux_Dlcs));
+		USART_Flush(USART);
+		ret = Cmux_Open(0);
+	}
+
+	for (uint8 Dlci = 1; ret == E_OK && Dlci <= CMUX_DLCS; Dlci++)
+	{
+		ret = Cmux_Open(Dlci);
+		if (ret == E_OK)
+		{
+			ret = Cmux_SendMSC(Dlci, CMUX_V24_READY);                  /* DTR/RTS up, some firmware waits for it */
+		}
+	}
+
+	if (ret == E_OK)
+	{
+		ret = USART_SetVirtualDriver(&Cmux_Driver);
+	}
+	else if (NULL != Cmux_USART)
+	{
+		Cmux_Stop();                                                   /* Partly open, go back to plain AT */
+	}
+
+	return ret;
+}
+
+/**
+* @brief Sends the close down command, the modem returns to plain AT mode on the USART.
+*/
+Std_ReturnType Cmux_Stop(void)
+{
+	uint8 Message[2] = { CMUX_MSG_CLD | CMUX_CR, CMUX_EA };
+
+	if (NULL == Cmux_USART)
+	{
+		return E_NOT_OK;
+	}
+
+	USART_SetVirtualDriver(NULL);
+	if (Cmux_ControlState == CMUX_Open)
+	{
+		Cmux_SendFrame(0, CMUX_UIH, Message, sizeof(Message));
+	}
+
+	Cmux_ControlState = CMUX_Closed;
+	for (uint8 Index = 0; Index < CMUX_DLCS; Index++)
+	{
+		Cmux_Dlcs[Index].State = CMUX_Closed;
+	}
+	Cmux_USART = NULL;
+
+	return E_OK;
+}
+
+/**
+* @brief Demultiplexes the received bytes and sends the partly filled frames, never blocks on input.
+* @note  Reading a virtual channel calls it too, a main loop call keeps the other DLCs flowing.
+*/
+Std_ReturnType Cmux_Process(void)
+{
+	uint8 Byte = 0;
+
+	if (NULL == Cmux_USART)
+	{
+		return E_NOT_OK;
+	}
+
+	while (USART_Receive_Byte(Cmux_USART, &Byte) == E_OK)
+	{
+		Cmux_Parse(Byte);
+	}
+
+	for (uint8 Channel = 0; Channel < CMUX_DLCS; Channel++)
+	{
+		Cmux_FlushFrame(Channel);
+	}
+
+	return E_OK;
+}
+
+Cmux_State_t Cmux_GetState(USART_Channel_t Channel)
+{
+	uint8 Index = (uint8)(Channel - USART_CHANNEL_VIRTUAL0);
+
+	return (Channel >= USART_CHANNEL_VIRTUAL0 && Index < CMUX_DLCS) ? Cmux_Dlcs[Index].State : CMUX_Closed;
+}
+
+uint16 Cmux_GetDropped(USART_Channel_t Channel)
+{
+	uint8 Index = (uint8)(Channel - USART_CHANNEL_VIRTUAL0);
+
+	return (Channel >= USART_CHANNEL_VIRTUAL0 && Index < CMUX_DLCS) ? Cmux_Dlcs[Index].Dropped : 0;
+}
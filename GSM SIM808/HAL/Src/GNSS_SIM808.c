@@ -0,0 +1,274 @@
+
+/********************************************************************************************************
+ *  [FILE NAME]   :      <GNSS_SIM808.c>                                                                *
+ *  [AUTHOR]      :      <David S. Alexander>                                                           *
+ *  [DATE CREATED]:      <Oct 18, 2026>                                                                 *
+ *  [Description] :      <Source file for the SIM808 GNSS receiver driver>                              *
+ ********************************************************************************************************/
+
+#include "../Inc/GNSS_SIM808.h"
+
+/* cos(0..90 degrees) in Q15, 10 degree steps */
+static const uint16 GNSS_CosTable[10] PROGMEM =
+{
+	32767, 32269, 30791, 28377, 25101, 21062, 16384, 11207, 5690, 0
+};
+
+static GNSS_Fix_t GNSS_Cache;
+static boolean    GNSS_HasFix = FALSE;
+
+/* Parse one comma separated decimal field into an integer scaled by 10^Decimals */
+static sint32 GNSS_ParseFixed(const char **Cursor, uint8 Decimals)
+{
+	const char *Str = *Cursor;
+	sint32  Value = 0;
+	uint8   Fraction = 0;
+	boolean Negative = FALSE;
+	boolean Dot = FALSE;
+
+	if (*Str == '-')
+	{
+		Negative = TRUE;
+		Str++;
+	}
+
+	while (*Str != ',' && *Str != '\0' && *Str != '\r')
+	{
+		if (*Str == '.')
+		{
+			Dot = TRUE;
+		}
+		else if (*Str >= '0' && *Str <= '9' && (Dot == FALSE || Fraction < Decimals))
+		{
+			Value = (Value * 10) + (*Str - '0');
+			if (Dot == TRUE)
+			{
+				Fraction++;
+			}
+		}
+		Str++;
+	}
+
+	while (Fraction < Decimals)              /* Pad missing digits */
+	{
+		Value *= 10;
+		Fraction++;
+	}
+
+	if (*Str == ',')
+	{
+		Str++;
+	}
+	*Cursor = Str;
+
+	return (Negative == TRUE) ? -Value : Value;
+}
+
+static void GNSS_SkipField(const char **Cursor)
+{
+	const char *Str = *Cursor;
+
+	while (*Str != ',' && *Str != '\0')
+	{
+		Str++;
+	}
+	*Cursor = (*Str == ',') ? (Str + 1) : Str;
+}
+
+static uint8 GNSS_ParseDigits(const char *Str, uint8 Count)
+{
+	uint8 Value = 0;
+
+	while (Count--)
+	{
+		Value = (Value * 10) + (*Str++ - '0');
+	}
+
+	return Value;
+}
+
+static void GNSS_URCHandler(const uint8 *line)
+{
+	GNSS_ParseLine(line);
+}
+
+Std_ReturnType GNSS_Init(const USART_Config_t *USART, uint8 URCPeriod)
+{
+	Std_ReturnType ret = E_OK;
+	char Command[20];
+
+	if (NULL == USART)
+	{
+		ret = E_NOT_OK;
+	}
+	else
+	{
+		/* Both the polled answer and the periodic URC share the same layout */
+		GSM_RegisterURC(PSTR("+CGNSINF:"), GNSS_URCHandler);
+		GSM_RegisterURC(PSTR("+UGNSINF:"), GNSS_URCHandler);
+
+		USART_Transmit_String_P(USART, PSTR("AT+CGNSPWR=1\r\n"));              // Power the GNSS receiver
+		ret = GSM_WaitForClass_P(USART, PSTR("OK"), GSM_CLASS_Local);
+
+		if (ret == E_OK && URCPeriod > 0)
+		{
+			sprintf_P(Command, PSTR("AT+CGNSURC=%u\r\n"), URCPeriod);      // Report every URCPeriod fixes
+			USART_Transmit_String(USART, (const uint8*)Command);
+			ret = GSM_WaitForClass_P(USART, PSTR("OK"), GSM_CLASS_Local);
+		}
+	}
+
+	return ret;
+}
+
+Std_ReturnType GNSS_PowerOff(const USART_Config_t *USART)
+{
+	Std_ReturnType ret = E_OK;
+
+	if (NULL == USART)
+	{
+		ret = E_NOT_OK;
+	}
+	else
+	{
+		USART_Transmit_String_P(USART, PSTR("AT+CGNSURC=0\r\n"));
+		GSM_WaitForClass_P(USART, PSTR("OK"), GSM_CLASS_Local);
+
+		USART_Transmit_String_P(USART, PSTR("AT+CGNSPWR=0\r\n"));
+		ret = GSM_WaitForClass_P(USART, PSTR("OK"), GSM_CLASS_Local);
+	}
+
+	return ret;
+}
+
+Std_ReturnType GNSS_Update(const USART_Config_t *USART)
+{
+	Std_ReturnType ret = E_OK;
+
+	if (NULL == USART)
+	{
+		ret = E_NOT_OK;
+	}
+	else
+	{
+		/* The +CGNSINF line is parsed by the URC dispatcher while waiting for OK */
+		USART_Transmit_String_P(USART, PSTR("AT+CGNSINF\r\n"));
+		ret = GSM_WaitForClass_P(USART, PSTR("OK"), GSM_CLASS_Local);
+	}
+
+	return ret;
+}
+
+Std_ReturnType GNSS_ParseLine(const uint8 *line)
+{
+	const char *Cursor = NULL;
+	GNSS_Fix_t Fix;
+
+	if (NULL == line || NULL == (Cursor = strchr((const char*)line, ':')))
+	{
+		return E_NOT_OK;
+	}
+
+	Cursor++;
+	while (*Cursor == ' ')
+	{
+		Cursor++;
+	}
+
+	memset(&Fix, 0, sizeof(Fix));
+	GNSS_SkipField(&Cursor);                                       // GNSS run status
+	Fix.GNSS_Status = (GNSS_ParseFixed(&Cursor, 0) == 1) ? GNSS_FixValid : GNSS_NoFix;
+
+	if (Fix.GNSS_Status == GNSS_NoFix)
+	{
+		/* Keep serving the last good position, only flag it as stale */
+		GNSS_Cache.GNSS_Status = GNSS_NoFix;
+		return E_OK;
+	}
+
+	if (strspn_P(Cursor, PSTR("0123456789")) >= 14)                    // yyyyMMddhhmmss.sss
+	{
+		Fix.GNSS_Year   = 2000 + GNSS_ParseDigits(Cursor + 2, 2);
+		Fix.GNSS_Month  = GNSS_ParseDigits(Cursor + 4, 2);
+		Fix.GNSS_Day    = GNSS_ParseDigits(Cursor + 6, 2);
+		Fix.GNSS_Hour   = GNSS_ParseDigits(Cursor + 8, 2);
+		Fix.GNSS_Minute = GNSS_ParseDigits(Cursor + 10, 2);
+		Fix.GNSS_Second = GNSS_ParseDigits(Cursor + 12, 2);
+	}
+	GNSS_SkipField(&Cursor);                                       // Skip the date field
+
+	Fix.GNSS_Latitude  = GNSS_ParseFixed(&Cursor, 6);
+	Fix.GNSS_Longitude = GNSS_ParseFixed(&Cursor, 6);
+	Fix.GNSS_Altitude  = GNSS_ParseFixed(&Cursor, 1);
+	Fix.GNSS_Speed     = (uint16)GNSS_ParseFixed(&Cursor, 2);
+	Fix.GNSS_Course    = (uint16)GNSS_ParseFixed(&Cursor, 2);
+	GNSS_SkipField(&Cursor);                                       // Fix mode
+	GNSS_SkipField(&Cursor);                                       // Reserved1
+	Fix.GNSS_HDOP      = (uint16)GNSS_ParseFixed(&Cursor, 2);
+	GNSS_SkipField(&Cursor);                                       // PDOP
+	GNSS_SkipField(&Cursor);                                       // VDOP
+	GNSS_SkipField(&Cursor);                                       // Reserved2
+	Fix.GNSS_SatellitesInView = (uint8)GNSS_ParseFixed(&Cursor, 0);
+	Fix.GNSS_SatellitesUsed   = (uint8)GNSS_ParseFixed(&Cursor, 0);
+
+	Fix.GNSS_Sequence = GNSS_Cache.GNSS_Sequence + 1;
+	GNSS_Cache = Fix;
+	GNSS_HasFix = TRUE;
+
+	return E_OK;
+}
+
+Std_ReturnType GNSS_GetFix(GNSS_Fix_t *Fix)
+{
+	Std_ReturnType ret = E_OK;
+
+	if (NULL == Fix || GNSS_HasFix == FALSE)
+	{
+		ret = E_NOT_OK;
+	}
+	else
+	{
+		*Fix = GNSS_Cache;                                             // Never touches the modem
+	}
+
+	return ret;
+}
+
+Std_ReturnType GNSS_GetPosition(sint32 *Latitude, sint32 *Longitude)
+{
+	Std_ReturnType ret = E_OK;
+
+	if (NULL == Latitude || NULL == Longitude || GNSS_HasFix == FALSE)
+	{
+		ret = E_NOT_OK;
+	}
+	else
+	{
+		*Latitude  = GNSS_Cache.GNSS_Latitude;
+		*Longitude = GNSS_Cache.GNSS_Longitude;
+	}
+
+	return ret;
+}
+
+uint16 GNSS_CosLatitude(sint32 Latitude)
+{
+	uint32 Angle = (Latitude < 0) ? -Latitude : Latitude;
+	uint8  Index = Angle / GNSS_COS_STEP;
+	uint16 Fraction = (Angle % GNSS_COS_STEP) / 1000;
+	uint16 Low = 0;
+	uint16 High = 0;
+	uint16 Cos = 0;
+
+	if (Index >= 9)
+	{
+		return GNSS_COS_MIN;
+	}
+
+	/* Linear interpolation between table entries */
+	High = pgm_read_word(&GNSS_CosTable[Index]);
+	Low  = pgm_read_word(&GNSS_CosTable[Index + 1]);
+	Cos  = High - (uint16)(((uint32)(High - Low) * Fraction) / (GNSS_COS_STEP / 1000));
+
+	return (Cos < GNSS_COS_MIN) ? GNSS_COS_MIN : Cos;
+}
@@ -11,76 +11,966 @@
 static APN_Profile_t Operator = VODAFONE;
 static const USART_Config_t *USART_DEBUG;
 
+static GSM_TCPState_t TCP_State = GSM_TCP_Closed;
+static uint16  TCP_PayloadLeft;                          // Bytes of the current +IPD frame still to come
+static uint8   TCP_Held[12];                             // Line start kept back while it may be "+IPD,<len>:"
+static uint8   TCP_HeldLength;
+static uint8   TCP_HeldOut;                              // Kept bytes already handed on, see GSM_ReadByte()
+static boolean TCP_Holding = FALSE;
+static boolean TCP_LineStart = TRUE;
+static uint8   TCP_RxBuffer[GSM_TCP_RX_BUFFER_SIZE];     // +IPD payload waiting for GSM_TCP_Receive()
+static uint16  TCP_RxHead;
+static uint16  TCP_RxTail;
+static boolean TCP_RxDropping = FALSE;
+
+static uint8  GSM_Line[GSM_LINE_SIZE];                   // Modem line being assembled, shared by every wait
+static uint16 GSM_LineIndex;
+static const char GSM_IPD[] PROGMEM = "+IPD,";
+
+static const char      *URC_Prefix[GSM_MAX_URC_HANDLERS];       // Flash strings
+static GSM_URCHandler_t URC_Handler[GSM_MAX_URC_HANDLERS];
+
+static GSM_SendGate_t   TCP_SendGate = NULL;
+static GSM_Preempt_t    GSM_PreemptCheck = NULL;
+
+static uint8   GSM_WaitDepth;                            // Nonzero while a GSM wait runs
+static boolean GSM_WasPreempted = FALSE;                 // An interruptible wait gave way, see GSM_Preempted()
+
+#define GSM_CLASS_INTERRUPTIBLE  0x80                    // Or'ed into the class of a long wait that gives way to urgent work
+#define GSM_CLASS_DEFERRED       0x40                    // Or'ed into the class of a wait whose answer comes after the OK
+#define GSM_CLASS_MASK           0x3F
+#define GSM_ESC                  0x1B                    // Cancels AT+CIPSEND at the '>' prompt
+
+static GSM_Result_t GSM_LastResult;
+
+static uint8  GSM_Timeouts;                              // Consecutive waits without a single modem line
+static uint32 GSM_HeardTime;                             // Timer_GetMillis() of the last modem line
+
+typedef struct
+{
+	uint16      MCC;
+	uint16      MNC;
+	uint8       MNCDigits;
+	const char *APN;                         // Flash string
+
+} GSM_APNEntry_t;
+
+typedef struct
+{
+	const char *Prefix;                      // Flash string, NULL takes the first line starting with a digit
+	uint8      *Line;
+	uint8       Size;
+
+} GSM_Capture_t;
+
+/* APN names live in flash */
+static const char GSM_APN_WE[]       PROGMEM = "internet.te.eg";
+static const char GSM_APN_Orange[]   PROGMEM = "mobinilweb";
+static const char GSM_APN_Etisalat[] PROGMEM = "internet";
+static const char GSM_APN_Vodafone[] PROGMEM = "internet.vodafone.net";
+
+/* Operators by MCC/MNC, the first rows follow APN_Profile_t so a fixed profile indexes its row */
+static const GSM_APNEntry_t GSM_APNTable[] PROGMEM =
+{
+	{ 602, 4, 2, GSM_APN_WE },
+	{ 602, 1, 2, GSM_APN_Orange },
+	{ 602, 3, 2, GSM_APN_Etisalat },
+	{ 602, 2, 2, GSM_APN_Vodafone }
+};
+
+#define GSM_APN_COUNT      (sizeof(GSM_APNTable) / sizeof(GSM_APNTable[0]))
+#define GSM_APN_NONE       0xFF
+#define GSM_APN_CACHE_KEY  0x5A
+
+static uint8   APN_Entry = GSM_APN_NONE;             // Row found by GSM_DetectAPN()
+static boolean APN_FromCache = FALSE;
+
+/* AT+IPR rates of the SIM808, highest first */
+static const uint32 GSM_BaudRates[] PROGMEM =
+{
+	460800, 230400, 115200, 57600, 38400, 19200, 9600
+};
+
+#define GSM_BAUD_COUNT     (sizeof(GSM_BaudRates) / sizeof(GSM_BaudRates[0]))
+
+typedef struct
+{
+	uint16      Floor;                       // ms, never waits less even on a fast network
+	uint32      Ceiling;                     // ms, worst case the modem manual allows
+	uint16      Initial;                     // ms, until the first answer is measured
+
+} GSM_ClassBounds_t;
+
+/* Rows follow GSM_CmdClass_t */
+static const GSM_ClassBounds_t GSM_ClassTable[GSM_CLASS_COUNT] PROGMEM =
+{
+	{  300,  5000,  2000 },
+	{  500, 10000,  5000 },
+	{ 1000, 60000,  5000 },
+	{ 1000, 60000, 10000 },
+	{ 2000, 85000, 30000 }
+};
+
+typedef struct
+{
+	uint32      Smoothed8;                   // Answer time in ms * 8, 0 before the first sample
+	uint32      Deviation4;                  // Mean deviation in ms * 4
+	uint8       Backoff;
+	uint16      SavedMs;                     // Timeout held in EEPROM, 0 when none
+
+} GSM_RTO_t;
+
+#define GSM_RTO_KEY        0xA7
+#define GSM_RTO_SIZE       (GSM_CLASS_COUNT * 4 + 1)
+
+static GSM_RTO_t GSM_RTO[GSM_CLASS_COUNT];
+static boolean   GSM_RTOLoaded = FALSE;
+static uint32    GSM_RTOSaveTime;           // Timer_GetMillis() of the last EEPROM save, boot counts as one
+
+typedef struct
+{
+	uint8       Kind;                        // GSM_ResultKind_t
+	uint16      Code;                        // GSM_Error_t or GSM_ERR_ANY
+	uint8       Retries;
+	uint16      DelayMs;                     // Before the first resend, doubled for each next one
+
+} GSM_RetryRule_t;
+
+/*
+ * Errors worth a resend by GSM_Command_P(), first match wins. Anything not
+ * listed is final: a missing SIM, a PIN, a full memory or a plain ERROR does
+ * not go away by asking again. Add your own rows.
+ */
+static const GSM_RetryRule_t GSM_RetryTable[] PROGMEM =
+{
+	{ GSM_RESULT_CmeError, GSM_ERR_SimBusy,           3, 1000 },      // SIM still starting after a reset
+	{ GSM_RESULT_CmsError, GSM_ERR_SmsSimBusy,        3, 1000 },
+	{ GSM_RESULT_CmeError, GSM_ERR_NetworkTimeout,    2, 2000 },
+	{ GSM_RESULT_CmsError, GSM_ERR_SmsNetworkTimeout, 2, 2000 },
+	{ GSM_RESULT_CmeError, GSM_ERR_NoNetwork,         2, 5000 },      // Registration may come back
+	{ GSM_RESULT_CmsError, GSM_ERR_SmsNoNetwork,      2, 5000 },
+	{ GSM_RESULT_CmsError, GSM_ERR_SmsMeFailure,      1, 1000 },
+	{ GSM_RESULT_CmsError, GSM_ERR_SmsUnknown,        1, 2000 }
+};
+
+#define GSM_RETRY_RULES    (sizeof(GSM_RetryTable) / sizeof(GSM_RetryTable[0]))
+
+static uint8 GSM_ProfileEntry(APN_Profile_t Profile)
+{
+	if (Profile == PROFILE_AUTO)
+	{
+		return APN_Entry;
+	}
+
+	return (Profile < PROFILE_INVALID) ? (uint8)Profile : GSM_APN_NONE;
+}
+
+/* Returns a flash address, send it with USART_Transmit_String_P() */
+static const char *GSM_GetAPN(uint8 Entry)
+{
+	if (Entry >= GSM_APN_COUNT)
+	{
+		return NULL;                         // Invalid profile
+	}
+
+	return (const char*)pgm_read_ptr(&GSM_APNTable[Entry].APN);
+}
+
+static uint16 GSM_ParseNumber(const char *Str, uint8 Count)
+{
+	uint16 Value = 0;
+
+	while (Count--)
+	{
+		Value = (Value * 10) + (*Str++ - '0');
+	}
+
+	return Value;
+}
+
+/* PLMN is the MCC followed by the MNC, Length is 0 when the MNC length is unknown (IMSI) */
+static uint8 GSM_FindAPN(const char *PLMN, uint8 Length)
+{
+	GSM_APNEntry_t Entry;
+	uint16 MCC = GSM_ParseNumber(PLMN, 3);
+
+	for (uint8 Index = 0; Index < GSM_APN_COUNT; Index++)
+	{
+		memcpy_P(&Entry, &GSM_APNTable[Index], sizeof(Entry));
+		if (Entry.MCC == MCC && (Length == 0 || Length == (3 + Entry.MNCDigits)) &&
+		    Entry.MNC == GSM_ParseNumber(PLMN + 3, Entry.MNCDigits))
+		{
+			return Index;
+		}
+	}
+
+	return GSM_APN_NONE;
+}
+
+static void GSM_CaptureLine(const GSM_Capture_t *Capture, const uint8 *line)
+{
+	uint8 Index = 0;
+
+	if ((NULL == Capture->Prefix) ? (line[0] >= '0' && line[0] <= '9')
+	                              : (strncmp_P((const char*)line, Capture->Prefix, strlen_P(Capture->Prefix)) == 0))
+	{
+		while (Index < (Capture->Size - 1) && line[Index] != '\0' && line[Index] != '\r')
+		{
+			Capture->Line[Index] = line[Index];
+			Index++;
+		}
+		Capture->Line[Index] = '\0';
+	}
+}
+
+/* Learned timeout of a class as saved, SRTT + 4 * RTTVAR */
+static uint16 GSM_RTOValue(const GSM_RTO_t *Entry)
+{
+	uint32 Value = (Entry->Smoothed8 >> 3) + Entry->Deviation4;
+
+	return (Value > 0xFFFF) ? 0xFFFF : (uint16)Value;
+}
+
+/* Learned latencies of the last run, a corrupt or foreign block leaves the Initial values */
+static void GSM_LoadTimeouts(void)
+{
+	uint8  Block[GSM_RTO_SIZE];
+	uint8  Check = GSM_RTO_KEY;
+	uint16 Smoothed = 0;
+
+	GSM_RTOLoaded = TRUE;
+	if (EEPROM_ReadBlock(GSM_RTO_ADDRESS, Block, sizeof(Block)) != E_OK)
+	{
+		return;
+	}
+	for (uint8 Index = 0; Index < (GSM_RTO_SIZE - 1); Index++)
+	{
+		Check ^= Block[Index];
+	}
+	if (Check != Block[GSM_RTO_SIZE - 1])
+	{
+		return;
+	}
+
+	for (uint8 Class = 0; Class < GSM_CLASS_COUNT; Class++)
+	{
+		Smoothed = (uint16)Block[Class * 4] | ((uint16)Block[Class * 4 + 1] << 8);
+		if (Smoothed != 0 && Smoothed <= pgm_read_dword(&GSM_ClassTable[Class].Ceiling))
+		{
+			GSM_RTO[Class].Smoothed8 = (uint32)Smoothed << 3;
+			GSM_RTO[Class].Deviation4 = ((uint32)Block[Class * 4 + 2] | ((uint32)Block[Class * 4 + 3] << 8)) << 2;
+			GSM_RTO[Class].SavedMs = GSM_RTOValue(&GSM_RTO[Class]);
+		}
+	}
+}
+
+static void GSM_SaveTimeouts(void)
+{
+	uint8  Block[GSM_RTO_SIZE];
+	uint32 Smoothed = 0;
+	uint32 Deviation = 0;
+
+	Block[GSM_RTO_SIZE - 1] = GSM_RTO_KEY;
+	for (uint8 Class = 0; Class < GSM_CLASS_COUNT; Class++)
+	{
+		Smoothed = GSM_RTO[Class].Smoothed8 >> 3;
+		Deviation = GSM_RTO[Class].Deviation4 >> 2;
+		Smoothed = (Smoothed > 0xFFFF) ? 0xFFFF : Smoothed;
+		Deviation = (Deviation > 0xFFFF) ? 0xFFFF : Deviation;
+
+		Block[Class * 4]     = (uint8)Smoothed;
+		Block[Class * 4 + 1] = (uint8)(Smoothed >> 8);
+		Block[Class * 4 + 2] = (uint8)Deviation;
+		Block[Class * 4 + 3] = (uint8)(Deviation >> 8);
+		GSM_RTO[Class].SavedMs = GSM_RTOValue(&GSM_RTO[Class]);
+	}
+	for (uint8 Index = 0; Index < (GSM_RTO_SIZE - 1); Index++)
+	{
+		Block[GSM_RTO_SIZE - 1] ^= Block[Index];
+	}
+
+	EEPROM_UpdateBlock(GSM_RTO_ADDRESS, Block, sizeof(Block));         // Only rewrites changed bytes
+	GSM_RTOSaveTime = Timer_GetMillis();
+}
+
+/* RFC 6298: SRTT += (R - SRTT) / 8, RTTVAR += (|R - SRTT| - RTTVAR) / 4, kept scaled to stay in integers */
+static void GSM_RecordLatency(uint8 Class, uint32 Ms)
+{
+	GSM_RTO_t *Entry = &GSM_RTO[Class];
+	sint32 Delta = 0;
+	uint16 Value = 0;
+
+	if (Entry->Smoothed8 == 0)
+	{
+		Entry->Smoothed8 = (Ms << 3) | 1;                              // Never 0 again, even for a 0 ms answer
+		Entry->Deviation4 = Ms << 1;                                   // RTTVAR = R / 2
+	}
+	else
+	{
+		Delta = (sint32)Ms - (sint32)(Entry->Smoothed8 >> 3);
+		Entry->Smoothed8 += Delta;
+		Entry->Deviation4 += ((Delta < 0) ? -Delta : Delta) - (sint32)(Entry->Deviation4 >> 2);
+	}
+	Entry->Backoff = 0;
+
+	/* Per-sample jitter stays in RAM, the EEPROM only follows a lasting shift of the timeout */
+	Value = GSM_RTOValue(Entry);
+	if ((uint32)(Timer_GetMillis() - GSM_RTOSaveTime) >= GSM_RTO_SAVE_INTERVAL &&
+	    ((Value > Entry->SavedMs) ? (Value - Entry->SavedMs) : (Entry->SavedMs - Value)) > (Entry->SavedMs / GSM_RTO_SAVE_CHANGE))
+	{
+		GSM_SaveTimeouts();
+	}
+}
+
+/* Final result codes, E_OK with the kind and AT+CMEE=1 code in Result */
+static Std_ReturnType GSM_ParseResult(const uint8 *line, GSM_Result_t *Result)
+{
+	const uint8 *Digit = NULL;
+
+	Result->Code = 0;
+	if (strncmp_P((const char*)line, PSTR("+CME ERROR:"), 11) == 0)
+	{
+		Result->Kind = GSM_RESULT_CmeError;
+		Digit = line + 11;
+	}
+	else if (strncmp_P((const char*)line, PSTR("+CMS ERROR:"), 11) == 0)
+	{
+		Result->Kind = GSM_RESULT_CmsError;
+		Digit = line + 11;
+	}
+	else if (strncmp_P((const char*)line, PSTR("ERROR"), 5) == 0)
+	{
+		Result->Kind = GSM_RESULT_Error;
+	}
+	else if (line[0] == 'O' && line[1] == 'K' && (line[2] == '\r' || line[2] == '\n' || line[2] == '\0'))
+	{
+		Result->Kind = GSM_RESULT_Ok;
+	}
+	else
+	{
+		return E_NOT_OK;
+	}
+
+	if (NULL != Digit)
+	{
+		while (*Digit == ' ')
+		{
+			Digit++;
+		}
+		while (*Digit >= '0' && *Digit <= '9')
+		{
+			Result->Code = (Result->Code * 10) + (*Digit++ - '0');
+		}
+	}
+
+	return E_OK;
+}
+
+static void GSM_StorePayload(uint8 Byte)
+{
+	uint16 Next = (TCP_RxHead + 1) & (GSM_TCP_RX_BUFFER_SIZE - 1);
+
+	if (Next != TCP_RxTail)
+	{
+		TCP_RxBuffer[TCP_RxHead] = Byte;
+		TCP_RxHead = Next;
+		TCP_RxDropping = FALSE;
+	}
+	else if (TCP_RxDropping == FALSE)
+	{
+		TCP_RxDropping = TRUE;
+		LOG_WARN(LOG_GSM, "TCP RX buffer full, payload dropped");
+	}
+}
+
+/*
+ * Every read of the modem stream goes through here. A "+IPD,<len>:" header at the start of a line
+ * is cut out and its payload parked in TCP_RxBuffer, so a command wait running while data comes in
+ * can no longer swallow it. A line start that turns out not to be a header is handed on unchanged.
+ */
+static Std_ReturnType GSM_ReadByte(const USART_Config_t *USART, uint8 *Data)
+{
+	uint8 Byte = 0;
+	uint8 Last = 0;
+
+	while (TRUE)
+	{
+		if (TCP_Holding == FALSE && TCP_HeldOut < TCP_HeldLength)
+		{
+			*Data = TCP_Held[TCP_HeldOut++];
+			TCP_LineStart = (*Data == '\n') ? TRUE : FALSE;
+			return E_OK;
+		}
+		if (TCP_Holding == FALSE)
+		{
+			TCP_HeldLength = 0;
+			TCP_HeldOut = 0;
+		}
+		if (USART_Receive_Byte(USART, &Byte) != E_OK)
+		{
+			return E_NOT_OK;
+		}
+
+		if (TCP_PayloadLeft > 0)
+		{
+			GSM_StorePayload(Byte);
+			TCP_PayloadLeft--;
+			TCP_LineStart = (TCP_PayloadLeft == 0) ? TRUE : FALSE;   // The modem adds no line end after the payload
+		}
+		else if (TCP_Holding == TRUE)
+		{
+			Last = TCP_HeldLength;
+			TCP_Held[TCP_HeldLength++] = Byte;
+			if (Last < 5)
+			{
+				TCP_Holding = (Byte == pgm_read_byte(&GSM_IPD[Last])) ? TRUE : FALSE;
+			}
+			else if (Byte == ':' && Last > 5)
+			{
+				for (uint8 Index = 5; Index < Last; Index++)
+				{
+					TCP_PayloadLeft = (TCP_PayloadLeft * 10) + (TCP_Held[Index] - '0');
+				}
+				TCP_Holding = FALSE;
+				TCP_HeldLength = 0;                                     // Header consumed
+				TCP_LineStart = (TCP_PayloadLeft == 0) ? TRUE : FALSE;
+			}
+			else if (Byte < '0' || Byte > '9' || TCP_HeldLength == sizeof(TCP_Held))
+			{
+				TCP_Holding = FALSE;                                    // Some other '+' line, release it
+			}
+		}
+		else if (TCP_LineStart == TRUE && Byte == '+')
+		{
+			TCP_Held[0] = Byte;
+			TCP_HeldLength = 1;
+			TCP_HeldOut = 0;
+			TCP_Holding = TRUE;
+		}
+		else
+		{
+			*Data = Byte;
+			TCP_LineStart = (Byte == '\n') ? TRUE : FALSE;
+			return E_OK;
+		}
+	}
+}
+
+/* E_OK once GSM_Line holds a whole line, the CR LF stripped */
+static Std_ReturnType GSM_ReadLine(const USART_Config_t *USART)
+{
+	uint8 Byte = 0;
+
+	while (GSM_ReadByte(USART, &Byte) == E_OK)
+	{
+		if (Byte == '\n')
+		{
+			GSM_Line[GSM_LineIndex] = '\0';
+			GSM_LineIndex = 0;
+			if (strncmp_P((const char*)GSM_Line, PSTR("CLOSED"), 6) == 0)
+			{
+				TCP_State = GSM_TCP_Closed;                             // Seen by whichever wait was reading
+			}
+			return E_OK;
+		}
+		if (Byte != '\r' && Byte != '\0' && GSM_LineIndex < (GSM_LINE_SIZE - 1))
+		{
+			GSM_Line[GSM_LineIndex++] = Byte;
+		}
+	}
+
+	return E_NOT_OK;
+}
+
+static Std_ReturnType GSM_WaitFor(const USART_Config_t *USART, const char *expectedResponse, boolean InFlash, uint32 timeout, uint8 Class, const GSM_Capture_t *Capture)
+{
+	if (NULL == USART || NULL == expectedResponse) 
+	{
+		return E_NOT_OK;
+	}
+
+	uint8 *buffer = GSM_Line;
+    uint32 msTimer = 0;
+	boolean Heard = FALSE;
+	boolean Matched = FALSE;
+	uint32 MatchTime = 0;
+	boolean Interruptible = (Class & GSM_CLASS_INTERRUPTIBLE) ? TRUE : FALSE;
+	boolean Deferred = (Class & GSM_CLASS_DEFERRED) ? TRUE : FALSE;
+	uint32 Start = Timer_GetMillis();
+	GSM_Result_t Result;
+
+	Class &= GSM_CLASS_MASK;
+	GSM_LastResult.Kind = GSM_RESULT_Timeout;
+	GSM_LastResult.Code = 0;
+	GSM_LastResult.Retries = 0;
+	GSM_WaitDepth++;
+	while (msTimer < (timeout))			               // Timeout loop
+	{
+		if (Matched == FALSE && Interruptible == TRUE && NULL != GSM_PreemptCheck && GSM_PreemptCheck() == TRUE)
+		{
+			GSM_WasPreempted = TRUE;                   // No timeout, no backoff, the answer simply is not awaited
+			GSM_LastResult.Kind = GSM_RESULT_Preempted;
+			GSM_WaitDepth--;
+			LOG_INFO(LOG_GSM, "Wait preempted");
+			return E_NOT_OK;
+		}
+		if (GSM_ReadLine(USART) == E_OK)               // A whole line from the modem, +IPD data already taken out
+		{
+			Heard = TRUE;
+			if (buffer[0] == 'A' && buffer[1] == 'T')
+			{
+				TRACE(TRACE_CMD, Trace_Hash(buffer));  // Command echo, ATE1 is on
+				LOG_DEBUG_LINE(LOG_GSM, "> ", buffer);
+			}
+			else if (strstr_P((char*)buffer, PSTR("ERROR")) != NULL)
+			{
+				TRACE(TRACE_RESULT, TRACE_ResultError);
+				LOG_WARN_LINE(LOG_GSM, "< ", buffer);
+			}
+			else
+			{
+				LOG_DEBUG_LINE(LOG_GSM, "< ", buffer);
+			}
+			GSM_DispatchURC(buffer);                   // Hand unsolicited lines to their owner
+			if (NULL != Capture)
+			{
+				GSM_CaptureLine(Capture, buffer);      // Keep the answer line of the command
+			}
+			// Check if expected response is in buffer
+			if (Matched == FALSE && ((InFlash == TRUE) ? strstr_P((char*)buffer, expectedResponse) : strstr((char*)buffer, expectedResponse)) != NULL)
+			{
+				TRACE(TRACE_RESULT, TRACE_ResultMatch);
+				if (Class < GSM_CLASS_COUNT)
+				{
+					GSM_RecordLatency(Class, Timer_GetMillis() - Start);
+				}
+				GSM_LastResult.Kind = GSM_RESULT_Expected;
+				/* Only a "+CMD: ..." information response of a command still has its OK to come,
+				   SEND OK, CONNECT OK, SHUT OK and URCs awaited after a deferred OK are the last line */
+				if (buffer[0] != '+' || Deferred == TRUE || GSM_ParseResult(buffer, &Result) == E_OK)
+				{
+					GSM_WaitDepth--;
+					return E_OK;					  // Response found 
+				}
+				Matched = TRUE;                        // Take the OK behind it too, it must not end the next wait
+				MatchTime = Timer_GetMillis();
+			}
+			/* The command finished without the answer, no point waiting out the timeout */
+			else if (buffer[0] != 'A' && GSM_ParseResult(buffer, &Result) == E_OK &&
+			         (Matched == TRUE || Result.Kind != GSM_RESULT_Ok || Deferred == FALSE))
+			{
+				if (Matched == TRUE)
+				{
+					GSM_WaitDepth--;
+					return E_OK;                       // Final result closing the matched answer
+				}
+				if (Class < GSM_CLASS_COUNT)
+				{
+					GSM_RecordLatency(Class, Timer_GetMillis() - Start);   // An error is an answer too
+				}
+				GSM_LastResult.Kind = Result.Kind;
+				GSM_LastResult.Code = Result.Code;
+				GSM_WaitDepth--;
+				return E_NOT_OK;
+			}
+		}
+		Trace_Drain(USART_DEBUG);                      // Ship trace frames while the debug UART has room
+		Log_Process();                                 // Log text only once the debug UART is idle
+		Watchdog_Kick();                               // The wait is bounded by timeout, a hang elsewhere is not
+		if (Matched == TRUE && (uint32)(Timer_GetMillis() - MatchTime) >= GSM_TRAILER_MS)
+		{
+			break;                                     // The OK never came, the answer still counts
+		}
+		Timer_DelayMs(1);                              // Idle sleep until the next 1 ms tick
+		msTimer++;
+	}
+	GSM_WaitDepth--;
+
+	if (Matched == TRUE)
+	{
+		return E_OK;
+	}
+
+	if (Heard == FALSE && GSM_Timeouts < 0xFF)
+	{
+		GSM_Timeouts++;                                // Silent modem, see GSM_GetTimeouts()
+	}
+	else if (Heard == TRUE && Class < GSM_CLASS_COUNT && GSM_RTO[Class].Backoff < GSM_RTO_BACKOFF_MAX)
+	{
+		GSM_RTO[Class].Backoff++;                      // The modem talked but answered late, a silent one gets no longer waits
+	}
+	TRACE(TRACE_RESULT, TRACE_ResultTimeout);
+	LOG_WARN(LOG_GSM, "Response timeout");
+	return E_NOT_OK;  // Timeout occurred
+}
+
+/* A plain AT also locks the modem autobaud when AT+IPR=0 */
+static Std_ReturnType GSM_ProbeAT(const USART_Config_t *USART)
+{
+	for (uint8 Attempt = 0; Attempt < GSM_BAUD_PROBES; Attempt++)
+	{
+		USART_Flush(USART);                                            // Drop bytes received at the wrong rate
+		USART_Transmit_String_P(USART, PSTR("AT\r\n"));
+		if (GSM_WaitForResponse_P(USART, PSTR("OK"), 300) == E_OK)
+		{
+			return E_OK;
+		}
+	}
+
+	return E_NOT_OK;
+}
+
+/* Restart is FALSE when the modem was just reset by someone else and the UART already runs at its rate */
+static Std_ReturnType GSM_Setup(const USART_Config_t *USART, const USART_Config_t *DEBUG_UART, APN_Profile_t Profile, boolean Restart)
+{
+	Std_ReturnType ret = E_OK;
+	
+	if(NULL == USART)
+	{
+		ret = E_NOT_OK;
+	}
+	else
+	{
+		Operator = Profile;
+		USART_DEBUG = DEBUG_UART;
+		TCP_State = GSM_TCP_Closed;                                        // The restart drops any connection
+		if (Restart == TRUE)
+		{
+			USART_Init(USART);
+		}
+		ret = GSM_SyncBaudRate(USART);                                     // The modem may still be at an earlier AT+IPR rate
+		
+		if (Restart == TRUE)
+		{
+			USART_Transmit_String_P(USART, PSTR("AT+CFUN=1,1\r\n"));           // Restart 
+			GSM_WaitFor(USART, PSTR("+CREG: 1"), TRUE, 30000, GSM_CLASS_COUNT | GSM_CLASS_DEFERRED, NULL);   // Registration is not checked here, only a responsive modem
+		}
+		
+		/* The module answers every setup command once it is up, any silence fails the init */
+		if (GSM_Command_P(USART, PSTR("ATE1\r\n"), PSTR("OK"), GSM_CLASS_Local) != E_OK)   // Disable echo
+		{
+			ret = E_NOT_OK;
+		}
+		
+		if (GSM_Command_P(USART, PSTR("AT\r\n"), PSTR("OK"), GSM_CLASS_Local) != E_OK)   // Check module
+		{
+			ret = E_NOT_OK;
+		}
+		if (GSM_Command_P(USART, PSTR("AT+CMEE=1\r\n"), PSTR("OK"), GSM_CLASS_Local) != E_OK)   // Numeric +CME/+CMS ERROR codes
+		{
+			ret = E_NOT_OK;
+		}
+
+		if (USART_FlowControlEnabled(USART) == TRUE)
+		{
+			if (GSM_Command_P(USART, PSTR("AT+IFC=2,2\r\n"), PSTR("OK"), GSM_CLASS_Local) != E_OK)   // RTS/CTS in both directions
+			{
+				ret = E_NOT_OK;
+			}
+		}
+		
+		if (GSM_Command_P(USART, PSTR("AT+CMGF=1\r\n"), PSTR("OK"), GSM_CLASS_Local) != E_OK)   // Set SMS to text mode
+		{
+			ret = E_NOT_OK;
+		}
+		
+		if (GSM_Command_P(USART, PSTR("AT+CNMI=2,1,0,0,0\r\n"), PSTR("OK"), GSM_CLASS_Local) != E_OK)   // Enable new SMS notification
+		{
+			ret = E_NOT_OK;
+		}
+
+		if (ret == E_OK && Profile == PROFILE_AUTO)
+		{
+			ret = GSM_DetectAPN(USART, FALSE);                                 // Pick the APN from the SIM
+		}
+	}
+	
+	return ret;
+}
+
 Std_ReturnType GSM_Init(const USART_Config_t *USART, const USART_Config_t *DEBUG_UART, APN_Profile_t Profile)
 {
-	Std_ReturnType ret = E_OK;
-	
-	if(NULL == USART)
-	{
-		ret = E_NOT_OK;
-	}
-	else
+	return GSM_Setup(USART, DEBUG_UART, Profile, TRUE);
+}
+
+/**
+* @brief Same setup as GSM_Init() without AT+CFUN=1,1, for a modem that was just restarted.
+* @note  Used after Recovery's AT+CFUN=1,1 or PWRKEY step, keeps the current UART rate.
+*/
+Std_ReturnType GSM_Reinit(const USART_Config_t *USART, const USART_Config_t *DEBUG_UART, APN_Profile_t Profile)
+{
+	return GSM_Setup(USART, DEBUG_UART, Profile, FALSE);
+}
+
+Std_ReturnType GSM_WaitForResponse(const USART_Config_t *USART, const char *expectedResponse, uint32 timeout)
+{
+	return GSM_WaitFor(USART, expectedResponse, FALSE, timeout, GSM_CLASS_COUNT, NULL);
+}
+
+Std_ReturnType GSM_WaitForResponse_P(const USART_Config_t *USART, const char *expectedResponse, uint32 timeout)
+{
+	return GSM_WaitFor(USART, expectedResponse, TRUE, timeout, GSM_CLASS_COUNT, NULL);
+}
+
+/**
+* @brief Waits for a flash string answer with the learned timeout of the command class.
+*/
+Std_ReturnType GSM_WaitForClass_P(const USART_Config_t *USART, const char *expectedResponse, GSM_CmdClass_t Class)
+{
+	if (Class >= GSM_CLASS_COUNT)
+	{
+		return E_NOT_OK;
+	}
+
+	return GSM_WaitFor(USART, expectedResponse, TRUE, GSM_GetTimeout(Class), Class, NULL);
+}
+
+/* Like GSM_WaitForClass_P() but gives way to urgent work, see GSM_SetPreempt(). Class may carry GSM_CLASS_DEFERRED */
+static Std_ReturnType GSM_WaitForInterruptible_P(const USART_Config_t *USART, const char *expectedResponse, uint8 Class)
+{
+	return GSM_WaitFor(USART, expectedResponse, TRUE, GSM_GetTimeout((GSM_CmdClass_t)(Class & GSM_CLASS_MASK)),
+	                   Class | GSM_CLASS_INTERRUPTIBLE, NULL);
+}
+
+/* TRUE after the backoff delay when GSM_RetryTable allows resend number Attempt + 1 of the last result */
+static boolean GSM_RetryAllowed(uint8 Attempt)
+{
+	GSM_RetryRule_t Rule;
+	uint32 DelayMs = 0;
+
+	for (uint8 Index = 0; Index < GSM_RETRY_RULES; Index++)
+	{
+		memcpy_P(&Rule, &GSM_RetryTable[Index], sizeof(Rule));
+		if (Rule.Kind == GSM_LastResult.Kind && (Rule.Code == GSM_ERR_ANY || Rule.Code == GSM_LastResult.Code))
+		{
+			if (Attempt >= Rule.Retries)
+			{
+				return FALSE;
+			}
+			DelayMs = (uint32)Rule.DelayMs << Attempt;
+			LOG_INFO(LOG_GSM, "Retrying command");
+			while (DelayMs > 0)                            // Kept short for the watchdog of a recovery step
+			{
+				Watchdog_Kick();
+				Timer_DelayMs((DelayMs > 100) ? 100 : (uint16)DelayMs);
+				DelayMs = (DelayMs > 100) ? (DelayMs - 100) : 0;
+			}
+			return TRUE;
+		}
+	}
+
+	return FALSE;
+}
+
+/**
+* @brief Sends a flash string command and waits for its answer with the learned timeout of its class.
+* @note  A +CME or +CMS error listed in GSM_RetryTable is resent after its backoff, see GSM_GetResult().
+*/
+Std_ReturnType GSM_Command_P(const USART_Config_t *USART, const char *Command, const char *expectedResponse, GSM_CmdClass_t Class)
+{
+	Std_ReturnType ret = E_NOT_OK;
+	uint8 Attempt = 0;
+
+	if (NULL == USART || NULL == Command || Class >= GSM_CLASS_COUNT)
+	{
+		return E_NOT_OK;
+	}
+
+	do
+	{
+		USART_Transmit_String_P(USART, Command);
+		ret = GSM_WaitForClass_P(USART, expectedResponse, Class);
+	}
+	while (ret != E_OK && GSM_RetryAllowed(Attempt++) == TRUE);
+	GSM_LastResult.Retries = Attempt - ((ret == E_OK) ? 0 : 1);
+
+	return ret;
+}
+
+/* How the last wait ended, with the +CME or +CMS code and the resends of GSM_Command_P() */
+Std_ReturnType GSM_GetResult(GSM_Result_t *Result)
+{
+	Std_ReturnType ret = E_OK;
+
+	if (NULL == Result)
+	{
+		ret = E_NOT_OK;
+	}
+	else
+	{
+		*Result = GSM_LastResult;
+	}
+
+	return ret;
+}
+
+Std_ReturnType GSM_SyncBaudRate(const USART_Config_t *USART)
+{
+	uint32 Start = 0;
+	uint32 Rate = 0;
+
+	if (NULL == USART)
+	{
+		return E_NOT_OK;
+	}
+
+	if (GSM_ProbeAT(USART) == E_OK)
+	{
+		return E_OK;                                                   // Already in step
+	}
+
+	/* The modem kept an AT+IPR rate across a reset the MCU did not, scan for it */
+	Start = USART_GetBaudRate(USART);
+	for (uint8 Index = 0; Index < GSM_BAUD_COUNT; Index++)
+	{
+		Rate = pgm_read_dword(&GSM_BaudRates[Index]);
+		if (Rate != Start && USART_SetBaudRate(USART, Rate) == E_OK && GSM_ProbeAT(USART) == E_OK)
+		{
+			return E_OK;
+		}
+	}
+
+	USART_SetBaudRate(USART, Start);
+	return E_NOT_OK;
+}
+
+Std_ReturnType GSM_NegotiateBaudRate(const USART_Config_t *USART, uint32 *BaudRate)
+{
+	Std_ReturnType ret = E_OK;
+	char   Command[20];
+	uint32 Current = 0;
+	uint32 Rate = 0;
+
+	if (NULL == USART)
+	{
+		return E_NOT_OK;
+	}
+
+	ret = GSM_SyncBaudRate(USART);
+	Current = USART_GetBaudRate(USART);
+
+	/* The first rate clean enough for F_CPU wins, the modem answers OK at the old rate then switches */
+	for (uint8 Index = 0; ret == E_OK && Index < GSM_BAUD_COUNT; Index++)
+	{
+		Rate = pgm_read_dword(&GSM_BaudRates[Index]);
+		if (USART_BaudRateError(Rate, NULL) > GSM_BAUD_ERROR_LIMIT)
+		{
+			continue;
+		}
+		if (Rate == Current)
+		{
+			break;                                                     // Already at the best rate
+		}
+
+		sprintf_P(Command, PSTR("AT+IPR=%lu\r\n"), Rate);
+		USART_Transmit_String(USART, (const uint8*)Command);
+		if (GSM_WaitForResponse_P(USART, PSTR("OK"), 1000) != E_OK)
+		{
+			continue;                                                  // Rate refused, try the next one down
+		}
+
+		USART_SetBaudRate(USART, Rate);
+		if (GSM_ProbeAT(USART) == E_OK)
+		{
+			Current = Rate;
+			break;
+		}
+
+		/* No usable link at the new rate, ask the modem back blindly and resync */
+		sprintf_P(Command, PSTR("AT+IPR=%lu\r\n"), Current);
+		USART_Transmit_String(USART, (const uint8*)Command);
+		_delay_ms(100);
+		USART_SetBaudRate(USART, Current);
+		ret = GSM_SyncBaudRate(USART);
+		Current = USART_GetBaudRate(USART);
+	}
+
+	if (NULL != BaudRate)
 	{
-		Operator = Profile;
-		USART_DEBUG = DEBUG_UART;
-		USART_Init(USART);
-		
-		USART_Transmit_String(USART, (const uint8*)"AT+CFUN=1,1\r\n");         // Restart 
-		GSM_WaitForResponse(USART, (const char*)"+CREG: 1", 30000);
-		
-		USART_Transmit_String(USART, (const uint8*)"ATE1\r\n");                // Disable echo
-		GSM_WaitForResponse(USART, (const char*)"OK", 2000);
-		
-		USART_Transmit_String(USART, (const uint8*)"AT\r\n");                  // Check module
-		GSM_WaitForResponse(USART, (const char*)"OK", 2000);
-		
-		USART_Transmit_String(USART, (const uint8*)"AT+CMGF=1\r\n");           // Set SMS to text mode
-		GSM_WaitForResponse(USART, (const char*)"OK", 2000);
-		
-		USART_Transmit_String(USART, (const uint8*)"AT+CNMI=2,1,0,0,0\r\n");   // Enable new SMS notification 
-		GSM_WaitForResponse(USART, (const char*)"OK", 2000);
+		*BaudRate = Current;
 	}
-	
+
 	return ret;
 }
 
-Std_ReturnType GSM_WaitForResponse(const USART_Config_t *USART, const char *expectedResponse, uint32 timeout)
+Std_ReturnType GSM_DetectAPN(const USART_Config_t *USART, boolean Force)
 {
-	if (NULL == USART || NULL == expectedResponse) 
+	GSM_APNEntry_t Entry;
+	GSM_Capture_t  Capture;
+	uint8  Line[24];
+	uint8  Cache[6];
+	uint8  Index = GSM_APN_NONE;
+	uint8  Length = 0;
+	char  *PLMN = NULL;
+
+	if (NULL == USART)
 	{
 		return E_NOT_OK;
 	}
 
-    USART_StringStatus_t GSMString_Status = USART_StringUnavailable;
-	uint8 buffer[512] = {0};	
-    uint32 msTimer = 0;							       // Buffer to store received data
+	/* The cached operator skips the lookup, GSM_SetAPNProfile() forces a new one if the bearer fails */
+	if (Force == FALSE && EEPROM_ReadBlock(GSM_APN_CACHE_ADDRESS, Cache, sizeof(Cache)) == E_OK && Cache[4] < GSM_APN_COUNT &&
+	    Cache[5] == (Cache[0] ^ Cache[1] ^ Cache[2] ^ Cache[3] ^ Cache[4] ^ GSM_APN_CACHE_KEY))
+	{
+		memcpy_P(&Entry, &GSM_APNTable[Cache[4]], sizeof(Entry));
+		if (Entry.MCC == ((uint16)Cache[0] | ((uint16)Cache[1] << 8)) && Entry.MNC == ((uint16)Cache[2] | ((uint16)Cache[3] << 8)))
+		{
+			APN_Entry = Cache[4];
+			APN_FromCache = TRUE;
+			return E_OK;
+		}
+	}
 
-	while (msTimer < (timeout))			               // Timeout loop
+	/* The IMSI starts with the home MCC/MNC and is readable without network */
+	Capture.Prefix = NULL;
+	Capture.Line = Line;
+	Capture.Size = sizeof(Line);
+	Line[0] = '\0';
+	USART_Transmit_String_P(USART, PSTR("AT+CIMI\r\n"));
+	GSM_WaitFor(USART, PSTR("OK"), TRUE, GSM_GetTimeout(GSM_CLASS_Query), GSM_CLASS_Query, &Capture);
+	if (strspn_P((const char*)Line, PSTR("0123456789")) >= 6)
 	{
-		USART_Receive_String(USART, buffer);           /* Receive from GSM */    
-		USART_StringReady(USART, &GSMString_Status);  
-		if (GSMString_Status == USART_StringAvailable) // If data is received
+		Index = GSM_FindAPN((const char*)Line, 0);
+	}
+
+	/* Unknown home network, fall back to the registered one in numeric format */
+	if (Index == GSM_APN_NONE)
+	{
+		GSM_Command_P(USART, PSTR("AT+COPS=3,2\r\n"), PSTR("OK"), GSM_CLASS_Local);
+
+		Capture.Prefix = PSTR("+COPS:");
+		Line[0] = '\0';
+		USART_Transmit_String_P(USART, PSTR("AT+COPS?\r\n"));               // +COPS: 0,2,"60202"
+		GSM_WaitFor(USART, PSTR("OK"), TRUE, GSM_GetTimeout(GSM_CLASS_Query), GSM_CLASS_Query, &Capture);
+		PLMN = strchr((char*)Line, '"');
+		if (NULL != PLMN)
 		{
-			USART_Transmit_String(USART_DEBUG, buffer);
-			// Check if expected response is in buffer
-			if (strstr((char*)buffer, expectedResponse) != NULL)
+			Length = strspn_P(++PLMN, PSTR("0123456789"));
+			if (Length == 5 || Length == 6)
 			{
-				_delay_ms(1000);
-				return E_OK;						  // Response found 
+				Index = GSM_FindAPN(PLMN, Length);
 			}
-					
-            else 
-			{
-	            // Buffer overflow - reset buffer
-	            memset(buffer, 0, sizeof(buffer));
-            }
-			GSMString_Status = USART_StringUnavailable;
 		}
-		_delay_ms(1);
-		msTimer++;
 	}
 
-	return E_NOT_OK;  // Timeout occurred
+	if (Index == GSM_APN_NONE)
+	{
+		return E_NOT_OK;                                                   // Operator not in GSM_APNTable
+	}
+
+	memcpy_P(&Entry, &GSM_APNTable[Index], sizeof(Entry));
+	Cache[0] = (uint8)(Entry.MCC & 0xFF);
+	Cache[1] = (uint8)(Entry.MCC >> 8);
+	Cache[2] = (uint8)(Entry.MNC & 0xFF);
+	Cache[3] = (uint8)(Entry.MNC >> 8);
+	Cache[4] = Index;
+	Cache[5] = Cache[0] ^ Cache[1] ^ Cache[2] ^ Cache[3] ^ Cache[4] ^ GSM_APN_CACHE_KEY;
+	EEPROM_UpdateBlock(GSM_APN_CACHE_ADDRESS, Cache, sizeof(Cache));   // Only rewrites changed bytes
+
+	APN_Entry = Index;
+	APN_FromCache = FALSE;
+
+	return E_OK;
 }
 
 Std_ReturnType GSM_SetAPNProfile(const USART_Config_t *USART, APN_Profile_t Profile)
@@ -94,36 +984,36 @@ Std_ReturnType GSM_SetAPNProfile(const USART_Config_t *USART, APN_Profile_t Prof
 	else
 	{
 		/* Common GPRS Configuration */
-		USART_Transmit_String(USART, (const uint8*)"AT+SAPBR=3,1,\"CONTYPE\",\"GPRS\"\r\n");
-		GSM_WaitForResponse(USART, (const char*)"OK", 5000);
+		GSM_Command_P(USART, PSTR("AT+SAPBR=3,1,\"CONTYPE\",\"GPRS\"\r\n"), PSTR("OK"), GSM_CLASS_Local);
 
 		/* Set APN based on the selected profile */
-		switch (Profile)
+		if (Profile == PROFILE_AUTO && APN_Entry == GSM_APN_NONE)
+		{
+			GSM_DetectAPN(USART, FALSE);
+		}
+		const char *APN = GSM_GetAPN(GSM_ProfileEntry(Profile));
+		if (NULL == APN)
 		{
-			case WE:
-			USART_Transmit_String(USART, (const uint8*)"AT+SAPBR=3,1,\"APN\",\"internet.te.eg\"\r\n");
-			break;
-			case ORANGE:
-			USART_Transmit_String(USART, (const uint8*)"AT+SAPBR=3,1,\"APN\",\"mobinilweb\"\r\n");
-			break;
-			case ETISALAT:
-			USART_Transmit_String(USART, (const uint8*)"AT+SAPBR=3,1,\"APN\",\"internet\"\r\n");
-			break;
-			case VODAFONE:
-			USART_Transmit_String(USART, (const uint8*)"AT+SAPBR=3,1,\"APN\",\"internet.vodafone.net\"\r\n");
-			break;
-			default:
 			ret = E_NOT_OK;  // Invalid profile
-			break;
 		}
-
-		GSM_WaitForResponse(USART, (const char*)"OK", 5000);
+		else
+		{
+			USART_Transmit_String_P(USART, PSTR("AT+SAPBR=3,1,\"APN\",\""));
+			USART_Transmit_String_P(USART, APN);
+			USART_Transmit_String_P(USART, PSTR("\"\r\n"));
+			GSM_WaitForClass_P(USART, PSTR("OK"), GSM_CLASS_Local);
+		}
 
 		/* Activate GPRS */
 		if (ret == E_OK)
 		{
-			USART_Transmit_String(USART, (const uint8*)"AT+SAPBR=1,1\r\n");
-			GSM_WaitForResponse(USART, (const char*)"OK", 5000);
+			ret = GSM_Command_P(USART, PSTR("AT+SAPBR=1,1\r\n"), PSTR("OK"), GSM_CLASS_Bearer);
+		}
+
+		/* A cached operator may belong to a swapped SIM, look it up once more */
+		if (ret != E_OK && Profile == PROFILE_AUTO && APN_FromCache == TRUE && GSM_DetectAPN(USART, TRUE) == E_OK)
+		{
+			ret = GSM_SetAPNProfile(USART, PROFILE_AUTO);
 		}
 	}
 
@@ -133,17 +1023,23 @@ Std_ReturnType GSM_SetAPNProfile(const USART_Config_t *USART, APN_Profile_t Prof
 Std_ReturnType GSM_MakeCall(const USART_Config_t *USART, const uint8* number)
 {
 	Std_ReturnType ret = E_OK;
+	uint8 Attempt = 0;
 	
 	if(NULL == USART)
 	{
 		ret = E_NOT_OK;
 	}
-	else
+	else
 	{
-		USART_Transmit_String(USART, (const uint8*)"ATD");     
-		USART_Transmit_String(USART, number);
-		USART_Transmit_String(USART, (const uint8*)";\r\n");
-		GSM_WaitForResponse(USART, (const char*)"OK", 5000);
+		do
+		{
+			USART_Transmit_String_P(USART, PSTR("ATD"));     
+			USART_Transmit_String(USART, number);
+			USART_Transmit_String_P(USART, PSTR(";\r\n"));
+			ret = GSM_WaitForClass_P(USART, PSTR("OK"), GSM_CLASS_Network);
+		}
+		while (ret != E_OK && GSM_RetryAllowed(Attempt++) == TRUE);
+		GSM_LastResult.Retries = Attempt - ((ret == E_OK) ? 0 : 1);
 	}
 	
 	return ret;
@@ -152,21 +1048,27 @@ Std_ReturnType GSM_MakeCall(const USART_Config_t *USART, const uint8* number)
 Std_ReturnType GSM_SendSMS(const USART_Config_t *USART, const uint8* number, const uint8* message)
 {
 	Std_ReturnType ret = E_OK;
+	uint8 Attempt = 0;
 	
 	if(NULL == USART)
 	{
 		ret = E_NOT_OK;
 	}
-	else
+	else
 	{
-		USART_Transmit_String(USART, (const uint8*)"AT+CMGS=\"");
-		USART_Transmit_String(USART, number);
-		USART_Transmit_String(USART, (const uint8*)"\"\r\n");
-		USART_Transmit_String(USART, message);
-		_delay_ms(100);
-		USART_Transmit_Byte(USART, 0x1A);          // End message with Ctrl+Z
-		USART_Transmit_Byte(USART, '\n'); 
-		GSM_WaitForResponse(USART, (const char*)"OK", 5000);
+		do
+		{
+			USART_Transmit_String_P(USART, PSTR("AT+CMGS=\""));
+			USART_Transmit_String(USART, number);
+			USART_Transmit_String_P(USART, PSTR("\"\r\n"));
+			USART_Transmit_String(USART, message);
+			_delay_ms(100);
+			USART_Transmit_Byte(USART, 0x1A);      // End message with Ctrl+Z
+			USART_Transmit_Byte(USART, '\n'); 
+			ret = GSM_WaitForClass_P(USART, PSTR("OK"), GSM_CLASS_Network);
+		}
+		while (ret != E_OK && GSM_RetryAllowed(Attempt++) == TRUE);   // +CMS ERROR: 314 or 332 is worth another go
+		GSM_LastResult.Retries = Attempt - ((ret == E_OK) ? 0 : 1);
 	}
 	
 	return ret;
@@ -182,7 +1084,7 @@ Std_ReturnType GSM_CheckNewSMS(const USART_Config_t *USART, const uint8 *buffer,
 	}
 	else
 	{
-		if (strstr((char*)buffer, "+CMTI:") != NULL)
+		if (strstr_P((char*)buffer, PSTR("+CMTI:")) != NULL)
 		{
 			*State = 1;  // New SMS detected
 		}
@@ -206,8 +1108,7 @@ Std_ReturnType GSM_ReceiveSMS(const USART_Config_t *USART)
 	else
 	{
 		/* Send AT command to list unread SMS */
-		USART_Transmit_String(USART, (const uint8*)"AT+CMGL=\"REC UNREAD\"\r\n");
-		GSM_WaitForResponse(USART, (const char*)"+CMGL: 1", 3000);
+		GSM_Command_P(USART, PSTR("AT+CMGL=\"REC UNREAD\"\r\n"), PSTR("+CMGL: 1"), GSM_CLASS_Query);
 	}
 	
 	return ret;
@@ -241,29 +1142,392 @@ Std_ReturnType GSM_GetGPRS_Response(const USART_Config_t *USART)
 	}
 	else
 	{	
-		USART_Transmit_String(USART, (const uint8*)"AT+HTTPINIT\r\n");  // Initialize HTTP service
-		GSM_WaitForResponse(USART, (const char*)"OK", 5000);
+		GSM_WasPreempted = FALSE;
+
+		GSM_Command_P(USART, PSTR("AT+HTTPINIT\r\n"), PSTR("OK"), GSM_CLASS_Local);   // Initialize HTTP service
 		
-		USART_Transmit_String(USART, (const uint8*)"AT+HTTPPARA=\"CID\",1\r\n");  // Use bearer profile 1
-		GSM_WaitForResponse(USART, (const char*)"OK", 5000);
+		GSM_Command_P(USART, PSTR("AT+HTTPPARA=\"CID\",1\r\n"), PSTR("OK"), GSM_CLASS_Local);   // Use bearer profile 1
 		
 		// Set URL to fetch date
-		USART_Transmit_String(USART, (const uint8*)"AT+HTTPPARA=\"URL\",\"http://api.quotable.io/random?tags=wisdom\"\r\n");
-		GSM_WaitForResponse(USART, (const char*)"OK", 5000);
+		GSM_Command_P(USART, PSTR("AT+HTTPPARA=\"URL\",\"http://api.quotable.io/random?tags=wisdom\"\r\n"), PSTR("OK"), GSM_CLASS_Local);
 		
-		USART_Transmit_String(USART, (const uint8*)"AT+HTTPACTION=0\r\n");  // Perform GET request
-		GSM_WaitForResponse(USART, (const char*)"+HTTPACTION: 0,200", 5000);
+		USART_Transmit_String_P(USART, PSTR("AT+HTTPACTION=0\r\n"));        // Perform GET request
+		ret = GSM_WaitForInterruptible_P(USART, PSTR("+HTTPACTION: 0,200"), GSM_CLASS_Data | GSM_CLASS_DEFERRED);
 		
-		USART_Transmit_String(USART, (const uint8*)"AT+HTTPREAD\r\n");  // Read response
-		GSM_WaitForResponse(USART, (const char*)"{\"", 5000);
+		if (ret == E_OK)
+		{
+			ret = GSM_Command_P(USART, PSTR("AT+HTTPREAD\r\n"), PSTR("{\""), GSM_CLASS_Query);   // Read response
+		}
+		/* Failed or preempted: AT+HTTPTERM below drops the request in flight */
 
 		// Close HTTP connection
-		USART_Transmit_String(USART, (const uint8*)"AT+HTTPTERM\r\n");  // Terminate HTTP service
-		GSM_WaitForResponse(USART, (const char*)"OK", 5000);
+		GSM_Command_P(USART, PSTR("AT+HTTPTERM\r\n"), PSTR("OK"), GSM_CLASS_Local);   // Terminate HTTP service
 		
-		USART_Transmit_String(USART, (const uint8*)"AT+SAPBR=0,1\r\n");  // Terminate GPRS service
-		GSM_WaitForResponse(USART, (const char*)"OK", 5000);
+		GSM_Command_P(USART, PSTR("AT+SAPBR=0,1\r\n"), PSTR("OK"), GSM_CLASS_Bearer);   // Terminate GPRS service
 	}
 	
 	return ret;
 }
+
+
+Std_ReturnType GSM_WaitForPrompt(const USART_Config_t *USART, uint32 timeout)
+{
+	if (NULL == USART)
+	{
+		return E_NOT_OK;
+	}
+
+	uint8 ReceivedCharacter = ZERO_INIT;
+	uint32 Start = Timer_GetMillis();
+
+	GSM_WaitDepth++;
+	while ((uint32)(Timer_GetMillis() - Start) < timeout)
+	{
+		/* The '>' prompt is not followed by a line ending, so read raw bytes instead of lines */
+		while (GSM_ReadByte(USART, &ReceivedCharacter) == E_OK)
+		{
+			if (ReceivedCharacter == '>')
+			{
+				GSM_LineIndex = 0;                     // The echo before it is not a line anyone waits for
+				GSM_WaitDepth--;
+				return E_OK;
+			}
+		}
+		Watchdog_Kick();                               // Bounded by timeout, like GSM_WaitFor()
+		Timer_DelayMs(1);
+	}
+	GSM_WaitDepth--;
+
+	return E_NOT_OK;  // Timeout occurred
+}
+
+Std_ReturnType GSM_TCP_Open(const USART_Config_t *USART, const uint8 *host, uint16 port)
+{
+	Std_ReturnType ret = E_OK;
+	const char *APN = GSM_GetAPN(GSM_ProfileEntry(Operator));
+	char PortString[16];
+
+	if (NULL == USART || NULL == host || NULL == APN)
+	{
+		ret = E_NOT_OK;
+	}
+	else
+	{
+		TCP_State = GSM_TCP_Closed;
+		TCP_PayloadLeft = 0;
+		TCP_Holding = FALSE;
+		TCP_HeldLength = 0;
+		TCP_RxHead = 0;
+		TCP_RxTail = 0;
+
+		GSM_Command_P(USART, PSTR("AT+CIPSHUT\r\n"), PSTR("SHUT OK"), GSM_CLASS_Bearer);   // Drop any stale PDP context
+
+		GSM_Command_P(USART, PSTR("AT+CIPMUX=0\r\n"), PSTR("OK"), GSM_CLASS_Local);   // Single connection mode
+
+		GSM_Command_P(USART, PSTR("AT+CIPHEAD=1\r\n"), PSTR("OK"), GSM_CLASS_Local);   // Prefix received data with +IPD,<len>:
+
+		USART_Transmit_String_P(USART, PSTR("AT+CSTT=\""));                    // Start task with the operator APN
+		USART_Transmit_String_P(USART, APN);
+		USART_Transmit_String_P(USART, PSTR("\"\r\n"));
+		GSM_WaitForClass_P(USART, PSTR("OK"), GSM_CLASS_Local);
+
+		ret = GSM_Command_P(USART, PSTR("AT+CIICR\r\n"), PSTR("OK"), GSM_CLASS_Bearer);   // Bring up the wireless connection
+
+		GSM_Command_P(USART, PSTR("AT+CIFSR\r\n"), PSTR("."), GSM_CLASS_Local);   // Local IP, answered without OK
+
+		if (ret == E_OK)
+		{
+			sprintf_P(PortString, PSTR("\",\"%u\"\r\n"), port);
+			USART_Transmit_String_P(USART, PSTR("AT+CIPSTART=\"TCP\",\""));
+			USART_Transmit_String(USART, host);
+			USART_Transmit_String(USART, (const uint8*)PortString);
+			ret = GSM_WaitFor(USART, PSTR("CONNECT OK"), TRUE, GSM_GetTimeout(GSM_CLASS_Bearer), GSM_CLASS_Bearer | GSM_CLASS_DEFERRED, NULL);
+		}
+
+		if (ret == E_OK)
+		{
+			TCP_State = GSM_TCP_Connected;
+		}
+	}
+
+	return ret;
+}
+
+Std_ReturnType GSM_TCP_Send(const USART_Config_t *USART, const uint8 *data, uint16 length)
+{
+	Std_ReturnType ret = E_OK;
+	char Command[24];
+	uint16 Index = 0;
+	uint32 Progress = 0;
+
+	if (NULL == USART || NULL == data || 0 == length || TCP_State != GSM_TCP_Connected)
+	{
+		ret = E_NOT_OK;
+	}
+	else if (GSM_SendAllowed(length) == FALSE)
+	{
+		LOG_WARN(LOG_GSM, "Send deferred, supply low");              // The socket stays open
+		ret = E_NOT_OK;
+	}
+	else
+	{
+		GSM_WasPreempted = FALSE;
+		sprintf_P(Command, PSTR("AT+CIPSEND=%u\r\n"), length);
+		USART_Transmit_String(USART, (const uint8*)Command);
+		ret = GSM_WaitForPrompt(USART, 5000);
+
+		if (ret == E_OK && NULL != GSM_PreemptCheck && GSM_PreemptCheck() == TRUE)
+		{
+			Progress = Timer_GetMillis();
+			GSM_WasPreempted = TRUE;                                       // Nothing was sent, the socket stays open
+			while (USART_Transmit_Byte(USART, GSM_ESC) != E_OK)
+			{
+				if ((uint32)(Timer_GetMillis() - Progress) >= GSM_TX_STALL_MS)
+				{
+					LOG_ERROR(LOG_GSM, "ESC not sent, TX ring not draining");   // A plain failure, the modem still waits for the payload
+					GSM_WasPreempted = FALSE;
+					break;
+				}
+				Watchdog_Kick();
+			}
+			ret = E_NOT_OK;
+		}
+		else if (ret == E_OK)
+		{
+			/* Binary payload may hold zeros, push it byte by byte and spin while the TX ring is full */
+			Progress = Timer_GetMillis();
+			while (Index < length && ret == E_OK)
+			{
+				if (USART_Transmit_Byte(USART, data[Index]) == E_OK)
+				{
+					Index++;
+					Progress = Timer_GetMillis();
+				}
+				else if ((uint32)(Timer_GetMillis() - Progress) >= GSM_TX_STALL_MS)
+				{
+					LOG_ERROR(LOG_GSM, "Send stalled, TX ring not draining");   // Modem holds CTS, recovery takes over
+					ret = E_NOT_OK;
+				}
+				else
+				{
+					Watchdog_Kick();
+				}
+			}
+
+			if (ret == E_OK)
+			{
+				ret = GSM_WaitForInterruptible_P(USART, PSTR("SEND OK"), GSM_CLASS_Data);   // Preempted here the payload is out, unconfirmed
+			}
+		}
+	}
+
+	return ret;
+}
+
+Std_ReturnType GSM_TCP_Receive(const USART_Config_t *USART, uint8 *data, uint16 size, uint16 *length)
+{
+	Std_ReturnType ret = E_OK;
+
+	if (NULL == USART || NULL == data || NULL == length)
+	{
+		return E_NOT_OK;
+	}
+
+	/* Pump the stream, payload lands in TCP_RxBuffer and the status lines are checked for CLOSED */
+	while (GSM_ReadLine(USART) == E_OK);
+
+	*length = 0;
+	while (*length < size && TCP_RxTail != TCP_RxHead)
+	{
+		data[(*length)++] = TCP_RxBuffer[TCP_RxTail];
+		TCP_RxTail = (TCP_RxTail + 1) & (GSM_TCP_RX_BUFFER_SIZE - 1);
+	}
+
+	if (TCP_State != GSM_TCP_Connected)
+	{
+		ret = E_NOT_OK;
+	}
+
+	return ret;
+}
+
+Std_ReturnType GSM_TCP_GetState(GSM_TCPState_t *State)
+{
+	Std_ReturnType ret = E_OK;
+
+	if (NULL == State)
+	{
+		ret = E_NOT_OK;
+	}
+	else
+	{
+		*State = TCP_State;
+	}
+
+	return ret;
+}
+
+Std_ReturnType GSM_TCP_Close(const USART_Config_t *USART)
+{
+	Std_ReturnType ret = E_OK;
+
+	if (NULL == USART)
+	{
+		ret = E_NOT_OK;
+	}
+	else
+	{
+		GSM_Command_P(USART, PSTR("AT+CIPCLOSE\r\n"), PSTR("CLOSE"), GSM_CLASS_Data);   // Close the socket
+
+		ret = GSM_Command_P(USART, PSTR("AT+CIPSHUT\r\n"), PSTR("SHUT OK"), GSM_CLASS_Bearer);   // Deactivate the PDP context
+
+		TCP_State = GSM_TCP_Closed;
+	}
+
+	return ret;
+}
+
+
+Std_ReturnType GSM_SetSendGate(GSM_SendGate_t Gate)
+{
+	TCP_SendGate = Gate;
+
+	return E_OK;
+}
+
+boolean GSM_SendAllowed(uint16 Length)
+{
+	return (NULL == TCP_SendGate) ? TRUE : TCP_SendGate(Length);
+}
+
+/**
+* @brief Installs the check that lets urgent work cut in on long operations.
+* @note  Asked during the +HTTPACTION and SEND OK waits and at the AT+CIPSEND prompt, TRUE ends the
+*        operation early with E_NOT_OK and GSM_Preempted(). NULL removes it.
+*/
+Std_ReturnType GSM_SetPreempt(GSM_Preempt_t Preempt)
+{
+	GSM_PreemptCheck = Preempt;
+
+	return E_OK;
+}
+
+/* TRUE once after an operation gave way to urgent work, the flag is cleared by the read */
+boolean GSM_Preempted(void)
+{
+	boolean Preempted = GSM_WasPreempted;
+
+	GSM_WasPreempted = FALSE;
+	return Preempted;
+}
+
+/* TRUE while a GSM wait runs, also inside URC handlers called from it; no new command may start then */
+boolean GSM_Busy(void)
+{
+	return (GSM_WaitDepth > 0) ? TRUE : FALSE;
+}
+
+Std_ReturnType GSM_RegisterURC(const char *prefix, GSM_URCHandler_t handler)
+{
+	Std_ReturnType ret = E_NOT_OK;
+
+	if (NULL != prefix && NULL != handler)
+	{
+		for (uint8 Index = 0; Index < GSM_MAX_URC_HANDLERS; Index++)
+		{
+			if (NULL == URC_Prefix[Index] || URC_Prefix[Index] == prefix)
+			{
+				URC_Prefix[Index] = prefix;
+				URC_Handler[Index] = handler;
+				ret = E_OK;
+				break;
+			}
+		}
+	}
+
+	return ret;  // E_NOT_OK when the table is full
+}
+
+Std_ReturnType GSM_DispatchURC(const uint8 *line)
+{
+	Std_ReturnType ret = E_NOT_OK;
+
+	if (NULL != line)
+	{
+		GSM_Timeouts = 0;                              // Every modem line passes here, the modem is alive
+		GSM_HeardTime = Timer_GetMillis();
+
+		for (uint8 Index = 0; Index < GSM_MAX_URC_HANDLERS && NULL != URC_Prefix[Index]; Index++)
+		{
+			if (strncmp_P((const char*)line, URC_Prefix[Index], strlen_P(URC_Prefix[Index])) == 0)
+			{
+				TRACE(TRACE_URC, Index);
+				URC_Handler[Index](line);
+				ret = E_OK;
+				break;
+			}
+		}
+	}
+
+	return ret;  // E_NOT_OK when nobody claimed the line
+}
+
+/* Waits that timed out without any line from the modem since the last line, saturates at 255 */
+uint8 GSM_GetTimeouts(void)
+{
+	return GSM_Timeouts;
+}
+
+/* Timer_GetMillis() of the last modem line, answers and URCs alike */
+uint32 GSM_LastHeard(void)
+{
+	return GSM_HeardTime;
+}
+
+/**
+* @brief Timeout of the next wait of a class: SRTT + 4 * RTTVAR within the class bounds, doubled per late answer.
+*/
+uint32 GSM_GetTimeout(GSM_CmdClass_t Class)
+{
+	uint32 Timeout = 0;
+	uint32 Ceiling = 0;
+
+	if (Class >= GSM_CLASS_COUNT)
+	{
+		return pgm_read_word(&GSM_ClassTable[GSM_CLASS_Local].Initial);
+	}
+	if (GSM_RTOLoaded == FALSE)
+	{
+		GSM_LoadTimeouts();
+	}
+
+	Ceiling = pgm_read_dword(&GSM_ClassTable[Class].Ceiling);
+	Timeout = (GSM_RTO[Class].Smoothed8 == 0) ? pgm_read_word(&GSM_ClassTable[Class].Initial)
+	                                          : (GSM_RTO[Class].Smoothed8 >> 3) + GSM_RTO[Class].Deviation4;
+	if (Timeout < pgm_read_word(&GSM_ClassTable[Class].Floor))
+	{
+		Timeout = pgm_read_word(&GSM_ClassTable[Class].Floor);
+	}
+	Timeout <<= GSM_RTO[Class].Backoff;
+
+	return (Timeout > Ceiling) ? Ceiling : Timeout;
+}
+
+Std_ReturnType GSM_GetLatency(GSM_CmdClass_t Class, GSM_Latency_t *Latency)
+{
+	Std_ReturnType ret = E_OK;
+
+	if (NULL == Latency || Class >= GSM_CLASS_COUNT)
+	{
+		ret = E_NOT_OK;
+	}
+	else
+	{
+		Latency->TimeoutMs = GSM_GetTimeout(Class);
+		Latency->SmoothedMs = (uint16)(GSM_RTO[Class].Smoothed8 >> 3);
+		Latency->DeviationMs = (uint16)(GSM_RTO[Class].Deviation4 >> 2);
+		Latency->Backoff = GSM_RTO[Class].Backoff;
+	}
+
+	return ret;
+}
\ No newline at end of file
@@ -0,0 +1,204 @@
+
+/********************************************************************************************************
+ *  [FILE NAME]   :      <Geofence.c>                                                                   *
+ *  [AUTHOR]      :      <David S. Alexander>                                                           *
+ *  [DATE CREATED]:      <Oct 18, 2026>                                                                 *
+ *  [Description] :      <Source file for the fixed-point geofence evaluator>                           *
+ ********************************************************************************************************/
+
+#include "../Inc/Geofence.h"
+
+#define GEOFENCE_UDEG_PER_M_Q3    72           /* 8.983 1e-6 degree per meter in Q3 */
+#define GEOFENCE_POLYGON_SHIFT    5            /* Keeps polygon cross products inside 32 bits */
+
+typedef struct
+{
+	sint32 MinLatitude;
+	sint32 MaxLatitude;
+	sint32 MinLongitude;
+	sint32 MaxLongitude;
+
+} Geofence_Box_t;
+
+static const Geofence_t   *Geofence_Table;
+static uint8               Geofence_Count;
+static Geofence_Callback_t Geofence_Callback;
+static uint8               Geofence_LastSequence;
+static boolean             Geofence_Started = FALSE;
+
+static Geofence_Box_t      Geofence_Boxes[GEOFENCE_MAX_FENCES];
+static uint8               Geofence_Inside[(GEOFENCE_MAX_FENCES + 7) / 8];
+
+static boolean Geofence_InCircle(const Geofence_t *Fence, sint32 Latitude, sint32 Longitude, uint16 Cos)
+{
+	sint32 dy = GNSS_UDEG_TO_METERS(Latitude - Fence->Center.Latitude);
+	sint32 dx = (GNSS_UDEG_TO_METERS(Longitude - Fence->Center.Longitude) * (sint32)Cos) >> 15;
+
+	return (((uint32)(dx * dx) + (uint32)(dy * dy)) <= (Fence->Radius * Fence->Radius)) ? TRUE : FALSE;
+}
+
+static boolean Geofence_InPolygon(const Geofence_t *Fence, sint32 Latitude, sint32 Longitude)
+{
+	Geofence_Point_t Vertex;
+	sint32  xi = 0, yi = 0, xj = 0, yj = 0;
+	boolean Inside = FALSE;
+
+	/* Ray casting with the fix at the origin, the last vertex closes the ring */
+	memcpy_P(&Vertex, &Fence->Vertices[Fence->VertexCount - 1], sizeof(Vertex));
+	xj = (Vertex.Longitude - Longitude) >> GEOFENCE_POLYGON_SHIFT;
+	yj = (Vertex.Latitude - Latitude) >> GEOFENCE_POLYGON_SHIFT;
+
+	for (uint8 Index = 0; Index < Fence->VertexCount; Index++)
+	{
+		memcpy_P(&Vertex, &Fence->Vertices[Index], sizeof(Vertex));
+		xi = (Vertex.Longitude - Longitude) >> GEOFENCE_POLYGON_SHIFT;
+		yi = (Vertex.Latitude - Latitude) >> GEOFENCE_POLYGON_SHIFT;
+
+		if ((yi > 0) != (yj > 0))
+		{
+			/* The edge crosses the ray, check the crossing lies on the positive x side */
+			sint32 Cross = (xi * yj) - (xj * yi);
+			if ((Cross > 0) == (yj > yi))
+			{
+				Inside = !Inside;
+			}
+		}
+		xj = xi;
+		yj = yi;
+	}
+
+	return Inside;
+}
+
+Std_ReturnType Geofence_Init(const Geofence_t *Fences, uint8 Count, Geofence_Callback_t Callback)
+{
+	Geofence_t       Fence;
+	Geofence_Point_t Vertex;
+	Geofence_Box_t  *Box = NULL;
+	sint32           Span = 0;
+
+	if (NULL == Fences || Count > GEOFENCE_MAX_FENCES)
+	{
+		return E_NOT_OK;
+	}
+
+	Geofence_Table = Fences;
+	Geofence_Count = Count;
+	Geofence_Callback = Callback;
+	Geofence_Started = FALSE;
+	memset(Geofence_Inside, 0, sizeof(Geofence_Inside));
+
+	/* Precompute the bounding boxes once so each fix only pays four compares per fence */
+	for (uint8 Index = 0; Index < Count; Index++)
+	{
+		memcpy_P(&Fence, &Fences[Index], sizeof(Fence));
+		Box = &Geofence_Boxes[Index];
+
+		if (Fence.Type == GEOFENCE_Circle)
+		{
+			if (Fence.Radius > GEOFENCE_MAX_RADIUS)
+			{
+				return E_NOT_OK;
+			}
+			Span = (Fence.Radius * GEOFENCE_UDEG_PER_M_Q3) >> 3;
+			Box->MinLatitude  = Fence.Center.Latitude - Span;
+			Box->MaxLatitude  = Fence.Center.Latitude + Span;
+			Span = (sint32)(((uint32)Span << 8) / (GNSS_CosLatitude(Fence.Center.Latitude) >> 7));   // Rounds outwards
+			Box->MinLongitude = Fence.Center.Longitude - Span;
+			Box->MaxLongitude = Fence.Center.Longitude + Span;
+		}
+		else
+		{
+			if (Fence.VertexCount < 3 || NULL == Fence.Vertices)
+			{
+				return E_NOT_OK;
+			}
+			memcpy_P(&Vertex, &Fence.Vertices[0], sizeof(Vertex));
+			Box->MinLatitude  = Box->MaxLatitude  = Vertex.Latitude;
+			Box->MinLongitude = Box->MaxLongitude = Vertex.Longitude;
+			for (uint8 Point = 1; Point < Fence.VertexCount; Point++)
+			{
+				memcpy_P(&Vertex, &Fence.Vertices[Point], sizeof(Vertex));
+				if (Vertex.Latitude  < Box->MinLatitude)  Box->MinLatitude  = Vertex.Latitude;
+				if (Vertex.Latitude  > Box->MaxLatitude)  Box->MaxLatitude  = Vertex.Latitude;
+				if (Vertex.Longitude < Box->MinLongitude) Box->MinLongitude = Vertex.Longitude;
+				if (Vertex.Longitude > Box->MaxLongitude) Box->MaxLongitude = Vertex.Longitude;
+			}
+			if ((Box->MaxLatitude - Box->MinLatitude) > GEOFENCE_MAX_SPAN || (Box->MaxLongitude - Box->MinLongitude) > GEOFENCE_MAX_SPAN)
+			{
+				return E_NOT_OK;
+			}
+		}
+	}
+
+	return E_OK;
+}
+
+Std_ReturnType Geofence_Evaluate(const GNSS_Fix_t *Fix)
+{
+	Geofence_t      Fence;
+	Geofence_Box_t *Box = NULL;
+	boolean         Inside = FALSE;
+	boolean         WasInside = FALSE;
+	uint16          Cos = 0;
+	uint8           Mask = 0;
+
+	if (NULL == Fix || NULL == Geofence_Table || Fix->GNSS_Status != GNSS_FixValid)
+	{
+		return E_NOT_OK;
+	}
+
+	if (Geofence_Started == TRUE && Fix->GNSS_Sequence == Geofence_LastSequence)
+	{
+		return E_OK;                                                   // Already evaluated this fix
+	}
+
+	Cos = GNSS_CosLatitude(Fix->GNSS_Latitude);
+
+	for (uint8 Index = 0; Index < Geofence_Count; Index++)
+	{
+		Box = &Geofence_Boxes[Index];
+		Inside = FALSE;
+
+		if (Fix->GNSS_Latitude  >= Box->MinLatitude  && Fix->GNSS_Latitude  <= Box->MaxLatitude &&
+		    Fix->GNSS_Longitude >= Box->MinLongitude && Fix->GNSS_Longitude <= Box->MaxLongitude)
+		{
+			memcpy_P(&Fence, &Geofence_Table[Index], sizeof(Fence));
+			Inside = (Fence.Type == GEOFENCE_Circle) ? Geofence_InCircle(&Fence, Fix->GNSS_Latitude, Fix->GNSS_Longitude, Cos)
+			                                         : Geofence_InPolygon(&Fence, Fix->GNSS_Latitude, Fix->GNSS_Longitude);
+		}
+
+		/* Only transitions are reported, the first fix just seeds the state */
+		Mask = BIT_MASK << (Index & 0x07);
+		WasInside = (Geofence_Inside[Index >> 3] & Mask) ? TRUE : FALSE;
+		if (Inside != WasInside)
+		{
+			Geofence_Inside[Index >> 3] ^= Mask;
+			if (Geofence_Started == TRUE && NULL != Geofence_Callback)
+			{
+				Geofence_Callback(Index, (Inside == TRUE) ? GEOFENCE_Enter : GEOFENCE_Exit);
+			}
+		}
+	}
+
+	Geofence_LastSequence = Fix->GNSS_Sequence;
+	Geofence_Started = TRUE;
+
+	return E_OK;
+}
+
+Std_ReturnType Geofence_IsInside(uint8 FenceIndex, boolean *Inside)
+{
+	Std_ReturnType ret = E_OK;
+
+	if (NULL == Inside || FenceIndex >= Geofence_Count)
+	{
+		ret = E_NOT_OK;
+	}
+	else
+	{
+		*Inside = (Geofence_Inside[FenceIndex >> 3] & (BIT_MASK << (FenceIndex & 0x07))) ? TRUE : FALSE;
+	}
+
+	return ret;
+}
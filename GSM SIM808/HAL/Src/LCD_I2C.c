@@ -169,6 +169,59 @@ Std_ReturnType LCD_I2C_WriteStringInPos(const LCD_I2C_t *LCD, uint8 Row, uint8 C
     return ret;
 }
 
+/**
+ *
+ * @param LCD
+ * @param Str String stored in flash (PSTR or PROGMEM)
+ * @return Status of the function
+ *          (E_OK) : The function done successfully
+ *          (E_NOT_OK) : The function has issue to perform this action
+ */
+Std_ReturnType LCD_I2C_WriteString_P(const LCD_I2C_t *LCD, const char *Str)
+{
+    Std_ReturnType ret = E_OK;
+    uint8 Character = ZERO_INIT;
+    if(NULL == LCD || NULL == Str)
+    {
+        ret = E_NOT_OK;
+    }
+    else
+    {
+        Character = pgm_read_byte(Str);
+        while(Character)
+        {
+            ret = LCD_I2C_WriteChar(LCD, Character);
+            Character = pgm_read_byte(++Str);
+        }
+    }
+    return ret;
+}
+
+/**
+ *
+ * @param LCD
+ * @param Row
+ * @param Column
+ * @param Str String stored in flash (PSTR or PROGMEM)
+ * @return Status of the function
+ *          (E_OK) : The function done successfully
+ *          (E_NOT_OK) : The function has issue to perform this action
+ */
+Std_ReturnType LCD_I2C_WriteStringInPos_P(const LCD_I2C_t *LCD, uint8 Row, uint8 Column, const char *Str)
+{
+    Std_ReturnType ret = E_OK;
+    if(NULL == LCD || NULL == Str)
+    {
+        ret = E_NOT_OK;
+    }
+    else
+    {
+        ret = LCD_I2C_SetCursor(LCD, Row, Column);
+        ret = LCD_I2C_WriteString_P(LCD, Str);
+    }
+    return ret;
+}
+
 /**
  *
  * @param LCD
@@ -0,0 +1,173 @@
+
+/********************************************************************************************************
+ *  [FILE NAME]   :      <Log.c>                                                                        *
+ *  [AUTHOR]      :      <David S. Alexander>                                                           *
+ *  [DATE CREATED]:      <Oct 18, 2026>                                                                 *
+ *  [Description] :      <Source file for the deferred leveled debug log>                               *
+ ********************************************************************************************************/
+
+#include "../Inc/Log.h"
+
+/*
+ * Line on the debug UART: "<level> <module>: <text><line>\n", e.g. "W GSM: < +CME ERROR: 10".
+ * Writers only copy into the ring, Log_Process() hands it to the UART once its TX ring is empty,
+ * so modem traffic and trace frames always go first. Not for use from ISRs.
+ */
+
+static const char Log_LevelTags[] PROGMEM = "-EWID";
+
+static const char Log_NameGSM[]   PROGMEM = "GSM";
+static const char Log_NameGNSS[]  PROGMEM = "GNSS";
+static const char Log_NameMQTT[]  PROGMEM = "MQTT";
+static const char Log_NameTrack[] PROGMEM = "TRACK";
+static const char Log_NameApp[]   PROGMEM = "APP";
+static const char Log_NamePower[] PROGMEM = "PWR";
+
+static PGM_P const Log_Names[] PROGMEM =
+{
+	Log_NameGSM, Log_NameGNSS, Log_NameMQTT, Log_NameTrack, Log_NameApp, Log_NamePower
+};
+
+#define LOG_NAME_COUNT            (sizeof(Log_Names) / sizeof(Log_Names[0]))
+
+static const USART_Config_t *Log_USART = NULL;
+static uint8  Log_Buffer[LOG_BUFFER_SIZE];
+static uint8  Log_Head;
+static uint8  Log_Tail;
+static uint8  Log_Mask = LOG_MODULES;
+static uint16 Log_Dropped;
+static uint16 Log_Reported;
+
+static void Log_Put(uint8 Byte)
+{
+	Log_Buffer[Log_Head] = (Byte < 0x80) ? Byte : '.';             /* Keeps 0xA5 free for the trace frames */
+	Log_Head = (uint8)(Log_Head + 1) % LOG_BUFFER_SIZE;
+}
+
+static void Log_Put_P(const char *Str)
+{
+	uint8 Byte = 0;
+
+	while ((Byte = pgm_read_byte(Str++)) != '\0')
+	{
+		Log_Put(Byte);
+	}
+}
+
+Std_ReturnType Log_Init(const USART_Config_t *USART)
+{
+	Std_ReturnType ret = E_OK;
+
+	if (NULL == USART)
+	{
+		ret = E_NOT_OK;
+	}
+	else
+	{
+		Log_USART = USART;
+		Log_Head = 0;
+		Log_Tail = 0;
+		Log_Dropped = 0;
+		Log_Reported = 0;
+	}
+
+	return ret;
+}
+
+void Log_SetMask(uint8 Mask)
+{
+	Log_Mask = Mask & LOG_MODULES;
+}
+
+/**
+* @brief Queues one line, never touches the UART.
+* @note  A line that does not fit is dropped whole and counted.
+*/
+Std_ReturnType Log_Write(uint8 Level, uint8 Module, const char *Text, const uint8 *Line)
+{
+	PGM_P  Name = NULL;
+	uint8  Index = 0;
+	uint8  LineLength = 0;
+	uint16 Length = 0;
+
+	if (NULL == Text || 0 == (Module & Log_Mask) || Level > LOG_LEVEL_DEBUG)
+	{
+		return E_NOT_OK;
+	}
+
+	while (Index < (LOG_NAME_COUNT - 1) && 0 == (Module & (BIT_MASK << Index)))
+	{
+		Index++;
+	}
+	Name = (PGM_P)pgm_read_word(&Log_Names[Index]);
+
+	if (NULL != Line)
+	{
+		while (LineLength < LOG_LINE_MAX && Line[LineLength] != '\0' && Line[LineLength] != '\r' && Line[LineLength] != '\n')
+		{
+			LineLength++;
+		}
+	}
+
+	Length = 2 + strlen_P(Name) + 2 + strlen_P(Text) + LineLength + 1;
+	if (Length > ((uint8)(Log_Tail - Log_Head - 1) % LOG_BUFFER_SIZE))
+	{
+		if (Log_Dropped < 0xFFFF) Log_Dropped++;
+		return E_NOT_OK;
+	}
+
+	Log_Put(pgm_read_byte(&Log_LevelTags[Level]));
+	Log_Put(' ');
+	Log_Put_P(Name);
+	Log_Put(':');
+	Log_Put(' ');
+	Log_Put_P(Text);
+	for (Index = 0; Index < LineLength; Index++)
+	{
+		Log_Put(Line[Index]);
+	}
+	Log_Put('\n');
+
+	return E_OK;
+}
+
+/**
+* @brief Moves up to LOG_DRAIN_MAX bytes to the debug UART, only while its TX ring is empty.
+*/
+Std_ReturnType Log_Process(void)
+{
+	char  Marker[24];
+	uint8 Count = 0;
+
+	if (NULL == Log_USART)
+	{
+		return E_NOT_OK;
+	}
+
+	/* Polled channels report 0xFF, they are idle whenever the caller is */
+	if (USART_TransmitSpace(Log_USART) < (USART_TX_BUFFER_SIZE - 1))
+	{
+		return E_OK;
+	}
+
+	if (Log_Tail == Log_Head && Log_Reported != Log_Dropped)
+	{
+		sprintf_P(Marker, PSTR("! %u log lines dropped\n"), (uint16)(Log_Dropped - Log_Reported));
+		Log_Reported = Log_Dropped;
+		USART_Transmit_String(Log_USART, (const uint8*)Marker);
+	}
+
+	while (Log_Tail != Log_Head && Count < LOG_DRAIN_MAX)
+	{
+		USART_Transmit_Byte(Log_USART, Log_Buffer[Log_Tail]);
+		Log_Tail = (uint8)(Log_Tail + 1) % LOG_BUFFER_SIZE;
+		Count++;
+	}
+
+	return E_OK;
+}
+
+uint16 Log_GetDropped(void)
+{
+	return Log_Dropped;
+}
@@ -0,0 +1,618 @@
+
+/********************************************************************************************************
+ *  [FILE NAME]   :      <MQTT.c>                                                                       *
+ *  [AUTHOR]      :      <David S. Alexander>                                                           *
+ *  [DATE CREATED]:      <Oct 18, 2026>                                                                 *
+ *  [Description] :      <Source file for the MQTT 3.1.1 client over the SIM808 TCP path>               *
+ ********************************************************************************************************/
+
+#include "../Inc/MQTT.h"
+
+#define MQTT_RX_HEADER   0
+#define MQTT_RX_LENGTH   1
+#define MQTT_RX_BODY     2
+
+typedef struct
+{
+	uint16 PacketID;                           /* 0 marks a free slot */
+	uint16 Length;
+	uint16 Age;                                /* ms since the last transmission, saturates at MQTT_RETRY_TIMEOUT */
+	boolean Queued;                            /* A copy still waits in TX_Batch */
+	uint8  Packet[MQTT_INFLIGHT_SIZE];
+
+} MQTT_Inflight_t;
+
+static const MQTT_Config_t *MQTT_Config;
+static MQTT_State_t MQTT_CurrentState = MQTT_Disconnected;
+static uint16 MQTT_PacketID;
+
+static uint8  TX_Batch[MQTT_TX_BUFFER_SIZE];
+static uint16 TX_Length;
+static uint16 TX_BatchAge;                     /* ms since the first packet of the batch was queued */
+static uint32 TX_IdleTime;                     /* ms since the last CIPSEND, drives PINGREQ */
+
+static uint8  RX_Packet[MQTT_RX_BUFFER_SIZE];
+static uint8  RX_Header;
+static uint8  RX_Stage = MQTT_RX_HEADER;
+static uint8  RX_Shift;
+static uint32 RX_Remaining;
+static uint32 RX_Index;
+
+static boolean PING_Outstanding;
+static uint32  PING_WaitTime;
+
+static MQTT_Inflight_t Inflight[MQTT_MAX_INFLIGHT];
+
+static uint16 PUBACK_Pending[MQTT_MAX_PUBACKS];        /* Inbound QoS1 packet IDs to acknowledge, 0 marks a free slot */
+
+static uint8 MQTT_LengthSize(uint16 Length)
+{
+	return (Length < 128) ? 1 : 2;             /* Packets never exceed MQTT_TX_BUFFER_SIZE */
+}
+
+static void MQTT_PutByte(uint8 Data)
+{
+	TX_Batch[TX_Length++] = Data;
+}
+
+static void MQTT_PutWord(uint16 Data)
+{
+	TX_Batch[TX_Length++] = (uint8)(Data >> 8);
+	TX_Batch[TX_Length++] = (uint8)(Data & 0xFF);
+}
+
+static void MQTT_PutLength(uint16 Length)
+{
+	do
+	{
+		uint8 Digit = Length % 128;
+		Length /= 128;
+		if (Length > 0)
+		{
+			Digit |= 0x80;
+		}
+		TX_Batch[TX_Length++] = Digit;
+	}
+	while (Length > 0);
+}
+
+static void MQTT_PutString(const uint8 *Str, uint16 Length)
+{
+	MQTT_PutWord(Length);
+	memcpy(&TX_Batch[TX_Length], Str, Length);
+	TX_Length += Length;
+}
+
+static uint16 MQTT_NextPacketID(void)
+{
+	if (++MQTT_PacketID == 0)
+	{
+		MQTT_PacketID = 1;                     /* Packet identifier 0 is not allowed */
+	}
+	return MQTT_PacketID;
+}
+
+/* Make room for Size bytes in the batch, sending the current batch first if it would overflow.
+ * A failed send keeps the batch and refuses the new packet. */
+static Std_ReturnType MQTT_Reserve(const USART_Config_t *USART, uint16 Size)
+{
+	Std_ReturnType ret = E_OK;
+
+	if (Size > MQTT_TX_BUFFER_SIZE)
+	{
+		ret = E_NOT_OK;
+	}
+	else if ((TX_Length + Size) > MQTT_TX_BUFFER_SIZE)
+	{
+		ret = MQTT_Flush(USART);
+	}
+
+	if (ret == E_OK && TX_Length == 0)
+	{
+		TX_BatchAge = 0;
+	}
+
+	return ret;
+}
+
+static void MQTT_HandlePacket(const USART_Config_t *USART)
+{
+	uint16 PacketID = 0;
+	uint16 TopicLength = 0;
+	uint16 Offset = 0;
+
+	switch (RX_Header & 0xF0)
+	{
+		case MQTT_PACKET_CONNACK:
+		MQTT_CurrentState = (RX_Remaining >= 2 && RX_Packet[1] == 0) ? MQTT_Connected : MQTT_Disconnected;
+		break;
+
+		case MQTT_PACKET_PUBACK:
+		PacketID = ((uint16)RX_Packet[0] << 8) | RX_Packet[1];
+		for (uint8 Slot = 0; Slot < MQTT_MAX_INFLIGHT; Slot++)
+		{
+			if (Inflight[Slot].PacketID == PacketID)
+			{
+				Inflight[Slot].PacketID = 0;
+			}
+		}
+		break;
+
+		case MQTT_PACKET_PINGRESP:
+		PING_Outstanding = FALSE;
+		break;
+
+		case MQTT_PACKET_PUBLISH:
+		TopicLength = ((uint16)RX_Packet[0] << 8) | RX_Packet[1];
+		Offset = 2 + TopicLength;
+		if ((RX_Header & (MQTT_FLAG_QOS1 | (MQTT_FLAG_QOS1 << 1))) && (Offset + 2) <= RX_Remaining)
+		{
+			/* Acknowledge QoS1 and above. Queued only, a send from here would run inside GSM_TCP_Receive() */
+			PacketID = ((uint16)RX_Packet[Offset] << 8) | RX_Packet[Offset + 1];
+			Offset += 2;
+			for (uint8 Slot = 0; Slot < MQTT_MAX_PUBACKS; Slot++)
+			{
+				if (PUBACK_Pending[Slot] == 0)
+				{
+					PUBACK_Pending[Slot] = PacketID;       /* A full list leaves it to the broker's resend */
+					break;
+				}
+			}
+		}
+		if (Offset <= RX_Remaining && MQTT_Config != NULL && MQTT_Config->MQTT_Callback != NULL)
+		{
+			MQTT_Config->MQTT_Callback(&RX_Packet[2], TopicLength, &RX_Packet[Offset], (uint16)(RX_Remaining - Offset));
+		}
+		break;
+
+		default:                               /* SUBACK and anything unexpected */
+		break;
+	}
+}
+
+static void MQTT_ReceiveByte(const USART_Config_t *USART, uint8 Data)
+{
+	switch (RX_Stage)
+	{
+		case MQTT_RX_HEADER:
+		RX_Header = Data;
+		RX_Remaining = 0;
+		RX_Shift = 0;
+		RX_Index = 0;
+		RX_Stage = MQTT_RX_LENGTH;
+		break;
+
+		case MQTT_RX_LENGTH:
+		RX_Remaining |= (uint32)(Data & 0x7F) << RX_Shift;
+		RX_Shift += 7;
+		if (!(Data & 0x80))
+		{
+			if (RX_Remaining == 0)
+			{
+				MQTT_HandlePacket(USART);
+				RX_Stage = MQTT_RX_HEADER;
+			}
+			else
+			{
+				RX_Stage = MQTT_RX_BODY;
+			}
+		}
+		else if (RX_Shift > 21)                /* Malformed remaining length */
+		{
+			RX_Stage = MQTT_RX_HEADER;
+		}
+		break;
+
+		default:
+		if (RX_Index < MQTT_RX_BUFFER_SIZE)
+		{
+			RX_Packet[RX_Index] = Data;
+		}
+		if (++RX_Index == RX_Remaining)
+		{
+			/* Packets larger than the RX buffer are consumed but dropped */
+			if (RX_Remaining <= MQTT_RX_BUFFER_SIZE)
+			{
+				MQTT_HandlePacket(USART);
+			}
+			RX_Stage = MQTT_RX_HEADER;
+		}
+		break;
+	}
+}
+
+Std_ReturnType MQTT_Connect(const USART_Config_t *USART, const MQTT_Config_t *MQTTcfg, const uint8 *host, uint16 port)
+{
+	Std_ReturnType ret = E_OK;
+	uint16 Remaining = 0;
+	uint8  Flags = 0;
+	uint32 Start = 0;
+	uint32 Last = 0;
+	uint32 Now = 0;
+
+	if (NULL == USART || NULL == MQTTcfg || NULL == MQTTcfg->MQTT_ClientID || NULL == host)
+	{
+		return E_NOT_OK;
+	}
+
+	MQTT_Config = MQTTcfg;
+	MQTT_CurrentState = MQTT_Disconnected;
+	TX_Length = 0;
+	TX_IdleTime = 0;
+	RX_Stage = MQTT_RX_HEADER;
+	PING_Outstanding = FALSE;
+	memset(Inflight, 0, sizeof(Inflight));
+	memset(PUBACK_Pending, 0, sizeof(PUBACK_Pending));
+
+	ret = GSM_TCP_Open(USART, host, port);
+
+	if (ret == E_OK)
+	{
+		/* Protocol name (6) + level (1) + flags (1) + keepalive (2) + client identifier */
+		Remaining = 10 + 2 + strlen((const char*)MQTTcfg->MQTT_ClientID);
+		Flags = (MQTTcfg->MQTT_CleanSession == TRUE) ? MQTT_FLAG_CLEAN_SESSION : 0;
+		if (MQTTcfg->MQTT_Username != NULL)
+		{
+			Remaining += 2 + strlen((const char*)MQTTcfg->MQTT_Username);
+			Flags |= MQTT_FLAG_USERNAME;
+		}
+		if (MQTTcfg->MQTT_Password != NULL)
+		{
+			Remaining += 2 + strlen((const char*)MQTTcfg->MQTT_Password);
+			Flags |= MQTT_FLAG_PASSWORD;
+		}
+		ret = MQTT_Reserve(USART, 1 + MQTT_LengthSize(Remaining) + Remaining);
+	}
+
+	if (ret == E_OK)
+	{
+		MQTT_PutByte(MQTT_PACKET_CONNECT);
+		MQTT_PutLength(Remaining);
+		MQTT_PutString((const uint8*)"MQTT", 4);
+		MQTT_PutByte(4);                                         /* Protocol level 3.1.1 */
+		MQTT_PutByte(Flags);
+		MQTT_PutWord(MQTTcfg->MQTT_KeepAlive);
+		MQTT_PutString(MQTTcfg->MQTT_ClientID, strlen((const char*)MQTTcfg->MQTT_ClientID));
+		if (Flags & MQTT_FLAG_USERNAME)
+		{
+			MQTT_PutString(MQTTcfg->MQTT_Username, strlen((const char*)MQTTcfg->MQTT_Username));
+		}
+		if (Flags & MQTT_FLAG_PASSWORD)
+		{
+			MQTT_PutString(MQTTcfg->MQTT_Password, strlen((const char*)MQTTcfg->MQTT_Password));
+		}
+
+		MQTT_CurrentState = MQTT_Connecting;
+		ret = MQTT_Flush(USART);
+	}
+
+	if (ret == E_OK)
+	{
+		Start = Timer_GetMillis();
+		Last = Start;
+		while ((uint32)(Timer_GetMillis() - Start) < MQTT_CONNACK_TIMEOUT && MQTT_CurrentState == MQTT_Connecting)
+		{
+			Now = Timer_GetMillis();
+			MQTT_Process(USART, (uint16)(Now - Last));
+			Last = Now;
+			Watchdog_Kick();                                     /* Bounded by MQTT_CONNACK_TIMEOUT */
+			Timer_DelayMs(1);
+		}
+		ret = (MQTT_CurrentState == MQTT_Connected) ? E_OK : E_NOT_OK;
+	}
+
+	if (ret != E_OK)
+	{
+		MQTT_CurrentState = MQTT_Disconnected;
+	}
+
+	return ret;
+}
+
+Std_ReturnType MQTT_Publish(const USART_Config_t *USART, const uint8 *topic, const uint8 *payload, uint16 length, MQTT_QoS_t QoS)
+{
+	uint16 TopicLength = 0;
+	uint32 Total = 0;
+	uint16 Remaining = 0;
+	uint16 Size = 0;
+	uint16 Start = 0;
+	uint8  Slot = 0;
+
+	if (NULL == USART || NULL == topic || (NULL == payload && length > 0) || MQTT_CurrentState != MQTT_Connected)
+	{
+		return E_NOT_OK;
+	}
+
+	/* Sum at 32 bits, a 16-bit remaining length would wrap and pass the batch size check */
+	TopicLength = strlen((const char*)topic);
+	Total = 2UL + TopicLength + length + ((QoS == MQTT_QoS1) ? 2 : 0);
+	if (length > MQTT_TX_BUFFER_SIZE || Total > MQTT_TX_BUFFER_SIZE)
+	{
+		return E_NOT_OK;                                         /* Can never fit in one batch */
+	}
+	Remaining = (uint16)Total;
+	Size = 1 + MQTT_LengthSize(Remaining) + Remaining;
+
+	if (QoS == MQTT_QoS1)
+	{
+		while (Slot < MQTT_MAX_INFLIGHT && Inflight[Slot].PacketID != 0)
+		{
+			Slot++;
+		}
+		if (Slot == MQTT_MAX_INFLIGHT || Size > MQTT_INFLIGHT_SIZE)
+		{
+			return E_NOT_OK;                                     /* No room to keep a copy for retransmission */
+		}
+	}
+
+	if (MQTT_Reserve(USART, Size) != E_OK)
+	{
+		return E_NOT_OK;
+	}
+
+	Start = TX_Length;
+	MQTT_PutByte(MQTT_PACKET_PUBLISH | ((QoS == MQTT_QoS1) ? MQTT_FLAG_QOS1 : 0));
+	MQTT_PutLength(Remaining);
+	MQTT_PutString(topic, TopicLength);
+	if (QoS == MQTT_QoS1)
+	{
+		Inflight[Slot].PacketID = MQTT_NextPacketID();
+		MQTT_PutWord(Inflight[Slot].PacketID);
+	}
+	memcpy(&TX_Batch[TX_Length], payload, length);
+	TX_Length += length;
+
+	if (QoS == MQTT_QoS1)
+	{
+		memcpy(Inflight[Slot].Packet, &TX_Batch[Start], Size);
+		Inflight[Slot].Length = Size;
+		Inflight[Slot].Age = 0;
+		Inflight[Slot].Queued = TRUE;
+	}
+
+	return E_OK;
+}
+
+Std_ReturnType MQTT_Subscribe(const USART_Config_t *USART, const uint8 *topic, MQTT_QoS_t QoS)
+{
+	Std_ReturnType ret = E_OK;
+	uint16 TopicLength = 0;
+	uint16 Remaining = 0;
+
+	if (NULL == USART || NULL == topic || MQTT_CurrentState != MQTT_Connected)
+	{
+		return E_NOT_OK;
+	}
+
+	TopicLength = strlen((const char*)topic);
+	if (TopicLength > MQTT_TX_BUFFER_SIZE)
+	{
+		return E_NOT_OK;                                         /* Keeps the remaining length below from wrapping */
+	}
+	Remaining = 2 + 2 + TopicLength + 1;
+	ret = MQTT_Reserve(USART, 1 + MQTT_LengthSize(Remaining) + Remaining);
+
+	if (ret == E_OK)
+	{
+		MQTT_PutByte(MQTT_PACKET_SUBSCRIBE);
+		MQTT_PutLength(Remaining);
+		MQTT_PutWord(MQTT_NextPacketID());
+		MQTT_PutString(topic, TopicLength);
+		MQTT_PutByte((uint8)QoS);
+		ret = MQTT_Flush(USART);                                 /* Subscriptions are not worth batching */
+	}
+
+	return ret;
+}
+
+Std_ReturnType MQTT_Flush(const USART_Config_t *USART)
+{
+	Std_ReturnType ret = E_OK;
+	GSM_TCPState_t TCPState = GSM_TCP_Closed;
+
+	if (NULL == USART)
+	{
+		ret = E_NOT_OK;
+	}
+	else if (TX_Length > 0 && GSM_SendAllowed(TX_Length) == FALSE)
+	{
+		ret = E_NOT_OK;                                          /* Batch kept until the supply recovers */
+	}
+	else if (TX_Length > 0)
+	{
+		/* Every queued packet leaves in a single CIPSEND */
+		ret = GSM_TCP_Send(USART, TX_Batch, TX_Length);
+
+		GSM_TCP_GetState(&TCPState);
+		if (ret == E_OK)
+		{
+			TX_Length = 0;
+			TX_IdleTime = 0;
+			for (uint8 Slot = 0; Slot < MQTT_MAX_INFLIGHT; Slot++)
+			{
+				if (Inflight[Slot].Queued == TRUE)
+				{
+					Inflight[Slot].Queued = FALSE;
+					Inflight[Slot].Age = 0;                      /* The retry clock starts at the real transmission */
+				}
+			}
+		}
+		else if (TCPState != GSM_TCP_Connected)
+		{
+			TX_Length = 0;                                       /* Socket gone, MQTT_Connect starts a new session */
+			memset(Inflight, 0, sizeof(Inflight));
+		}
+		else
+		{
+			TX_BatchAge = 0;                                     /* Batch kept, retried after another window */
+		}
+
+		if (TCPState != GSM_TCP_Connected)
+		{
+			MQTT_CurrentState = MQTT_Disconnected;
+		}
+	}
+
+	return ret;
+}
+
+Std_ReturnType MQTT_Process(const USART_Config_t *USART, uint16 ElapsedMs)
+{
+	Std_ReturnType ret = E_OK;
+	uint8  Chunk[32];
+	uint8  Ping[2];
+	uint16 Received = 0;
+	uint32 KeepAlive = 0;
+
+	if (NULL == USART || MQTT_CurrentState == MQTT_Disconnected)
+	{
+		return E_NOT_OK;
+	}
+
+	/* Drain the modem stream into the packet assembler */
+	do
+	{
+		ret = GSM_TCP_Receive(USART, Chunk, sizeof(Chunk), &Received);
+		for (uint16 Index = 0; Index < Received; Index++)
+		{
+			MQTT_ReceiveByte(USART, Chunk[Index]);
+		}
+	}
+	while (ret == E_OK && Received == sizeof(Chunk));
+
+	if (ret != E_OK)
+	{
+		MQTT_CurrentState = MQTT_Disconnected;
+		return E_NOT_OK;                                         /* Broker or network closed the socket */
+	}
+
+	if (MQTT_CurrentState != MQTT_Connected)
+	{
+		return ret;                                              /* Still waiting for CONNACK */
+	}
+
+	/* PUBACKs of the packets just received ride along with the next batch */
+	for (uint8 Slot = 0; Slot < MQTT_MAX_PUBACKS; Slot++)
+	{
+		if (PUBACK_Pending[Slot] != 0 && MQTT_Reserve(USART, 4) == E_OK)
+		{
+			MQTT_PutByte(MQTT_PACKET_PUBACK);
+			MQTT_PutByte(2);
+			MQTT_PutWord(PUBACK_Pending[Slot]);
+			PUBACK_Pending[Slot] = 0;
+		}
+	}
+
+	/* Resend QoS1 publishes that were not acknowledged in time */
+	for (uint8 Slot = 0; Slot < MQTT_MAX_INFLIGHT; Slot++)
+	{
+		/* A copy still held in the batch is not resent, the broker would get the packet ID twice */
+		if (Inflight[Slot].PacketID != 0 && Inflight[Slot].Queued == FALSE)
+		{
+			if (Inflight[Slot].Age < MQTT_RETRY_TIMEOUT)
+			{
+				Inflight[Slot].Age += ElapsedMs;                 /* Saturates while MQTT_Reserve() refuses */
+			}
+			if (Inflight[Slot].Age >= MQTT_RETRY_TIMEOUT && MQTT_Reserve(USART, Inflight[Slot].Length) == E_OK)
+			{
+				Inflight[Slot].Packet[0] |= MQTT_FLAG_DUP;
+				memcpy(&TX_Batch[TX_Length], Inflight[Slot].Packet, Inflight[Slot].Length);
+				TX_Length += Inflight[Slot].Length;
+				Inflight[Slot].Age = 0;
+				Inflight[Slot].Queued = TRUE;
+			}
+		}
+	}
+
+	/* Keepalive scheduling: ping at 3/4 of the interval, give the broker half an interval to answer */
+	TX_IdleTime += ElapsedMs;
+	if (MQTT_Config->MQTT_KeepAlive != 0)
+	{
+		KeepAlive = (uint32)MQTT_Config->MQTT_KeepAlive * 1000;
+		if (PING_Outstanding == TRUE)
+		{
+			PING_WaitTime += ElapsedMs;
+			if (PING_WaitTime > (KeepAlive / 2))
+			{
+				MQTT_CurrentState = MQTT_Disconnected;
+				GSM_TCP_Close(USART);
+				return E_NOT_OK;
+			}
+		}
+		else if (TX_IdleTime >= (KeepAlive - (KeepAlive / 4)) && TX_Length > 0 && GSM_SendAllowed(TX_Length) == FALSE)
+		{
+			/* The supply gate holds the batch, the ping goes out in its own small CIPSEND to keep the session */
+			Ping[0] = MQTT_PACKET_PINGREQ;
+			Ping[1] = 0;
+			if (GSM_TCP_Send(USART, Ping, sizeof(Ping)) == E_OK)
+			{
+				PING_Outstanding = TRUE;
+				PING_WaitTime = 0;
+				TX_IdleTime = 0;
+			}
+		}
+		else if (TX_IdleTime >= (KeepAlive - (KeepAlive / 4)) && MQTT_Reserve(USART, 2) == E_OK)
+		{
+			MQTT_PutByte(MQTT_PACKET_PINGREQ);
+			MQTT_PutByte(0);
+			PING_Outstanding = TRUE;
+			PING_WaitTime = 0;
+			TX_BatchAge = MQTT_BATCH_WINDOW;                     /* Send right away */
+		}
+	}
+
+	/* Send the batch once its window expires, a deferred batch keeps growing until the supply recovers */
+	if (TX_Length > 0)
+	{
+		if (TX_BatchAge < MQTT_BATCH_WINDOW)
+		{
+			TX_BatchAge += ElapsedMs;                            /* Saturates instead of wrapping while deferred */
+		}
+		if (TX_BatchAge >= MQTT_BATCH_WINDOW && GSM_SendAllowed(TX_Length) == TRUE)
+		{
+			ret = MQTT_Flush(USART);
+		}
+	}
+
+	return ret;
+}
+
+Std_ReturnType MQTT_Disconnect(const USART_Config_t *USART)
+{
+	Std_ReturnType ret = E_OK;
+
+	if (NULL == USART)
+	{
+		ret = E_NOT_OK;
+	}
+	else
+	{
+		if (MQTT_CurrentState == MQTT_Connected && MQTT_Reserve(USART, 2) == E_OK)
+		{
+			MQTT_PutByte(MQTT_PACKET_DISCONNECT);
+			MQTT_PutByte(0);
+			MQTT_Flush(USART);
+		}
+		MQTT_CurrentState = MQTT_Disconnected;
+		TX_Length = 0;
+		ret = GSM_TCP_Close(USART);
+	}
+
+	return ret;
+}
+
+Std_ReturnType MQTT_GetState(MQTT_State_t *State)
+{
+	Std_ReturnType ret = E_OK;
+
+	if (NULL == State)
+	{
+		ret = E_NOT_OK;
+	}
+	else
+	{
+		*State = MQTT_CurrentState;
+	}
+
+	return ret;
+}
@@ -0,0 +1,271 @@
+
+/********************************************************************************************************
+ *  [FILE NAME]   :      <Outbox.c>                                                                     *
+ *  [AUTHOR]      :      <David S. Alexander>                                                           *
+ *  [DATE CREATED]:      <Oct 18, 2026>                                                                 *
+ *  [Description] :      <Source file for the EEPROM store-and-forward telemetry queue>                 *
+ ********************************************************************************************************/
+
+#include "../Inc/Outbox.h"
+
+/*
+ * EEPROM layout:
+ *   Meta cells : [0..1] tail sequence, [2] tail slot, [3] stamp, [4] check
+ *                written round-robin, the newest is the last one in a run of consecutive stamps.
+ *   Slots      : [0..1] sequence, [2] length, [3] CRC-8, [4..] data
+ *                the sequence is written last and is the commit, a record is live when its
+ *                sequence matches its distance from the tail and the CRC holds.
+ */
+
+#define OUTBOX_META_CHECK         0xA5
+
+static boolean Outbox_Ready = FALSE;
+static uint16  Outbox_TailSequence;
+static uint8   Outbox_TailSlot;
+static uint8   Outbox_Count;
+static uint8   Outbox_MetaCell;
+static uint8   Outbox_MetaStamp;
+
+static uint8 Outbox_Crc8(uint8 Crc, const uint8 *Data, uint8 Length)
+{
+	while (Length--)
+	{
+		Crc ^= *Data++;
+		for (uint8 Bit = 0; Bit < 8; Bit++)
+		{
+			Crc = (Crc & 0x80) ? (uint8)((Crc << 1) ^ 0x07) : (uint8)(Crc << 1);
+		}
+	}
+
+	return Crc;
+}
+
+static uint16 Outbox_SlotAddress(uint8 Slot)
+{
+	return OUTBOX_SLOT_BASE + ((uint16)Slot * OUTBOX_SLOT_SIZE);
+}
+
+static boolean Outbox_ReadMeta(uint8 Cell, uint16 *Sequence, uint8 *Slot, uint8 *Stamp)
+{
+	uint8 Meta[OUTBOX_META_CELL_SIZE];
+
+	EEPROM_ReadBlock(OUTBOX_EEPROM_BASE + ((uint16)Cell * OUTBOX_META_CELL_SIZE), Meta, sizeof(Meta));
+	*Sequence = (uint16)Meta[0] | ((uint16)Meta[1] << 8);
+	*Slot = Meta[2];
+	*Stamp = Meta[3];
+
+	return (Meta[4] == (Meta[0] ^ Meta[1] ^ Meta[2] ^ Meta[3] ^ OUTBOX_META_CHECK) && Meta[2] < OUTBOX_SLOT_COUNT) ? TRUE : FALSE;
+}
+
+/* Persist a new tail in the next meta cell, a torn write leaves the previous cell in charge */
+static void Outbox_CommitTail(uint16 Sequence, uint8 Slot)
+{
+	uint8 Meta[OUTBOX_META_CELL_SIZE];
+
+	Outbox_MetaCell = (Outbox_MetaCell + 1) % OUTBOX_META_CELLS;
+	Outbox_MetaStamp++;
+
+	Meta[0] = (uint8)(Sequence & 0xFF);
+	Meta[1] = (uint8)(Sequence >> 8);
+	Meta[2] = Slot;
+	Meta[3] = Outbox_MetaStamp;
+	Meta[4] = Meta[0] ^ Meta[1] ^ Meta[2] ^ Meta[3] ^ OUTBOX_META_CHECK;
+	EEPROM_UpdateBlock(OUTBOX_EEPROM_BASE + ((uint16)Outbox_MetaCell * OUTBOX_META_CELL_SIZE), Meta, sizeof(Meta));
+
+	Outbox_TailSequence = Sequence;
+	Outbox_TailSlot = Slot;
+}
+
+/* Validate a slot against the expected sequence, optionally copying the record out */
+static boolean Outbox_ReadSlot(uint8 Slot, uint16 Sequence, uint8 *Data, uint8 Size, uint8 *Length)
+{
+	uint8  Header[4];
+	uint8  Byte = 0;
+	uint8  Crc = 0;
+	uint16 Address = Outbox_SlotAddress(Slot);
+
+	EEPROM_ReadBlock(Address, Header, sizeof(Header));
+	if (((uint16)Header[0] | ((uint16)Header[1] << 8)) != Sequence || Header[2] == 0 || Header[2] > OUTBOX_RECORD_MAX ||
+	    (NULL != Data && Header[2] > Size))
+	{
+		return FALSE;
+	}
+
+	Crc = Outbox_Crc8(0, Header, 3);
+	for (uint8 Index = 0; Index < Header[2]; Index++)
+	{
+		EEPROM_ReadByte(Address + 4 + Index, &Byte);
+		Crc = Outbox_Crc8(Crc, &Byte, 1);
+		if (NULL != Data)
+		{
+			Data[Index] = Byte;
+		}
+	}
+	if (NULL != Length)
+	{
+		*Length = Header[2];
+	}
+
+	return (Crc == Header[3]) ? TRUE : FALSE;
+}
+
+Std_ReturnType Outbox_Init(void)
+{
+	uint16  Sequence = 0, NextSequence = 0;
+	uint8   Slot = 0, NextSlot = 0;
+	uint8   Stamp = 0, NextStamp = 0;
+	boolean Found = FALSE;
+
+	Outbox_TailSequence = 0;
+	Outbox_TailSlot = 0;
+	Outbox_MetaCell = OUTBOX_META_CELLS - 1;
+	Outbox_MetaStamp = 0xFF;
+
+	/* The newest tail is the valid cell whose successor does not carry the next stamp */
+	for (uint8 Cell = 0; Cell < OUTBOX_META_CELLS && Found == FALSE; Cell++)
+	{
+		if (Outbox_ReadMeta(Cell, &Sequence, &Slot, &Stamp) == TRUE &&
+		    (Outbox_ReadMeta((Cell + 1) % OUTBOX_META_CELLS, &NextSequence, &NextSlot, &NextStamp) == FALSE ||
+		     NextStamp != (uint8)(Stamp + 1)))
+		{
+			Outbox_TailSequence = Sequence;
+			Outbox_TailSlot = Slot;
+			Outbox_MetaCell = Cell;
+			Outbox_MetaStamp = Stamp;
+			Found = TRUE;
+		}
+	}
+
+	/* Live records form an unbroken run of sequences after the tail, a torn write ends it */
+	Outbox_Count = 0;
+	while (Outbox_Count < OUTBOX_SLOT_COUNT &&
+	       Outbox_ReadSlot((Outbox_TailSlot + Outbox_Count) % OUTBOX_SLOT_COUNT, Outbox_TailSequence + Outbox_Count, NULL, 0, NULL) == TRUE)
+	{
+		Outbox_Count++;
+	}
+
+	Outbox_Ready = TRUE;
+
+	return E_OK;
+}
+
+Std_ReturnType Outbox_Push(const uint8 *Data, uint8 Length)
+{
+	uint8  Header[4];
+	uint16 Sequence = 0;
+	uint16 Address = 0;
+
+	if (NULL == Data || Length == 0 || Length > OUTBOX_RECORD_MAX || Outbox_Ready == FALSE)
+	{
+		return E_NOT_OK;
+	}
+
+	if (Outbox_Count == OUTBOX_SLOT_COUNT)
+	{
+		/* Full: the oldest record makes room, recent telemetry is worth more */
+		Outbox_CommitTail(Outbox_TailSequence + 1, (Outbox_TailSlot + 1) % OUTBOX_SLOT_COUNT);
+		Outbox_Count--;
+	}
+
+	Sequence = Outbox_TailSequence + Outbox_Count;
+	Address = Outbox_SlotAddress((Outbox_TailSlot + Outbox_Count) % OUTBOX_SLOT_COUNT);
+
+	Header[0] = (uint8)(Sequence & 0xFF);
+	Header[1] = (uint8)(Sequence >> 8);
+	Header[2] = Length;
+	Header[3] = Outbox_Crc8(Outbox_Crc8(0, Header, 3), Data, Length);
+
+	EEPROM_UpdateBlock(Address + 2, &Header[2], 2);
+	EEPROM_UpdateBlock(Address + 4, Data, Length);
+	EEPROM_UpdateBlock(Address, Header, 2);                         // Commit
+	Outbox_Count++;
+
+	return E_OK;
+}
+
+Std_ReturnType Outbox_Peek(uint8 *Data, uint8 Size, uint8 *Length)
+{
+	Std_ReturnType ret = E_OK;
+
+	if (NULL == Data || NULL == Length || Outbox_Count == 0 ||
+	    Outbox_ReadSlot(Outbox_TailSlot, Outbox_TailSequence, Data, Size, Length) == FALSE)
+	{
+		ret = E_NOT_OK;
+	}
+
+	return ret;
+}
+
+Std_ReturnType Outbox_Pop(void)
+{
+	Std_ReturnType ret = E_OK;
+
+	if (Outbox_Count == 0)
+	{
+		ret = E_NOT_OK;
+	}
+	else
+	{
+		Outbox_CommitTail(Outbox_TailSequence + 1, (Outbox_TailSlot + 1) % OUTBOX_SLOT_COUNT);
+		Outbox_Count--;
+	}
+
+	return ret;
+}
+
+Std_ReturnType Outbox_Drain(Outbox_Sender_t Sender, uint8 MaxRecords, uint8 *Sent)
+{
+	Std_ReturnType ret = E_OK;
+	uint8  Record[OUTBOX_RECORD_MAX];
+	uint8  Length = 0;
+	uint8  Delivered = 0;
+	uint8  Slot = Outbox_TailSlot;
+	uint16 Sequence = Outbox_TailSequence;
+
+	if (NULL == Sender)
+	{
+		return E_NOT_OK;
+	}
+
+	while (Delivered < Outbox_Count && Delivered < MaxRecords)
+	{
+		/* A record that no longer verifies is skipped rather than blocking the queue */
+		if (Outbox_ReadSlot(Slot, Sequence, Record, sizeof(Record), &Length) == TRUE && Sender(Record, Length) != E_OK)
+		{
+			ret = E_NOT_OK;
+			break;
+		}
+		Slot = (Slot + 1) % OUTBOX_SLOT_COUNT;
+		Sequence++;
+		Delivered++;
+	}
+
+	/* One tail update per batch, a reset before it only causes a resend */
+	if (Delivered > 0)
+	{
+		Outbox_CommitTail(Sequence, Slot);
+		Outbox_Count -= Delivered;
+	}
+	if (NULL != Sent)
+	{
+		*Sent = Delivered;
+	}
+
+	return ret;
+}
+
+Std_ReturnType Outbox_GetCount(uint8 *Count)
+{
+	Std_ReturnType ret = E_OK;
+
+	if (NULL == Count)
+	{
+		ret = E_NOT_OK;
+	}
+	else
+	{
+		*Count = Outbox_Count;
+	}
+
+	return ret;
+}
@@ -0,0 +1,180 @@
+
+/********************************************************************************************************
+ *  [FILE NAME]   :      <Power.c>                                                                      *
+ *  [AUTHOR]      :      <David S. Alexander>                                                           *
+ *  [DATE CREATED]:      <Oct 18, 2026>                                                                 *
+ *  [Description] :      <Source file for the MCU sleep and modem slow clock power manager>             *
+ ********************************************************************************************************/
+
+#include "../Inc/Power.h"
+
+/*
+ * With AT+CSCLK=1 the SIM808 sleeps while DTR is high and its UART is idle.
+ * It still wakes by itself to send URCs and pulses RI, so SMS and calls are
+ * not missed. Commands need DTR low first: every string written to the modem
+ * channel runs Power_ModemWake() through the USART transmit hook, which waits
+ * POWER_MODEM_WAKE_MS only when the modem was actually asleep.
+ */
+
+
+static const USART_Config_t *Power_USART = NULL;
+static boolean Power_Asleep = FALSE;
+static boolean Power_Ring = FALSE;
+static uint32  Power_LastActivity;
+#if USART_STATS
+static uint32  Power_LastBytesOut;
+#endif
+
+static void Power_WakeHook(void)
+{
+	Power_ModemWake();
+}
+
+Std_ReturnType Power_Init(const USART_Config_t *USART)
+{
+	Std_ReturnType ret = E_OK;
+
+	if (NULL == USART)
+	{
+		return E_NOT_OK;
+	}
+
+	DIO_FAST_LOW(POWER_DTR);                                           /* DTR low, the modem stays awake */
+	DIO_FAST_OUTPUT(POWER_DTR);
+	DIO_FAST_INPUT(POWER_RI);
+	DIO_FAST_HIGH(POWER_RI);                                           /* RI with the internal pull-up */
+	Sleep_WakePinEnable(SLEEP_FallingEdge);
+
+	Power_USART = USART;
+	Power_Asleep = FALSE;
+	Power_Ring = FALSE;
+
+	USART_Transmit_String_P(USART, PSTR("AT+CSCLK=1\r\n"));                // Slow clock whenever DTR is high
+	ret = GSM_WaitForClass_P(USART, PSTR("OK"), GSM_CLASS_Local);
+
+	if (ret == E_OK)
+	{
+		USART_SetTransmitHook(USART, Power_WakeHook);
+	}
+	Power_LastActivity = Timer_GetMillis();
+
+	return ret;
+}
+
+Std_ReturnType Power_ModemWake(void)
+{
+	if (NULL == Power_USART)
+	{
+		return E_NOT_OK;
+	}
+
+	if (Power_Asleep == TRUE)
+	{
+		DIO_FAST_LOW(POWER_DTR);
+		Timer_DelayMs(POWER_MODEM_WAKE_MS);                            /* The first command would be lost before */
+		Power_Asleep = FALSE;
+	}
+	Power_LastActivity = Timer_GetMillis();
+
+	return E_OK;
+}
+
+Std_ReturnType Power_ModemSleep(void)
+{
+	if (NULL == Power_USART)
+	{
+		return E_NOT_OK;
+	}
+
+	DIO_FAST_HIGH(POWER_DTR);                                          /* The modem sleeps once its UART is idle */
+	Power_Asleep = TRUE;
+
+	return E_OK;
+}
+
+boolean Power_ModemAsleep(void)
+{
+	return Power_Asleep;
+}
+
+/**
+* @brief Main loop housekeeping: latches RI, lets the modem sleep after POWER_MODEM_IDLE_MS without commands.
+*/
+Std_ReturnType Power_Process(void)
+{
+#if USART_STATS
+	USART_Stats_t Stats;
+#endif
+
+	if (NULL == Power_USART)
+	{
+		return E_NOT_OK;
+	}
+
+	if (Sleep_WakePending() == TRUE)
+	{
+		Power_Ring = TRUE;
+	}
+
+#if USART_STATS
+	/* Bytes that bypass the string writes, e.g. the UART bridge, count as activity too */
+	if (USART_GetStats(Power_USART, &Stats) == E_OK && Stats.USART_BytesOut != Power_LastBytesOut)
+	{
+		Power_LastBytesOut = Stats.USART_BytesOut;
+		Power_ModemWake();
+	}
+#endif
+
+	if (Power_Asleep == FALSE && (Timer_GetMillis() - Power_LastActivity) >= POWER_MODEM_IDLE_MS)
+	{
+		Power_ModemSleep();
+	}
+
+	return E_OK;
+}
+
+/* Reports and clears an RI pulse seen since the last call */
+boolean Power_RingPending(void)
+{
+	boolean Ring = Power_Ring;
+
+	Power_Ring = FALSE;
+	return Ring;
+}
+
+/**
+* @brief Idles the CPU until the next interrupt, the 1 ms tick bounds the wait.
+*/
+void Power_Idle(void)
+{
+	Sleep_Enter(SLEEP_Idle);
+}
+
+/**
+* @brief Power-save until RI goes low, for long quiet periods.
+* @note  Timer1 and the USARTs stop, the time base pauses and only RI wakes the MCU.
+*        The first bytes of the URC behind the RI pulse can be lost while the oscillator starts.
+*/
+Std_ReturnType Power_DeepSleep(void)
+{
+	uint8 State = 0;
+
+	if (NULL == Power_USART || Power_Asleep == FALSE || USART_TransmitSpace(Power_USART) < (USART_TX_BUFFER_SIZE - 1))
+	{
+		return E_NOT_OK;                                               /* Modem awake or bytes still queued */
+	}
+
+	State = GIE_EnterCritical();
+	if (!DIO_FAST_IS_HIGH(POWER_RI))
+	{
+		GIE_ExitCritical(State);
+		return E_NOT_OK;                                               /* The modem is signalling right now */
+	}
+
+	Sleep_WakePinEnable(SLEEP_LowLevel);                               /* Edges are not seen without the I/O clock */
+	Sleep_Enter(SLEEP_PowerSave);
+	Sleep_WakePinEnable(SLEEP_FallingEdge);
+	GIE_ExitCritical(State);
+
+	return E_OK;
+}
@@ -0,0 +1,486 @@
+
+/********************************************************************************************************
+ *  [FILE NAME]   :      <Recovery.c>                                                                   *
+ *  [AUTHOR]      :      <David S. Alexander>                                                           *
+ *  [DATE CREATED]:      <Oct 18, 2026>                                                                 *
+ *  [Description] :      <Source file for the watchdog supervised modem hang recovery>                  *
+ ********************************************************************************************************/
+
+#include "../Inc/Recovery.h"
+
+/*
+ * A hung SIM808 shows up as GSM waits that time out without a single line
+ * from the modem. GSM_DispatchURC() sees every line and clears the count, so
+ * a modem that answers ERROR is still alive. After RECOVERY_TIMEOUT_LIMIT
+ * silent waits, or a quiet link that fails its AT probes, the ladder runs one
+ * step per Recovery_Process() call, cheapest first: AT with a baud rate
+ * scan, then AT+CFUN=1,1, then a PWRKEY power cycle. Each step runs with the
+ * watchdog armed, so a driver stuck on a dead modem (e.g. a TX ring held by
+ * CTS) resets the MCU instead of hanging the board.
+ *
+ * The same queue holds commands the modem cannot take right now: submitted
+ * from an ISR, from a URC handler inside a GSM wait, or behind held work of
+ * the same priority. An urgent entry at the front makes the +HTTPACTION and
+ * SEND OK waits give way through GSM_SetPreempt(), and the next
+ * Recovery_Process() sends it ahead of everything else.
+ */
+
+#if RECOVERY_PWRKEY_INVERTED
+#define RECOVERY_PWRKEY_PRESS()    DIO_FAST_HIGH(RECOVERY_PWRKEY)
+#define RECOVERY_PWRKEY_RELEASE()  DIO_FAST_LOW(RECOVERY_PWRKEY)
+#else
+#define RECOVERY_PWRKEY_PRESS()    DIO_FAST_LOW(RECOVERY_PWRKEY)
+#define RECOVERY_PWRKEY_RELEASE()  DIO_FAST_HIGH(RECOVERY_PWRKEY)
+#endif
+
+typedef struct
+{
+	const char         *Command;             // Flash strings, NULL for a job
+	const char         *Expected;
+	Recovery_Job_t      Job;
+	uint16              Timeout;
+	Recovery_Priority_t Priority;
+	uint32              Queued;              // Timer_GetMillis() at the submit
+
+} Recovery_Command_t;
+
+static const USART_Config_t *Recovery_USART = NULL;
+static Recovery_Reinit_t  Recovery_Reinit = NULL;
+static Recovery_Status_t  Recovery_Status;
+static uint32             Recovery_Start;
+static uint32             Recovery_FailTime;
+
+static Recovery_Command_t Recovery_Queue[RECOVERY_QUEUE_SIZE];  // Sorted, the next to run at index 0
+static volatile uint8     Recovery_Count;
+static Recovery_Priority_t Recovery_Running = RECOVERY_PriorityBackground;
+
+/* Timer_DelayMs() with the watchdog kept alive */
+static void Recovery_Wait(uint32 Ms)
+{
+	uint32 Start = Timer_GetMillis();
+
+	while ((Timer_GetMillis() - Start) < Ms)
+	{
+		Watchdog_Kick();
+		Timer_DelayMs(10);
+	}
+}
+
+static void Recovery_PwrKeyPulse(void)
+{
+	RECOVERY_PWRKEY_PRESS();
+	Recovery_Wait(RECOVERY_PWRKEY_MS);
+	RECOVERY_PWRKEY_RELEASE();
+}
+
+static boolean Recovery_ModemOn(void)
+{
+#if RECOVERY_HAS_STATUS
+	return DIO_FAST_IS_HIGH(RECOVERY_STATUS) ? TRUE : FALSE;
+#else
+	return TRUE;                                                   // Unknown, assume the hung modem is on
+#endif
+}
+
+static Std_ReturnType Recovery_PowerCycle(void)
+{
+	Std_ReturnType ret = E_OK;
+
+	if (Recovery_ModemOn() == TRUE)
+	{
+		Recovery_PwrKeyPulse();                                    // Normal power down
+		Recovery_Wait(RECOVERY_OFF_MS);
+		if (Recovery_ModemOn() == TRUE)
+		{
+			return E_NOT_OK;                                       // PWRKEY not wired or the modem ignores it
+		}
+	}
+
+	Recovery_PwrKeyPulse();                                        // Power up
+	Recovery_Wait(RECOVERY_POWER_BOOT_MS);
+	ret = (Recovery_ModemOn() == TRUE) ? GSM_SyncBaudRate(Recovery_USART) : E_NOT_OK;
+
+#if !RECOVERY_HAS_STATUS
+	if (ret != E_OK)
+	{
+		/* Blind: the modem may have been off already and the first pulse turned it on */
+		Recovery_PwrKeyPulse();
+		Recovery_Wait(RECOVERY_POWER_BOOT_MS);
+		ret = GSM_SyncBaudRate(Recovery_USART);
+	}
+#endif
+
+	return ret;
+}
+
+/* Runs one step of the ladder, E_OK when the modem answers again */
+static Std_ReturnType Recovery_RunStep(Recovery_Step_t Step)
+{
+	Std_ReturnType ret = E_NOT_OK;
+
+	switch (Step)
+	{
+		case RECOVERY_Probe:
+		ret = GSM_SyncBaudRate(Recovery_USART);                    // Settings survive, no setup needed
+		break;
+
+		case RECOVERY_SoftReset:
+		USART_Transmit_String_P(Recovery_USART, PSTR("AT+CFUN=1,1\r\n"));
+		Recovery_Wait(RECOVERY_CFUN_BOOT_MS);
+		ret = GSM_SyncBaudRate(Recovery_USART);
+		break;
+
+		case RECOVERY_PowerCycle:
+		ret = Recovery_PowerCycle();
+		break;
+
+		default:
+		break;
+	}
+
+	/* A reset modem lost its setup, ATE1 and AT+CSCLK among others */
+	if (ret == E_OK && Step != RECOVERY_Probe && NULL != Recovery_Reinit)
+	{
+		ret = Recovery_Reinit();
+	}
+
+	return ret;
+}
+
+/*
+ * Call with interrupts off. Goes behind its own priority, or ahead of it when
+ * Front is set (a command put back). A full queue gives up its newest entry
+ * of the lowest priority for a more important one.
+ */
+static Std_ReturnType Recovery_Insert(const Recovery_Command_t *Entry, boolean Front)
+{
+	uint8 Position = 0;
+
+	while (Position < Recovery_Count && (Recovery_Queue[Position].Priority > Entry->Priority ||
+	       (Front == FALSE && Recovery_Queue[Position].Priority == Entry->Priority)))
+	{
+		Position++;
+	}
+
+	if (Recovery_Count >= RECOVERY_QUEUE_SIZE)
+	{
+		if (Recovery_Queue[RECOVERY_QUEUE_SIZE - 1].Priority >= Entry->Priority)
+		{
+			return E_NOT_OK;                                       // Full of work at least as important
+		}
+		Recovery_Count--;
+		if (Recovery_Status.Dropped < 0xFF)
+		{
+			Recovery_Status.Dropped++;
+		}
+	}
+
+	for (uint8 Index = Recovery_Count; Index > Position; Index--)
+	{
+		Recovery_Queue[Index] = Recovery_Queue[Index - 1];
+	}
+	Recovery_Queue[Position] = *Entry;
+	Recovery_Count++;
+
+	return E_OK;
+}
+
+static boolean Recovery_TakeFront(Recovery_Command_t *Entry)
+{
+	boolean Taken = FALSE;
+	uint8 State = GIE_EnterCritical();
+
+	if (Recovery_Count > 0)
+	{
+		*Entry = Recovery_Queue[0];
+		Recovery_Count--;
+		for (uint8 Index = 0; Index < Recovery_Count; Index++)
+		{
+			Recovery_Queue[Index] = Recovery_Queue[Index + 1];
+		}
+		Taken = TRUE;
+	}
+	GIE_ExitCritical(State);
+
+	return Taken;
+}
+
+/* GSM_Preempt_t: urgent work waits at the front and the running operation is not urgent itself */
+static boolean Recovery_UrgentHeld(void)
+{
+	if (Recovery_Count == 0 || Recovery_Queue[0].Priority != RECOVERY_PriorityUrgent ||
+	    Recovery_Running == RECOVERY_PriorityUrgent)
+	{
+		return FALSE;
+	}
+	if (Recovery_Status.Preemptions < 0xFF)
+	{
+		Recovery_Status.Preemptions++;
+	}
+
+	return TRUE;
+}
+
+/* E_OK when answered as expected, Kept is set when the entry has to run again later */
+static Std_ReturnType Recovery_Run(const Recovery_Command_t *Entry, boolean *Kept)
+{
+	Std_ReturnType ret = E_NOT_OK;
+	uint32 Latency = 0;
+
+	(void)GSM_Preempted();                                         // Clear a preemption nobody collected
+	Recovery_Running = Entry->Priority;
+	if (NULL != Entry->Job)
+	{
+		ret = Entry->Job();
+	}
+	else
+	{
+		USART_Transmit_String_P(Recovery_USART, Entry->Command);
+		ret = GSM_WaitForResponse_P(Recovery_USART, Entry->Expected, Entry->Timeout);
+	}
+	Recovery_Running = RECOVERY_PriorityBackground;
+
+	/* Silent modem or cut short for urgent work, an answer other than the expected one is final */
+	*Kept = (ret != E_OK && (GSM_GetTimeouts() > 0 || GSM_Preempted() == TRUE)) ? TRUE : FALSE;
+
+	if (ret == E_OK && Entry->Priority == RECOVERY_PriorityUrgent)
+	{
+		Latency = Timer_GetMillis() - Entry->Queued;
+		Recovery_Status.UrgentLatencyMs = Latency;
+		if (Latency > Recovery_Status.UrgentLatencyMaxMs)
+		{
+			Recovery_Status.UrgentLatencyMaxMs = Latency;
+		}
+	}
+
+	return ret;
+}
+
+/* Sends the held commands by priority, stops at the first one the modem does not answer at all */
+static void Recovery_Replay(void)
+{
+	Recovery_Command_t Entry;
+	boolean Kept = FALSE;
+	uint8 State = 0;
+
+	while (Recovery_TakeFront(&Entry) == TRUE)
+	{
+		Recovery_Run(&Entry, &Kept);
+		if (Kept == TRUE)
+		{
+			State = GIE_EnterCritical();
+			Recovery_Insert(&Entry, TRUE);                         // Back to the front of its priority
+			GIE_ExitCritical(State);
+			if (GSM_GetTimeouts() > 0)
+			{
+				break;                                             // Silent again, kept for the next replay
+			}
+		}
+	}
+}
+
+static Std_ReturnType Recovery_Enqueue(Recovery_Command_t *Entry)
+{
+	Std_ReturnType ret = E_NOT_OK;
+	boolean Kept = FALSE;
+	uint8 State = 0;
+
+	if (NULL == Recovery_USART || Entry->Priority > RECOVERY_PriorityUrgent)
+	{
+		return E_NOT_OK;
+	}
+	Entry->Queued = Timer_GetMillis();
+
+	/* Run now only from the main flow with the modem free: not from an ISR, not inside a GSM wait */
+	if (Recovery_Status.Step == RECOVERY_Healthy && GSM_Busy() == FALSE && BIT_IS_SET(_SREG, GIE_Bit) &&
+	    (Recovery_Count == 0 || Recovery_Queue[0].Priority < Entry->Priority))
+	{
+		ret = Recovery_Run(Entry, &Kept);
+		if (ret == E_OK || Kept == FALSE)
+		{
+			return ret;                                            // E_NOT_OK: answered, only not as expected
+		}
+	}
+
+	State = GIE_EnterCritical();
+	ret = Recovery_Insert(Entry, FALSE);
+	GIE_ExitCritical(State);
+
+	return ret;
+}
+
+Std_ReturnType Recovery_Init(const USART_Config_t *USART, Recovery_Reinit_t Reinit)
+{
+	if (NULL == USART)
+	{
+		return E_NOT_OK;
+	}
+
+	memset(&Recovery_Status, 0, sizeof(Recovery_Status));
+	Recovery_Status.ResetCause = Watchdog_ResetCause();
+	if (Recovery_Status.ResetCause & WATCHDOG_ResetWatchdog)
+	{
+		LOG_WARN(LOG_GSM, "Watchdog reset");
+	}
+
+	RECOVERY_PWRKEY_RELEASE();
+	DIO_FAST_OUTPUT(RECOVERY_PWRKEY);
+#if RECOVERY_HAS_STATUS
+	DIO_FAST_INPUT(RECOVERY_STATUS);
+#endif
+
+	Recovery_USART = USART;
+	Recovery_Reinit = Reinit;
+	Recovery_Count = 0;
+
+	return GSM_SetPreempt(Recovery_UrgentHeld);
+}
+
+/**
+* @brief Main loop supervisor: watches for a silent modem and runs at most one recovery step per call.
+* @note  A step blocks for up to RECOVERY_CFUN_BOOT_MS, or the power cycle plus the Reinit hook.
+*/
+Std_ReturnType Recovery_Process(void)
+{
+	Std_ReturnType ret = E_NOT_OK;
+	Recovery_Step_t Step = Recovery_Status.Step;
+	uint32 Now = 0;
+
+	if (NULL == Recovery_USART)
+	{
+		return E_NOT_OK;
+	}
+
+	Now = Timer_GetMillis();
+	switch (Step)
+	{
+		case RECOVERY_Healthy:
+		if (GSM_GetTimeouts() < RECOVERY_TIMEOUT_LIMIT && (Now - GSM_LastHeard()) >= RECOVERY_SILENCE_MS)
+		{
+			/* Nothing heard for a while, a silent answer counts towards the limit */
+			USART_Transmit_String_P(Recovery_USART, PSTR("AT\r\n"));
+			GSM_WaitForClass_P(Recovery_USART, PSTR("OK"), GSM_CLASS_Local);
+		}
+		if (GSM_GetTimeouts() < RECOVERY_TIMEOUT_LIMIT)
+		{
+			Recovery_Replay();
+			return E_OK;
+		}
+		LOG_WARN(LOG_GSM, "Modem silent, recovering");
+		Recovery_Start = Now;
+		Step = RECOVERY_Probe;
+		break;
+
+		case RECOVERY_Failed:
+		if ((Now - Recovery_FailTime) < RECOVERY_RETRY_MS)
+		{
+			return E_OK;
+		}
+		Step = RECOVERY_Probe;
+		break;
+
+		default:
+		break;
+	}
+
+	Recovery_Status.Step = Step;
+	Watchdog_Enable(RECOVERY_WATCHDOG);
+	ret = Recovery_RunStep(Step);
+	Watchdog_Disable();
+
+	if (ret == E_OK)
+	{
+		Recovery_Status.Step = RECOVERY_Healthy;
+		Recovery_Status.LastStep = Step;
+		Recovery_Status.LastDurationMs = Timer_GetMillis() - Recovery_Start;
+		if (Recovery_Status.Recoveries < 0xFF)
+		{
+			Recovery_Status.Recoveries++;
+		}
+		LOG_INFO(LOG_GSM, "Modem recovered");
+		Recovery_Replay();
+	}
+	else if (Step == RECOVERY_PowerCycle)
+	{
+		Recovery_Status.Step = RECOVERY_Failed;
+		Recovery_FailTime = Timer_GetMillis();
+		if (Recovery_Status.Failures < 0xFF)
+		{
+			Recovery_Status.Failures++;
+		}
+		LOG_ERROR(LOG_GSM, "Modem recovery failed");
+	}
+	else
+	{
+		Recovery_Status.Step = (Recovery_Step_t)(Step + 1);       // Escalate on the next call
+	}
+
+	return ret;
+}
+
+/**
+* @brief Sends a command now, or holds it until the modem is back or free.
+* @note  Command and Expected are flash strings. Safe from an ISR, the command is then held. E_OK
+*        when the answer matched or the command was held, E_NOT_OK when the modem answered
+*        something else or the queue is full of work at least as important.
+*/
+Std_ReturnType Recovery_Submit(const char *Command, const char *Expected, uint16 Timeout, Recovery_Priority_t Priority)
+{
+	Recovery_Command_t Entry;
+
+	if (NULL == Command || NULL == Expected)
+	{
+		return E_NOT_OK;
+	}
+
+	Entry.Command = Command;
+	Entry.Expected = Expected;
+	Entry.Job = NULL;
+	Entry.Timeout = Timeout;
+	Entry.Priority = Priority;
+
+	return Recovery_Enqueue(&Entry);
+}
+
+/**
+* @brief Runs a job now, or holds it like Recovery_Submit().
+* @note  The job is run again later when it fails on a silent modem or gives way to urgent work.
+*/
+Std_ReturnType Recovery_SubmitJob(Recovery_Job_t Job, Recovery_Priority_t Priority)
+{
+	Recovery_Command_t Entry;
+
+	if (NULL == Job)
+	{
+		return E_NOT_OK;
+	}
+
+	Entry.Command = NULL;
+	Entry.Expected = NULL;
+	Entry.Job = Job;
+	Entry.Timeout = 0;
+	Entry.Priority = Priority;
+
+	return Recovery_Enqueue(&Entry);
+}
+
+boolean Recovery_ModemReady(void)
+{
+	return (Recovery_Status.Step == RECOVERY_Healthy) ? TRUE : FALSE;
+}
+
+Std_ReturnType Recovery_GetStatus(Recovery_Status_t *Status)
+{
+	Std_ReturnType ret = E_OK;
+
+	if (NULL == Status)
+	{
+		ret = E_NOT_OK;
+	}
+	else
+	{
+		*Status = Recovery_Status;
+	}
+
+	return ret;
+}
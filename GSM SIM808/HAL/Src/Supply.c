@@ -0,0 +1,250 @@
+
+/********************************************************************************************************
+ *  [FILE NAME]   :      <Supply.c>                                                                     *
+ *  [AUTHOR]      :      <David S. Alexander>                                                           *
+ *  [DATE CREATED]:      <Oct 18, 2026>                                                                 *
+ *  [Description] :      <Source file for the supply voltage health monitor and send throttle>          *
+ ********************************************************************************************************/
+
+#include "../Inc/Supply.h"
+
+/*
+ * A GPRS burst pulls up to 2 A from VBAT. On a weak supply the SIM808 browns
+ * out and the reset costs a full network re-registration. The lowest known
+ * reading of the local divider and AT+CBC sets the level, and the modem's
+ * own UNDER-VOLTAGE URCs push it down at once. A level drops immediately but
+ * only rises after SUPPLY_RECOVER_MS above threshold plus hysteresis, so a
+ * sagging battery does not toggle between sending and deferring.
+ */
+
+static const USART_Config_t *Supply_USART = NULL;
+static Supply_Status_t Supply_Status;
+static uint8   Supply_ADCSlot = SUPPLY_NO_ADC;
+static uint32  Supply_LastPoll;
+static uint32  Supply_WarningTime;
+static uint32  Supply_RecoverStart;
+static boolean Supply_Warned = FALSE;
+static boolean Supply_Recovering = FALSE;
+
+static uint16 Supply_ParseField(const char *Str)
+{
+	uint16 Value = 0;
+
+	while (*Str == ' ')
+	{
+		Str++;
+	}
+	while (*Str >= '0' && *Str <= '9')
+	{
+		Value = (Value * 10) + (*Str++ - '0');
+	}
+
+	return Value;
+}
+
+static void Supply_Raise(Supply_State_t State)
+{
+	Supply_Recovering = FALSE;
+	if (State > Supply_Status.State)
+	{
+		Supply_Status.State = State;
+		if (State == SUPPLY_Critical)
+		{
+			LOG_ERROR(LOG_POWER, "Supply critical, all sends deferred");
+		}
+		else
+		{
+			LOG_WARN(LOG_POWER, "Supply low, large sends deferred");
+		}
+	}
+}
+
+/* +CBC: <bcs>,<bcl>,<voltage mV> */
+static void Supply_CBCHandler(const uint8 *line)
+{
+	const char *Field = strchr((const char*)line, ',');
+
+	if (NULL != Field)
+	{
+		Supply_Status.ModemPercent = (uint8)Supply_ParseField(Field + 1);
+		Field = strchr(Field + 1, ',');
+		if (NULL != Field)
+		{
+			Supply_Status.ModemMv = Supply_ParseField(Field + 1);
+		}
+	}
+}
+
+/* UNDER-VOLTAGE WARNNING (sic) or UNDER-VOLTAGE POWER DOWN */
+static void Supply_WarningHandler(const uint8 *line)
+{
+	if (Supply_Status.Warnings < 0xFF)
+	{
+		Supply_Status.Warnings++;
+	}
+	Supply_WarningTime = Timer_GetMillis();
+	Supply_Warned = TRUE;
+
+	Supply_Raise((strstr_P((const char*)line, PSTR("POWER DOWN")) != NULL) ? SUPPLY_Critical : SUPPLY_Low);
+}
+
+/* Leaving a level upwards needs the hysteresis on top of its threshold */
+static Supply_State_t Supply_Level(uint16 Mv)
+{
+	Supply_State_t State = SUPPLY_Good;
+
+	if (Mv < (SUPPLY_CRITICAL_MV + ((Supply_Status.State == SUPPLY_Critical) ? SUPPLY_HYSTERESIS_MV : 0)))
+	{
+		State = SUPPLY_Critical;
+	}
+	else if (Mv < (SUPPLY_LOW_MV + ((Supply_Status.State != SUPPLY_Good) ? SUPPLY_HYSTERESIS_MV : 0)))
+	{
+		State = SUPPLY_Low;
+	}
+
+	return State;
+}
+
+Std_ReturnType Supply_Init(const USART_Config_t *USART, uint8 ADCSlot)
+{
+	Std_ReturnType ret = E_OK;
+
+	if (NULL == USART || (ADCSlot != SUPPLY_NO_ADC && ADCSlot >= ADC_SCAN_MAX_CHANNELS))
+	{
+		return E_NOT_OK;
+	}
+
+	memset(&Supply_Status, 0, sizeof(Supply_Status));
+	Supply_USART = USART;
+	Supply_ADCSlot = ADCSlot;
+	Supply_Warned = FALSE;
+	Supply_Recovering = FALSE;
+
+	/* The polled +CBC answer goes through the URC dispatcher like the GNSS report */
+	GSM_RegisterURC(PSTR("+CBC:"), Supply_CBCHandler);
+	GSM_RegisterURC(PSTR("UNDER-VOLTAGE"), Supply_WarningHandler);
+	GSM_SetSendGate(Supply_SendAllowed);
+
+	USART_Transmit_String_P(USART, PSTR("AT+CBC\r\n"));
+	ret = GSM_WaitForClass_P(USART, PSTR("OK"), GSM_CLASS_Local);
+	Supply_LastPoll = Timer_GetMillis();
+
+	return ret;
+}
+
+Std_ReturnType Supply_Process(void)
+{
+	uint32 Now = 0;
+	uint16 Raw = 0;
+	uint16 Mv = 0;
+	Supply_State_t Target = SUPPLY_Good;
+
+	if (NULL == Supply_USART)
+	{
+		return E_NOT_OK;
+	}
+
+	if (Supply_ADCSlot != SUPPLY_NO_ADC && ADC_ScanGet(Supply_ADCSlot, &Raw) == E_OK)
+	{
+		Supply_Status.LocalMv = (uint16)(((uint32)Raw * SUPPLY_ADC_FULL_SCALE_MV) >> ADC_SCAN_RESOLUTION);
+		ADC_ScanTrigger();                                             // Next round, refused in continuous mode
+	}
+
+	Now = Timer_GetMillis();
+	if ((Now - Supply_LastPoll) >= ((Supply_Status.State == SUPPLY_Good) ? SUPPLY_POLL_MS : SUPPLY_POLL_LOW_MS))
+	{
+		USART_Transmit_String_P(Supply_USART, PSTR("AT+CBC\r\n"));
+		GSM_WaitForClass_P(Supply_USART, PSTR("OK"), GSM_CLASS_Local);
+		Now = Timer_GetMillis();
+		Supply_LastPoll = Now;
+	}
+
+	/* The lowest known reading decides, no reading at all means no throttling */
+	Mv = Supply_Status.ModemMv;
+	if (Supply_Status.LocalMv != 0 && (Mv == 0 || Supply_Status.LocalMv < Mv))
+	{
+		Mv = Supply_Status.LocalMv;
+	}
+	Target = (Mv == 0) ? SUPPLY_Good : Supply_Level(Mv);
+
+	if (Supply_Warned == TRUE)
+	{
+		if ((Now - Supply_WarningTime) < SUPPLY_WARNING_HOLD_MS)
+		{
+			Target = (Target == SUPPLY_Good) ? SUPPLY_Low : Target;
+		}
+		else
+		{
+			Supply_Warned = FALSE;
+		}
+	}
+
+	if (Target > Supply_Status.State)
+	{
+		Supply_Raise(Target);
+	}
+	else if (Target < Supply_Status.State)
+	{
+		if (Supply_Recovering == FALSE)
+		{
+			Supply_Recovering = TRUE;
+			Supply_RecoverStart = Now;
+		}
+		else if ((Now - Supply_RecoverStart) >= SUPPLY_RECOVER_MS)
+		{
+			/* Deferred MQTT batches and queued records go out on their next pass */
+			Supply_Status.State = Target;
+			Supply_Recovering = FALSE;
+			LOG_INFO(LOG_POWER, "Supply recovered");
+		}
+	}
+	else
+	{
+		Supply_Recovering = FALSE;
+	}
+
+	return E_OK;
+}
+
+Supply_State_t Supply_GetState(void)
+{
+	return Supply_Status.State;
+}
+
+Std_ReturnType Supply_GetStatus(Supply_Status_t *Status)
+{
+	Std_ReturnType ret = E_OK;
+
+	if (NULL == Status)
+	{
+		ret = E_NOT_OK;
+	}
+	else
+	{
+		*Status = Supply_Status;
+	}
+
+	return ret;
+}
+
+boolean Supply_SendAllowed(uint16 Length)
+{
+	boolean Allowed = FALSE;
+
+	switch (Supply_Status.State)
+	{
+		case SUPPLY_Good:
+		Allowed = TRUE;
+		break;
+
+		case SUPPLY_Low:
+		Allowed = (Length <= SUPPLY_BURST_BYTES) ? TRUE : FALSE;      // Keepalives and acks still pass
+		break;
+
+		default:
+		Allowed = FALSE;
+		break;
+	}
+
+	return Allowed;
+}
@@ -0,0 +1,297 @@
+
+/********************************************************************************************************
+ *  [FILE NAME]   :      <Track.c>                                                                      *
+ *  [AUTHOR]      :      <David S. Alexander>                                                           *
+ *  [DATE CREATED]:      <Oct 18, 2026>                                                                 *
+ *  [Description] :      <Source file for the GNSS track simplification and batching buffer>            *
+ ********************************************************************************************************/
+
+#include "../Inc/Track.h"
+
+#define TRACK_HEADER_BYTES        12
+#define TRACK_POINT_MAX_BYTES     15           /* Three 5-byte varints */
+
+typedef struct
+{
+	sint32 Latitude;
+	sint32 Longitude;
+	uint32 Second;                             /* UTC second of day */
+
+} Track_Point_t;
+
+static Track_Point_t Track_Anchor;             /* Last point written to the batch */
+static boolean       Track_HasAnchor = FALSE;
+static uint16        Track_AnchorCos;
+
+static Track_Point_t Track_Window[TRACK_WINDOW_SIZE];
+static uint8         Track_WindowCount;
+
+static uint8         Track_Batch[TRACK_BATCH_SIZE];
+static uint16        Track_BatchLength;
+static Track_Point_t Track_LastEncoded;
+
+static uint32 Track_Sqrt(uint32 Value)
+{
+	uint32 Root = 0;
+	uint32 Bit = 1UL << 30;
+
+	while (Bit > Value)
+	{
+		Bit >>= 2;
+	}
+	while (Bit != 0)
+	{
+		if (Value >= Root + Bit)
+		{
+			Value -= Root + Bit;
+			Root = (Root >> 1) + Bit;
+		}
+		else
+		{
+			Root >>= 1;
+		}
+		Bit >>= 2;
+	}
+
+	return Root;
+}
+
+static boolean Track_InRange(const Track_Point_t *Point)
+{
+	sint32 dLatitude  = Point->Latitude  - Track_Anchor.Latitude;
+	sint32 dLongitude = Point->Longitude - Track_Anchor.Longitude;
+
+	return (dLatitude  <= TRACK_MAX_DELTA && dLatitude  >= -TRACK_MAX_DELTA &&
+	        dLongitude <= TRACK_MAX_DELTA && dLongitude >= -TRACK_MAX_DELTA) ? TRUE : FALSE;
+}
+
+/* Local planar coordinates in meters with the anchor at the origin */
+static void Track_Project(const Track_Point_t *Point, sint32 *x, sint32 *y)
+{
+	*y = GNSS_UDEG_TO_METERS(Point->Latitude - Track_Anchor.Latitude);
+	*x = (GNSS_UDEG_TO_METERS(Point->Longitude - Track_Anchor.Longitude) * (sint32)Track_AnchorCos) >> 15;
+}
+
+/* TRUE when any buffered fix is further than TRACK_TOLERANCE from the segment anchor -> End */
+static boolean Track_Deviates(const Track_Point_t *End)
+{
+	sint32 bx = 0, by = 0, px = 0, py = 0, Cross = 0, Dot = 0;
+	uint32 Square = 0, Length = 0;
+
+	Track_Project(End, &bx, &by);
+	Square = (uint32)(bx * bx) + (uint32)(by * by);
+	Length = Track_Sqrt(Square);
+
+	for (uint8 Index = 0; Index < Track_WindowCount; Index++)
+	{
+		Track_Project(&Track_Window[Index], &px, &py);
+		Dot = (bx * px) + (by * py);
+		if (Dot > 0 && (uint32)Dot < Square)
+		{
+			Cross = (bx * py) - (by * px);    /* |Cross| / Length is the perpendicular distance */
+			if (Cross < 0)
+			{
+				Cross = -Cross;
+			}
+			if ((uint32)Cross > (TRACK_TOLERANCE * Length))
+			{
+				return TRUE;
+			}
+		}
+		else
+		{
+			/* Behind the anchor or past End the nearest point is that end, a zero length segment always lands here */
+			if (Dot > 0)
+			{
+				px -= bx;
+				py -= by;
+			}
+			if (px > TRACK_TOLERANCE || px < -TRACK_TOLERANCE || py > TRACK_TOLERANCE || py < -TRACK_TOLERANCE ||
+			    ((uint32)(px * px) + (uint32)(py * py)) > ((uint32)TRACK_TOLERANCE * TRACK_TOLERANCE))
+			{
+				return TRUE;
+			}
+		}
+	}
+
+	return FALSE;
+}
+
+static boolean Track_InDeadband(const Track_Point_t *Last, const Track_Point_t *Point)
+{
+	sint32 lx = 0, ly = 0, px = 0, py = 0;
+
+	Track_Project(Last, &lx, &ly);
+	Track_Project(Point, &px, &py);
+	px -= lx;
+	py -= ly;
+
+	return (((uint32)(px * px) + (uint32)(py * py)) < ((uint32)TRACK_DEADBAND * TRACK_DEADBAND)) ? TRUE : FALSE;
+}
+
+static void Track_PutVarint(sint32 Value)
+{
+	/* Zigzag keeps small negative deltas short */
+	uint32 Zigzag = (Value < 0) ? (((uint32)(-Value) << 1) - 1) : ((uint32)Value << 1);
+
+	while (Zigzag >= 0x80)
+	{
+		Track_Batch[Track_BatchLength++] = (uint8)(Zigzag | 0x80);
+		Zigzag >>= 7;
+	}
+	Track_Batch[Track_BatchLength++] = (uint8)Zigzag;
+}
+
+static void Track_PutLittleEndian(uint32 Value, uint8 Bytes)
+{
+	while (Bytes--)
+	{
+		Track_Batch[Track_BatchLength++] = (uint8)(Value & 0xFF);
+		Value >>= 8;
+	}
+}
+
+static boolean Track_HasRoom(void)
+{
+	return ((Track_BatchLength + TRACK_POINT_MAX_BYTES) <= TRACK_BATCH_SIZE) ? TRUE : FALSE;
+}
+
+/* Write a kept point to the batch and make it the new anchor, the caller checks Track_HasRoom() */
+static void Track_Keep(const Track_Point_t *Point)
+{
+	Track_Point_t Encoded;
+
+	Encoded.Latitude  = Point->Latitude  / TRACK_QUANTUM;
+	Encoded.Longitude = Point->Longitude / TRACK_QUANTUM;
+	Encoded.Second    = Point->Second;
+
+	if (Track_BatchLength == 0)
+	{
+		Track_Batch[Track_BatchLength++] = TRACK_FORMAT_VERSION;
+		Track_PutLittleEndian((uint32)Encoded.Latitude, 4);
+		Track_PutLittleEndian((uint32)Encoded.Longitude, 4);
+		Track_PutLittleEndian(Encoded.Second, 3);
+	}
+	else
+	{
+		Track_PutVarint(Encoded.Latitude  - Track_LastEncoded.Latitude);
+		Track_PutVarint(Encoded.Longitude - Track_LastEncoded.Longitude);
+		Track_PutVarint((Encoded.Second >= Track_LastEncoded.Second) ? (sint32)(Encoded.Second - Track_LastEncoded.Second)
+		                                                              : (sint32)(Encoded.Second + 86400UL - Track_LastEncoded.Second));
+	}
+	Track_LastEncoded = Encoded;
+
+	Track_Anchor = *Point;
+	Track_AnchorCos = GNSS_CosLatitude(Point->Latitude);
+	Track_HasAnchor = TRUE;
+	Track_WindowCount = 0;
+}
+
+Std_ReturnType Track_Init(void)
+{
+	Track_HasAnchor = FALSE;
+	Track_WindowCount = 0;
+	Track_BatchLength = 0;
+
+	return E_OK;
+}
+
+Std_ReturnType Track_AddFix(const GNSS_Fix_t *Fix)
+{
+	Track_Point_t Point;
+
+	if (NULL == Fix || Fix->GNSS_Status != GNSS_FixValid)
+	{
+		return E_NOT_OK;
+	}
+
+	Point.Latitude  = Fix->GNSS_Latitude;
+	Point.Longitude = Fix->GNSS_Longitude;
+	Point.Second    = ((uint32)Fix->GNSS_Hour * 3600UL) + ((uint16)Fix->GNSS_Minute * 60) + Fix->GNSS_Second;
+
+	if (Track_HasAnchor == FALSE)
+	{
+		if (Track_HasRoom() == FALSE)
+		{
+			return E_NOT_OK;
+		}
+		Track_Keep(&Point);
+		return E_OK;
+	}
+
+	/* Dead-band: a parked vehicle keeps reporting a few meters of noise */
+	if (Track_InRange(&Point) == TRUE &&
+	    Track_InDeadband((Track_WindowCount > 0) ? &Track_Window[Track_WindowCount - 1] : &Track_Anchor, &Point) == TRUE)
+	{
+		return E_OK;
+	}
+
+	/* Opening window: keep the previous fix once the straight line to this one no longer covers the window */
+	if (Track_WindowCount > 0 &&
+	    (Track_WindowCount == TRACK_WINDOW_SIZE || Track_InRange(&Point) == FALSE || Track_Deviates(&Point) == TRUE))
+	{
+		if (Track_HasRoom() == FALSE)
+		{
+			return E_NOT_OK;                                           // Upload and clear the batch, then retry
+		}
+		Track_Keep(&Track_Window[Track_WindowCount - 1]);
+	}
+
+	if (Track_InRange(&Point) == FALSE)
+	{
+		if (Track_HasRoom() == FALSE)
+		{
+			return E_NOT_OK;
+		}
+		Track_Keep(&Point);                                            // Jump too long to simplify
+		return E_OK;
+	}
+
+	Track_Window[Track_WindowCount++] = Point;
+
+	return E_OK;
+}
+
+Std_ReturnType Track_Flush(void)
+{
+	Std_ReturnType ret = E_OK;
+
+	if (Track_WindowCount > 0)
+	{
+		if (Track_HasRoom() == FALSE)
+		{
+			ret = E_NOT_OK;
+		}
+		else
+		{
+			Track_Keep(&Track_Window[Track_WindowCount - 1]);
+		}
+	}
+
+	return ret;
+}
+
+Std_ReturnType Track_GetBatch(const uint8 **Data, uint16 *Length)
+{
+	Std_ReturnType ret = E_OK;
+
+	if (NULL == Data || NULL == Length)
+	{
+		ret = E_NOT_OK;
+	}
+	else
+	{
+		*Data = Track_Batch;
+		*Length = Track_BatchLength;
+	}
+
+	return ret;
+}
+
+Std_ReturnType Track_ClearBatch(void)
+{
+	/* The anchor survives so simplification continues across uploads */
+	Track_BatchLength = 0;
+
+	return E_OK;
+}
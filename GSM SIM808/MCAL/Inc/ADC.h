@@ -56,6 +56,18 @@
 #define MAX_ADC_FREQ 1000000UL
 
 
+/* Scanner configuration */
+#define ADC_SCAN_MAX_CHANNELS      8                                   /* Slots in the scan list */
+#define ADC_SCAN_OVERSAMPLE_BITS   2                                   /* Extra bits of resolution, 0..3 */
+#define ADC_SCAN_SAMPLES           (1U << (2 * ADC_SCAN_OVERSAMPLE_BITS))   /* Conversions summed per result */
+#define ADC_SCAN_DISCARD           1                                   /* Conversions dropped after a mux change */
+#define ADC_SCAN_RESOLUTION        (10 + ADC_SCAN_OVERSAMPLE_BITS)     /* Bits per scan result */
+
+#if ADC_SCAN_OVERSAMPLE_BITS > 3
+#error "ADC_SCAN_OVERSAMPLE_BITS above 3 overflows the 16 bit accumulator"
+#endif
+
+
 /*******************************************************************************
  *                         Data Types Declaration                              *
  *******************************************************************************/
@@ -114,6 +126,13 @@ typedef enum
 	ADCInterruptEnabled    /* Interrupt enabled */
 }ADC_Interrupt;
 
+/* ADC scanner pacing */
+typedef enum
+{
+	ADC_ScanContinuous,  /* Rounds run back to back */
+	ADC_ScanOnDemand     /* One round per ADC_ScanTrigger() */
+}ADC_ScanMode;
+
 /* ADC voltage reference options */
 typedef enum
 {
@@ -170,4 +189,19 @@ Std_ReturnType ADC_Init(ADC_Channel *ADC_Num);
 /* Read from ADC module */
 Std_ReturnType ADC_Read(ADC_Index ADC_Ch, uint16 *ADC_Result);
 
+/* Sequence a list of channels from the ADC interrupt */
+Std_ReturnType ADC_ScanStart(const ADC_Index *Channels, uint8 Count, ADC_ScanMode Mode);
+
+/* Run one more round in ADC_ScanOnDemand mode */
+Std_ReturnType ADC_ScanTrigger(void);
+
+/* Stop the scanner, the last results stay readable */
+Std_ReturnType ADC_ScanStop(void);
+
+/* Latest oversampled result of a scan slot, ADC_SCAN_RESOLUTION bits */
+Std_ReturnType ADC_ScanGet(uint8 Slot, uint16 *ADC_Result);
+
+/* Completed scan rounds, changes whenever a new set of results is published */
+uint8 ADC_ScanRound(void);
+
 #endif /* ADC_H_ */
\ No newline at end of file
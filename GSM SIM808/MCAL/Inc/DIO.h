@@ -17,6 +17,7 @@
 #include "../../Includes/DEVICE_CONFIG.h"
 #include "../../Includes/BIT_MACROS.h"
 #include "../../Includes/STD_LIBRARIES.h"
+#include "Global_Interrupt.h"
 
 /*******************************************************************************
  *                             Macro Declarations                              *
@@ -58,6 +59,37 @@
 #define DIO_DDRA    SFR_IO8(0X1A)
 #define DIO_PORTA   SFR_IO8(0X1B)
 
+/*
+ * Compile-time pins: name a pin once, e.g. #define MODEM_DTR DIO_PIN_ID(E, 5),
+ * and drive it with the DIO_FAST_* macros. Port and bit are constants, so on
+ * ports A..E (I/O space) a write is a single sbi/cbi and a test a single
+ * sbis/sbic, with no validation, table lookup or call. Ports F and G live in
+ * extended I/O where writes become lds/ori/sts and are not atomic against an
+ * ISR touching the same port. The ATmega128 has no PINx toggle, so TOGGLE and
+ * the masked port write are read-modify-write on every port.
+ */
+#define DIO_PIN_ID(PORT, BIT)                PORT, BIT
+
+#define DIO_FAST_OUTPUT(PIN)                 DIO_FAST_OUTPUT_(PIN)
+#define DIO_FAST_INPUT(PIN)                  DIO_FAST_INPUT_(PIN)
+#define DIO_FAST_HIGH(PIN)                   DIO_FAST_HIGH_(PIN)
+#define DIO_FAST_LOW(PIN)                    DIO_FAST_LOW_(PIN)
+#define DIO_FAST_WRITE(PIN, LOGIC)           DIO_FAST_WRITE_(PIN, LOGIC)
+#define DIO_FAST_TOGGLE(PIN)                 DIO_FAST_TOGGLE_(PIN)
+#define DIO_FAST_IS_HIGH(PIN)                DIO_FAST_IS_HIGH_(PIN)
+#define DIO_FAST_READ(PIN)                   (DIO_FAST_IS_HIGH_(PIN) ? HIGH : LOW)
+
+/* Writes the Mask bits of PORTx to Logic and leaves the others alone, PORT is the letter */
+#define DIO_FAST_PORT_MASKED(PORT, MASK, LOGIC)   (DIO_PORT##PORT = (DIO_PORT##PORT & (uint8)~(MASK)) | ((LOGIC) & (MASK)))
+
+#define DIO_FAST_OUTPUT_(PORT, BIT)          SET_BIT(DIO_DDR##PORT, BIT)
+#define DIO_FAST_INPUT_(PORT, BIT)           CLEAR_BIT(DIO_DDR##PORT, BIT)
+#define DIO_FAST_HIGH_(PORT, BIT)            SET_BIT(DIO_PORT##PORT, BIT)
+#define DIO_FAST_LOW_(PORT, BIT)             CLEAR_BIT(DIO_PORT##PORT, BIT)
+#define DIO_FAST_WRITE_(PORT, BIT, LOGIC)    do { if (LOGIC) DIO_FAST_HIGH_(PORT, BIT); else DIO_FAST_LOW_(PORT, BIT); } while (0)
+#define DIO_FAST_TOGGLE_(PORT, BIT)          TOGGLE_BIT(DIO_PORT##PORT, BIT)
+#define DIO_FAST_IS_HIGH_(PORT, BIT)         BIT_IS_SET(DIO_PIN##PORT, BIT)
+
 /*******************************************************************************
  *                         Data Types Declaration                              *
  *******************************************************************************/
@@ -133,6 +165,7 @@ Std_ReturnType DIO_PinToggle(const DIO_PinConfig *Pin_Config);
 Std_ReturnType DIO_PortDirSetup(DIO_PortIndex Port_Config, uint8 direction);
 Std_ReturnType DIO_PortDirStatus(DIO_PortIndex Port_Status, uint8 *Status);
 Std_ReturnType DIO_PortWrite(const DIO_PortIndex Port_Index, uint8 Logic);
+Std_ReturnType DIO_PortWriteMasked(const DIO_PortIndex Port_Index, uint8 Mask, uint8 Logic);
 Std_ReturnType DIO_PortRead(const DIO_PortIndex Port_Index, uint8 *Logic);
 Std_ReturnType DIO_PortToggle(const DIO_PortIndex Port_Index);
 Std_ReturnType DIO_PortROL(DIO_PortIndex Port, uint8 NUM);
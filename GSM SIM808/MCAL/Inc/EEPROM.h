@@ -0,0 +1,47 @@
+﻿/********************************************************************************************************
+ *  [FILE NAME]   :      <EEPROM.h>                                                                     *
+ *  [AUTHOR]      :      <David S. Alexander>                                                           *
+ *  [DATE CREATED]:      <Oct 18, 2026>                                                                 *
+ *  [Description] :      <Header file for the AVR internal EEPROM driver>                               *
+ ********************************************************************************************************/
+
+#ifndef EEPROM_H_
+#define EEPROM_H_
+
+/*******************************************************************************
+ *                                 Includes                                    *
+ *******************************************************************************/
+
+#include "../../Includes/STD_TYPES.h"
+#include "../../Includes/DEVICE_CONFIG.h"
+#include "../../Includes/BIT_MACROS.h"
+#include "../../Includes/STD_LIBRARIES.h"
+#include "Global_Interrupt.h"
+
+/*******************************************************************************
+ *                             Macro Declarations                              *
+ *******************************************************************************/
+
+/* EEPROM Registers */
+#define EEAR_REG      SFR_IO16(0x1E)   /* EEPROM Address Register */
+#define EEDR_REG      SFR_IO8(0x1D)    /* EEPROM Data Register */
+#define EECR_REG      SFR_IO8(0x1C)    /* EEPROM Control Register */
+
+/* EECR */
+#define EERE_Bit      0
+#define EEWE_Bit      1
+#define EEMWE_Bit     2
+#define EERIE_Bit     3
+
+#define EEPROM_SIZE   4096U            /* ATmega128 */
+
+/*******************************************************************************
+ *                            Functions Declaration                            *
+ *******************************************************************************/
+
+Std_ReturnType EEPROM_ReadByte(uint16 Address, uint8 *Data);
+Std_ReturnType EEPROM_WriteByte(uint16 Address, uint8 Data);
+Std_ReturnType EEPROM_ReadBlock(uint16 Address, uint8 *Data, uint16 Length);
+Std_ReturnType EEPROM_UpdateBlock(uint16 Address, const uint8 *Data, uint16 Length);
+
+#endif /* EEPROM_H_ */
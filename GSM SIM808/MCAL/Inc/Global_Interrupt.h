@@ -23,5 +23,59 @@
 void ENABLE_GIE(void);
 void DISABLE_GIE(void);
 
+/*
+ * Critical sections that nest: the entry returns the SREG it found and the
+ * exit puts it back, so an inner section never turns interrupts on inside an
+ * outer one and a section entered from an ISR leaves them off. Both are
+ * inline with a memory clobber, no shared access moves across them.
+ *
+ *     uint8 State = GIE_EnterCritical();
+ *     ...
+ *     GIE_ExitCritical(State);
+ */
+static inline uint8 GIE_EnterCritical(void)
+{
+	uint8 State = _SREG;
+	cli();
+	return State;
+}
+
+static inline void GIE_ExitCritical(uint8 State)
+{
+	__asm__ __volatile__ ("" ::: "memory");
+	_SREG = State;
+}
+
+/* Multi-byte variables shared with an ISR, the AVR moves them one byte at a time */
+static inline uint16 GIE_AtomicRead16(const volatile uint16 *Var)
+{
+	uint8  State = GIE_EnterCritical();
+	uint16 Value = *Var;
+	GIE_ExitCritical(State);
+	return Value;
+}
+
+static inline void GIE_AtomicWrite16(volatile uint16 *Var, uint16 Value)
+{
+	uint8 State = GIE_EnterCritical();
+	*Var = Value;
+	GIE_ExitCritical(State);
+}
+
+static inline uint32 GIE_AtomicRead32(const volatile uint32 *Var)
+{
+	uint8  State = GIE_EnterCritical();
+	uint32 Value = *Var;
+	GIE_ExitCritical(State);
+	return Value;
+}
+
+static inline void GIE_AtomicWrite32(volatile uint32 *Var, uint32 Value)
+{
+	uint8 State = GIE_EnterCritical();
+	*Var = Value;
+	GIE_ExitCritical(State);
+}
+
 
 #endif /* GLOBAL_INTERRUPT_H_ */
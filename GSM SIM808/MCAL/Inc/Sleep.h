@@ -0,0 +1,76 @@
+﻿/********************************************************************************************************
+ *  [FILE NAME]   :      <Sleep.h>                                                                      *
+ *  [AUTHOR]      :      <David S. Alexander>                                                           *
+ *  [DATE CREATED]:      <Oct 18, 2026>                                                                 *
+ *  [Description] :      <Header file for the AVR sleep modes and the external wake pin>                *
+ ********************************************************************************************************/
+
+#ifndef SLEEP_H_
+#define SLEEP_H_
+
+/*******************************************************************************
+ *                                 Includes                                    *
+ *******************************************************************************/
+
+#include "../../Includes/STD_TYPES.h"
+#include "../../Includes/DEVICE_CONFIG.h"
+#include "../../Includes/BIT_MACROS.h"
+#include "../../Includes/STD_LIBRARIES.h"
+#include "Global_Interrupt.h"
+#include <avr/sleep.h>
+
+/*******************************************************************************
+ *                             Macro Declarations                              *
+ *******************************************************************************/
+
+#define SLEEP_WAKE_INT       4            /* External interrupt 4..7 on PE4..PE7 used as the wake pin */
+
+#define MCUCR_REG     SFR_IO8(0x35)    /* MCU Control Register */
+#define EICRB_REG     SFR_IO8(0x3A)    /* External Interrupt Control Register B, INT7:4 */
+#define EIMSK_REG     SFR_IO8(0x39)    /* External Interrupt Mask Register */
+#define EIFR_REG      SFR_IO8(0x38)    /* External Interrupt Flag Register */
+
+/* MCUCR */
+#define SE_Bit        5
+#define SM1_Bit       4
+#define SM0_Bit       3
+#define SM2_Bit       2
+
+#define SLEEP_MODE_MASK      ((1 << SM2_Bit) | (1 << SM1_Bit) | (1 << SM0_Bit))
+
+/* INT7:4 sense bits are two per pin in EICRB */
+#define SLEEP_WAKE_SHIFT     ((SLEEP_WAKE_INT - 4) * 2)
+
+#define SLEEP_VECT_(N)       INT##N##_vect
+#define SLEEP_VECT(N)        SLEEP_VECT_(N)
+
+/*******************************************************************************
+ *                         Data Types Declaration                              *
+ *******************************************************************************/
+
+typedef enum
+{
+	SLEEP_Idle      = 0,                                       /* CPU stopped, timers, USART and TWI run */
+	SLEEP_PowerSave = (1 << SM1_Bit) | (1 << SM0_Bit)          /* Clocks stopped, only a low level on the wake pin wakes */
+
+} Sleep_Mode_t;
+
+typedef enum
+{
+	SLEEP_LowLevel,
+	SLEEP_AnyEdge,
+	SLEEP_FallingEdge,                                         /* Edges need the I/O clock, not seen in power-save */
+	SLEEP_RisingEdge
+
+} Sleep_Trigger_t;
+
+/*******************************************************************************
+ *                            Functions Declaration                            *
+ *******************************************************************************/
+
+void           Sleep_Enter(Sleep_Mode_t Mode);
+Std_ReturnType Sleep_WakePinEnable(Sleep_Trigger_t Trigger);
+void           Sleep_WakePinDisable(void);
+boolean        Sleep_WakePending(void);
+
+#endif /* SLEEP_H_ */
@@ -0,0 +1,58 @@
+﻿/********************************************************************************************************
+ *  [FILE NAME]   :      <Timer.h>                                                                      *
+ *  [AUTHOR]      :      <David S. Alexander>                                                           *
+ *  [DATE CREATED]:      <Oct 18, 2026>                                                                 *
+ *  [Description] :      <Header file for the AVR Timer1 free-running time base>                        *
+ ********************************************************************************************************/
+
+#ifndef TIMER_H_
+#define TIMER_H_
+
+/*******************************************************************************
+ *                                 Includes                                    *
+ *******************************************************************************/
+
+#include "../../Includes/STD_TYPES.h"
+#include "../../Includes/DEVICE_CONFIG.h"
+#include "../../Includes/BIT_MACROS.h"
+#include "../../Includes/STD_LIBRARIES.h"
+#include "Global_Interrupt.h"
+
+/*******************************************************************************
+ *                             Macro Declarations                              *
+ *******************************************************************************/
+
+/* Timer1 Registers */
+#define TCCR1A_REG    SFR_IO8(0x2F)    /* Timer1 Control Register A */
+#define TCCR1B_REG    SFR_IO8(0x2E)    /* Timer1 Control Register B */
+#define TCNT1_REG     SFR_IO16(0x2C)   /* Timer1 Counter */
+#define OCR1A_REG     SFR_IO16(0x2A)   /* Timer1 Output Compare Register A */
+#define TIMSK_REG     SFR_IO8(0x37)    /* Timer Interrupt Mask Register */
+#define TIFR_REG      SFR_IO8(0x36)    /* Timer Interrupt Flag Register */
+
+/* TCCR1B */
+#define CS10_Bit      0
+#define CS11_Bit      1
+#define CS12_Bit      2
+
+/* TIMSK / TIFR */
+#define TOIE1_Bit     2
+#define TOV1_Bit      2
+#define OCIE1A_Bit    4
+
+#define TIMER_PRESCALER     64UL                              /* 8 us per tick at 8 MHz */
+#define TIMER_TICKS_PER_MS  (F_CPU / TIMER_PRESCALER / 1000UL)
+
+/*******************************************************************************
+ *                            Functions Declaration                            *
+ *******************************************************************************/
+
+/* Overflows of TCNT1, the high half of Timer_GetTicks() */
+extern volatile uint16 Timer_Overflows;
+
+Std_ReturnType Timer_Init(void);
+uint32         Timer_GetTicks(void);
+uint32         Timer_GetMillis(void);
+void           Timer_DelayMs(uint16 Ms);
+
+#endif /* TIMER_H_ */
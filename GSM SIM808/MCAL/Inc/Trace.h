@@ -0,0 +1,89 @@
+﻿/********************************************************************************************************
+ *  [FILE NAME]   :      <Trace.h>                                                                      *
+ *  [AUTHOR]      :      <David S. Alexander>                                                           *
+ *  [DATE CREATED]:      <Oct 18, 2026>                                                                 *
+ *  [Description] :      <Header file for the binary event trace ring>                                  *
+ ********************************************************************************************************/
+
+#ifndef TRACE_H_
+#define TRACE_H_
+
+/*******************************************************************************
+ *                                 Includes                                    *
+ *******************************************************************************/
+
+#include "USART.h"
+#include "Timer.h"
+
+/*******************************************************************************
+ *                             Macro Declarations                              *
+ *******************************************************************************/
+
+#define TRACE_ENABLED        1
+#define TRACE_ISR            0            /* ISR enter/exit events, a traced ISR then saves every register */
+#define TRACE_BUFFER_SIZE    32           /* Events of 4 bytes, power of two <= 256 */
+
+/*
+ * Frame on the debug UART, 6 bytes per event:
+ *   [0] TRACE_SYNC  [1] Id  [2] Arg  [3..4] TCNT1 little endian  [5] XOR of bytes 0..4
+ * Text never contains 0xA5, so frames can share the line with the debug output.
+ * Tools/trace_decode.py turns a capture into a timeline and latency summary.
+ */
+#define TRACE_SYNC           0xA5
+#define TRACE_FRAME_SIZE     6
+
+/* Vector ids for TRACE_ISR_ENTER / TRACE_ISR_EXIT */
+#define TRACE_VECTOR_USART_RX(CH)      ((CH) * 2)
+#define TRACE_VECTOR_USART_UDRE(CH)    ((CH) * 2 + 1)
+
+#if TRACE_ENABLED
+#define TRACE(ID, ARG)                 Trace_Record((ID), (ARG))
+#else
+#define TRACE(ID, ARG)                 do { } while (0)
+#endif
+
+#if TRACE_ENABLED && TRACE_ISR
+#define TRACE_ISR_IN(VECTOR)           Trace_Record(TRACE_ISR_ENTER, (VECTOR))
+#define TRACE_ISR_OUT(VECTOR)          Trace_Record(TRACE_ISR_EXIT, (VECTOR))
+#else
+#define TRACE_ISR_IN(VECTOR)           do { } while (0)
+#define TRACE_ISR_OUT(VECTOR)          do { } while (0)
+#endif
+
+/*******************************************************************************
+ *                         Data Types Declaration                              *
+ *******************************************************************************/
+
+typedef enum
+{
+	TRACE_EPOCH,                 /* Arg: low byte of Timer_Overflows for the events that follow */
+	TRACE_LOST,                  /* Arg: events dropped on a full ring */
+	TRACE_CMD,                   /* Arg: Trace_Hash() of the echoed AT command */
+	TRACE_RESULT,                /* Arg: Trace_Result_t */
+	TRACE_URC,                   /* Arg: URC handler index */
+	TRACE_ISR_ENTER,             /* Arg: TRACE_VECTOR_* */
+	TRACE_ISR_EXIT,
+	TRACE_I2C_START,
+	TRACE_I2C_STOP,              /* Arg: TWSR status when the stop was sent */
+	TRACE_USER = 0x40            /* First id free for the application */
+
+} Trace_Event_t;
+
+typedef enum
+{
+	TRACE_ResultMatch,
+	TRACE_ResultError,
+	TRACE_ResultTimeout
+
+} Trace_Result_t;
+
+/*******************************************************************************
+ *                            Functions Declaration                            *
+ *******************************************************************************/
+
+Std_ReturnType Trace_Init(void);
+void           Trace_Record(uint8 Id, uint8 Arg);
+uint8          Trace_Hash(const uint8 *Str);
+Std_ReturnType Trace_Drain(const USART_Config_t *USART);
+
+#endif /* TRACE_H_ */
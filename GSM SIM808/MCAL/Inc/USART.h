@@ -15,9 +15,21 @@
 #include "../../Includes/BIT_MACROS.h"
 #include "../../Includes/STD_LIBRARIES.h"
 #include "Global_Interrupt.h"
+#include "DIO.h"
+#include "USART_Cfg.h"
 
-#define USART_TX_BUFFER_SIZE 512
-#define USART_RX_BUFFER_SIZE 512
+#define USART_TX_BUFFER_SIZE 128         /* uint8 ring indices, keep it <= 256 */
+#define USART_RX_BUFFER_SIZE 512         /* uint16 ring indices, power of two */
+
+/* Integer UBRR rounded to nearest, usable in #if and at run time (DOUBLE_SPEED is 0 or 1) */
+#define USART_DIVISOR(DOUBLE_SPEED)            ((DOUBLE_SPEED) ? 8UL : 16UL)
+#define USART_UBRR(BAUD, DOUBLE_SPEED)         ((F_CPU + (USART_DIVISOR(DOUBLE_SPEED) * (BAUD)) / 2) / (USART_DIVISOR(DOUBLE_SPEED) * (BAUD)) - 1)
+#define USART_ACTUAL_BAUD(BAUD, DOUBLE_SPEED)  (F_CPU / (USART_DIVISOR(DOUBLE_SPEED) * (USART_UBRR(BAUD, DOUBLE_SPEED) + 1)))
+#define USART_BAUD_ERROR(BAUD, DOUBLE_SPEED)   (((USART_ACTUAL_BAUD(BAUD, DOUBLE_SPEED) > (BAUD)) ? \
+                                                 (USART_ACTUAL_BAUD(BAUD, DOUBLE_SPEED) - (BAUD)) : \
+                                                 ((BAUD) - USART_ACTUAL_BAUD(BAUD, DOUBLE_SPEED))) * 1000UL / (BAUD))   /* Per mille */
+#define USART_UBRR_MAX                         4095
+#define USART_BAUD_ERROR_NONE                  0xFFFF      /* Rate not reachable with this F_CPU */
 
 
 #define UCSR0A_REG     SFR_IO8(0x0B)
@@ -37,6 +49,21 @@
 #define UDR0_REG       SFR_IO8(0x0C)
 #define UDR1_REG       SFR_MEM8(0x9C)
 
+/* Per-channel names picked up by USART_Channel.h */
+#define USART0_UCSRA   UCSR0A_REG
+#define USART0_UCSRB   UCSR0B_REG
+#define USART0_UCSRC   UCSR0C_REG
+#define USART0_UBRRL   UBRR0L_REG
+#define USART0_UBRRH   UBRR0H_REG
+#define USART0_UDR     UDR0_REG
+
+#define USART1_UCSRA   UCSR1A_REG
+#define USART1_UCSRB   UCSR1B_REG
+#define USART1_UCSRC   UCSR1C_REG
+#define USART1_UBRRL   UBRR1L_REG
+#define USART1_UBRRH   UBRR1H_REG
+#define USART1_UDR     UDR1_REG
+
 
 /* UCSR0A */
 #define RXC0_BIT       7
@@ -98,12 +125,20 @@
 #define UCSZ10_BIT     1
 #define UCPOL1_BIT     0
 
-#define USART_CHANNELS 2
+#define USART_PHYSICAL_CHANNELS 2
+#define USART_CHANNELS          (USART_PHYSICAL_CHANNELS + USART_VIRTUAL_CHANNELS)
+
+#if USART_VIRTUAL_CHANNELS > 3
+#error "USART_VIRTUAL_CHANNELS is limited to 3"
+#endif
 
 typedef enum
 {
 	USART_CHANNEL0,
 	USART_CHANNEL1,
+	USART_CHANNEL_VIRTUAL0,              /* Byte paths go through the registered USART_VirtualDriver_t */
+	USART_CHANNEL_VIRTUAL1,
+	USART_CHANNEL_VIRTUAL2,
 
 }USART_Channel_t;
 
@@ -182,6 +217,28 @@ typedef enum
 	
 }USART_StringStatus_t;
 
+/* What a channel's RX ISR does with a received byte */
+typedef enum
+{
+	USART_BridgeOff,                     /* Queued in this channel's RX ring */
+	USART_BridgeForward,                 /* Queued in the other channel's TX ring only */
+	USART_BridgeTap                      /* Both, the lines still reach the driver */
+	
+}USART_Bridge_t;
+
+/* Byte paths of the virtual channels, Channel is 0 for USART_CHANNEL_VIRTUAL0 */
+typedef struct
+{
+	Std_ReturnType (*Transmit_Byte)(uint8 Channel, uint8 data);
+	Std_ReturnType (*Receive_Byte)(uint8 Channel, uint8* data);
+	uint8          (*TransmitSpace)(uint8 Channel);
+	void           (*Flush)(uint8 Channel);
+	
+}USART_VirtualDriver_t;
+
+/* Runs before each string write on its channel, e.g. to wake the far end */
+typedef void (*USART_TransmitHook_t)(void);
+
 typedef struct
 {
 	USART_BuadRates_t				     USART_BaudRate;
@@ -197,13 +254,54 @@ typedef struct
 	
 }USART_Config_t;
 
+/* Per-channel counters since USART_Init() or the last USART_ResetStats() */
+typedef struct
+{
+	uint32                               USART_BytesIn;
+	uint32                               USART_BytesOut;
+	uint16                               USART_FrameErrors;      /* FE, wrong baud rate or noise */
+	uint16                               USART_Overruns;         /* DOR, bytes lost before the ISR ran */
+	uint16                               USART_ParityErrors;     /* UPE */
+	uint16                               USART_Dropped;          /* Received while the RX ring was full */
+	uint16                               USART_RXHighWater;      /* Peak RX ring use in bytes */
+	uint8                                USART_TXHighWater;      /* Peak TX ring use in bytes */
+	
+}USART_Stats_t;
+
 Std_ReturnType USART_Init(const USART_Config_t* USARTcfg);
 Std_ReturnType USART_Transmit_Byte(const USART_Config_t* USARTcfg, uint8 data);
 Std_ReturnType USART_Receive_Byte(const USART_Config_t* USARTcfg, uint8* data);
 Std_ReturnType USART_Transmit_String(const USART_Config_t* USARTcfg, const uint8* data);
+Std_ReturnType USART_Transmit_String_P(const USART_Config_t* USARTcfg, const char* data);
 Std_ReturnType USART_Receive_String(const USART_Config_t* USARTcfg, uint8* data);
 Std_ReturnType USART_Flush(const USART_Config_t* USARTcfg);
+uint8          USART_TransmitSpace(const USART_Config_t* USARTcfg);
 Std_ReturnType USART_StringReady(const USART_Config_t* USARTcfg, USART_StringStatus_t* status);
 
+/* Run-time rate changes, U2X is picked automatically */
+uint16         USART_BaudRateError(uint32 BaudRate, uint8* DoubleSpeed);
+Std_ReturnType USART_SetBaudRate(const USART_Config_t* USARTcfg, uint32 BaudRate);
+uint32         USART_GetBaudRate(const USART_Config_t* USARTcfg);
+boolean        USART_FlowControlEnabled(const USART_Config_t* USARTcfg);
+Std_ReturnType USART_SetBridge(const USART_Config_t* USARTcfg, USART_Bridge_t Mode);
+Std_ReturnType USART_SetVirtualDriver(const USART_VirtualDriver_t* Driver);
+Std_ReturnType USART_SetTransmitHook(const USART_Config_t* USARTcfg, USART_TransmitHook_t Hook);
+
+Std_ReturnType USART_GetStats(const USART_Config_t* USARTcfg, USART_Stats_t* Stats);
+Std_ReturnType USART_ResetStats(const USART_Config_t* USARTcfg);
+
+/* Direct per-channel byte paths, no config lookup */
+#if USART0_ENABLED
+Std_ReturnType USART0_Transmit_Byte(uint8 data);
+Std_ReturnType USART0_Receive_Byte(uint8* data);
+uint8          USART0_TransmitSpace(void);
+#endif
+
+#if USART1_ENABLED
+Std_ReturnType USART1_Transmit_Byte(uint8 data);
+Std_ReturnType USART1_Receive_Byte(uint8* data);
+uint8          USART1_TransmitSpace(void);
+#endif
+
 
 #endif /* USART_H_ */
\ No newline at end of file
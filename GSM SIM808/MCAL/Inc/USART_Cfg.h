@@ -0,0 +1,49 @@
+﻿
+/********************************************************************************************************
+*  [FILE NAME]   :      <USART_Cfg.h>                                                                   *
+*  [AUTHOR]      :      <David S. Alexander>                                                            *
+*  [DATE CREATED]:      <Oct 18, 2026>                                                                  *
+*  [Description] :      <Static per-channel configuration of the AVR ATmega 128 USART driver>           *
+*********************************************************************************************************/
+
+
+#ifndef USART_CFG_H_
+#define USART_CFG_H_
+
+/*
+ * Each enabled channel gets its own buffers, functions and ISRs generated from
+ * USART_Channel.h, so the mode and the default baud rate are fixed here and the
+ * baud rate error is checked by the preprocessor against F_CPU.
+ */
+
+#define USART_BAUD_ERROR_WARN      10          /* Per mille, #warning above 1.0 % */
+#define USART_BAUD_ERROR_MAX       20          /* Per mille, #error above 2.0 % (datasheet receiver limit, 8 data bits) */
+
+/* Channel 0 : SIM808 modem */
+#define USART0_ENABLED             1
+#define USART0_BAUD                38400UL     /* Exact to 0.2 % at 8 MHz, 115200 is 3.5 % off */
+#define USART0_DOUBLE_SPEED        1           /* 1: U2X, divisor 8 */
+#define USART0_INTERRUPT           1           /* 1: ring buffers and ISRs, 0: polled */
+#define USART0_FLOW_CONTROL        0           /* 1: RTS/CTS on the DIO pins below, needs USART0_INTERRUPT */
+#define USART0_RTS_PIN             DIO_PIN_ID(E, 2)   /* Output, low while the RX ring has room */
+#define USART0_CTS_PIN             DIO_PIN_ID(E, 3)   /* Input, the modem holds it low while it accepts data */
+
+/* Channel 1 : Debug terminal */
+#define USART1_ENABLED             1
+#define USART1_BAUD                38400UL
+#define USART1_DOUBLE_SPEED        1
+#define USART1_INTERRUPT           1
+#define USART1_FLOW_CONTROL        0
+
+#define USART_STATS                1           /* Error and traffic counters, see USART_GetStats() */
+#define USART_BRIDGE               1           /* RX ISR forwarding to the other channel, see USART_SetBridge(), needs both channels interrupt driven */
+#define USART_VIRTUAL_CHANNELS     3           /* 0..3 channels served by a protocol driver such as CMUX, see USART_SetVirtualDriver() */
+
+#define USART_DRAIN_TIMEOUT_MS     500         /* Longest wait for the TX ring to drain before a baud change, CTS may hold it */
+
+/* RTS thresholds in bytes of the RX ring, the gap above the high-water mark absorbs the modem's reaction time */
+#define USART_RTS_HIGH_WATER       (USART_RX_BUFFER_SIZE - 64)
+#define USART_RTS_LOW_WATER        (USART_RX_BUFFER_SIZE / 4)
+
+
+#endif /* USART_CFG_H_ */
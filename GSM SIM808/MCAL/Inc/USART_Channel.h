@@ -0,0 +1,375 @@
+﻿
+/********************************************************************************************************
+*  [FILE NAME]   :      <USART_Channel.h>                                                               *
+*  [AUTHOR]      :      <David S. Alexander>                                                            *
+*  [DATE CREATED]:      <Oct 18, 2026>                                                                  *
+*  [Description] :      <Per-channel template of the AVR ATmega 128 USART driver>                       *
+*********************************************************************************************************/
+
+/*
+ * Not a regular header: USART.c includes it once per enabled channel with
+ * USART_CH defined to the channel number. Every pass emits that channel's
+ * rings, functions and ISRs with the registers and the mode resolved at
+ * compile time, so the byte paths never index a table or read the config.
+ */
+
+#define CH_UCSRA               USART_CH_SYM(UCSRA)
+#define CH_UCSRB               USART_CH_SYM(UCSRB)
+#define CH_UCSRC               USART_CH_SYM(UCSRC)
+#define CH_UBRRL               USART_CH_SYM(UBRRL)
+#define CH_UBRRH               USART_CH_SYM(UBRRH)
+#define CH_UDR                 USART_CH_SYM(UDR)
+
+#define CH_BAUD                USART_CH_SYM(BAUD)
+#define CH_DOUBLE_SPEED        USART_CH_SYM(DOUBLE_SPEED)
+#define CH_INTERRUPT           USART_CH_SYM(INTERRUPT)
+#define CH_FLOW_CONTROL        USART_CH_SYM(FLOW_CONTROL)
+
+#define CH_RX_BUFFER           USART_CH_SYM(RX_Buffer)
+#define CH_RX_HEAD             USART_CH_SYM(RX_Head)
+#define CH_RX_TAIL             USART_CH_SYM(RX_Tail)
+#define CH_TX_BUFFER           USART_CH_SYM(TX_Buffer)
+#define CH_TX_HEAD             USART_CH_SYM(TX_Head)
+#define CH_TX_TAIL             USART_CH_SYM(TX_Tail)
+#define CH_RTS                 USART_CH_SYM(RTS_PIN)
+#define CH_CTS                 USART_CH_SYM(CTS_PIN)
+#define CH_RTS_PAUSED          USART_CH_SYM(RTS_Paused)
+#define CH_STATS               USART_CH_SYM(Stats)
+#define CH_BRIDGE              USART_CH_SYM(Bridge)
+#define CH_PEER_TRANSMIT       USART_SYM(USART_PEER, _Transmit_Byte)
+
+#if USART_BRIDGE
+#define CH_BRIDGE_KEEPS()      (CH_BRIDGE != USART_BridgeForward)
+#else
+#define CH_BRIDGE_KEEPS()      (1)
+#endif
+
+#define CH_RX_USED()           ((uint16)(CH_RX_HEAD - CH_RX_TAIL) & (USART_RX_BUFFER_SIZE - 1))
+
+#if USART_BAUD_ERROR(CH_BAUD, CH_DOUBLE_SPEED) > USART_BAUD_ERROR_MAX
+#error "USART baud rate error above USART_BAUD_ERROR_MAX for this F_CPU, pick another rate or crystal"
+#elif USART_BAUD_ERROR(CH_BAUD, CH_DOUBLE_SPEED) > USART_BAUD_ERROR_WARN
+#warning "USART baud rate error above USART_BAUD_ERROR_WARN for this F_CPU, the link is marginal"
+#endif
+
+#if CH_INTERRUPT
+static uint8           CH_RX_BUFFER[USART_RX_BUFFER_SIZE];
+static volatile uint16 CH_RX_HEAD;
+static volatile uint16 CH_RX_TAIL;
+
+static uint8           CH_TX_BUFFER[USART_TX_BUFFER_SIZE];
+static volatile uint8  CH_TX_HEAD;
+static volatile uint8  CH_TX_TAIL;
+#endif
+
+#if CH_FLOW_CONTROL
+#if !CH_INTERRUPT
+#error "USART flow control needs the interrupt driven channel"
+#endif
+static volatile boolean    CH_RTS_PAUSED;
+#endif
+
+#if USART_BRIDGE
+static volatile uint8 CH_BRIDGE = USART_BridgeOff;
+#endif
+
+#if USART_STATS
+static USART_Stats_t CH_STATS;
+
+#define CH_STAT_INC(FIELD)          (CH_STATS.FIELD++)
+#define CH_STAT_MAX(FIELD, VALUE)   do { if ((VALUE) > CH_STATS.FIELD) { CH_STATS.FIELD = (VALUE); } } while (0)
+#define CH_STAT_ERRORS(STATUS)      do { if (BIT_IS_SET(STATUS, FE0_BIT))  { CH_STAT_INC(USART_FrameErrors); }  \
+                                         if (BIT_IS_SET(STATUS, DOR0_BIT)) { CH_STAT_INC(USART_Overruns); }     \
+                                         if (BIT_IS_SET(STATUS, UPE0_BIT)) { CH_STAT_INC(USART_ParityErrors); } } while (0)
+#else
+#define CH_STAT_INC(FIELD)          do { } while (0)
+#define CH_STAT_MAX(FIELD, VALUE)   do { } while (0)
+#define CH_STAT_ERRORS(STATUS)      ((void)(STATUS))
+#endif
+
+/* Bit positions are the same on both channels, the channel 0 names are used */
+static Std_ReturnType USART_CH_SYM(Init)(const USART_Config_t* USARTcfg, uint8 UCSRA_Init, uint8 UCSRC_Init)
+{
+	uint16 UBRR_Init = USART_UBRR(CH_BAUD, CH_DOUBLE_SPEED);       /* Folded by the compiler */
+	uint8  UCSRB_Init = (1 << RXEN0_BIT) | (1 << TXEN0_BIT);
+	uint8  DoubleSpeed = BIT_IS_SET(UCSRA_Init, U2X0_BIT) ? 1 : 0;
+
+	if (USARTcfg->USART_InterruptStatus != (CH_INTERRUPT ? USART_InterruptEnabled : USART_InterruptDisabled))
+	{
+		return E_NOT_OK;                                               /* Channel was generated for the other mode */
+	}
+
+	/* Only a rate other than the static one pays for the division */
+	if ((uint32)USARTcfg->USART_BaudRate != CH_BAUD || DoubleSpeed != CH_DOUBLE_SPEED)
+	{
+		if (USART_ComputeUBRR((uint32)USARTcfg->USART_BaudRate, DoubleSpeed, &UBRR_Init) != E_OK)
+		{
+			return E_NOT_OK;
+		}
+	}
+
+#if CH_INTERRUPT
+	UCSRB_Init |= (1 << RXCIE0_BIT);                                   /* UDRIE is set when bytes are queued */
+#endif
+
+#if CH_FLOW_CONTROL
+	DIO_FAST_LOW(CH_RTS);                                              /* RTS low, ready to receive */
+	DIO_FAST_OUTPUT(CH_RTS);
+	DIO_FAST_INPUT(CH_CTS);
+	DIO_FAST_HIGH(CH_CTS);                                             /* CTS with the internal pull-up */
+	CH_RTS_PAUSED = FALSE;
+#endif
+
+	CH_UBRRH = (uint8)(UBRR_Init >> 8);
+	CH_UBRRL = (uint8)(UBRR_Init);
+
+	CH_UCSRA = UCSRA_Init;
+	CH_UCSRB = UCSRB_Init;
+	CH_UCSRC = UCSRC_Init;
+
+	return E_OK;
+}
+
+Std_ReturnType USART_CH_SYM(Transmit_Byte)(uint8 data)
+{
+	Std_ReturnType ret = E_OK;
+#if CH_INTERRUPT
+#if USART_BRIDGE
+	uint8 State = GIE_EnterCritical();          /* The peer RX ISR queues here too */
+#endif
+	uint8 Next = (uint8)(CH_TX_HEAD + 1) % USART_TX_BUFFER_SIZE;
+
+	if (Next != CH_TX_TAIL)
+	{
+		CH_TX_BUFFER[CH_TX_HEAD] = data;
+		CH_TX_HEAD = Next;
+		SET_BIT(CH_UCSRB, UDRIE0_BIT);
+		CH_STAT_MAX(USART_TXHighWater, (uint8)(Next - CH_TX_TAIL) % USART_TX_BUFFER_SIZE);
+	}
+	else
+	{
+		SET_BIT(CH_UCSRB, UDRIE0_BIT);          /* Full ring is never empty, re-arm in case a CTS pause cleared it */
+		ret = E_NOT_OK;                         /* TX ring full, caller may retry */
+	}
+#if USART_BRIDGE
+	GIE_ExitCritical(State);
+#endif
+#else
+	while (BIT_IS_CLEAR(CH_UCSRA, UDRE0_BIT));
+	CH_UDR = data;
+	CH_STAT_INC(USART_BytesOut);
+#endif
+	return ret;
+}
+
+Std_ReturnType USART_CH_SYM(Receive_Byte)(uint8* data)
+{
+	Std_ReturnType ret = E_OK;
+#if CH_INTERRUPT
+	/* The 16-bit ring indices are shared with the RX ISR, touch them with interrupts off */
+	uint8 State = GIE_EnterCritical();
+	if (CH_RX_HEAD != CH_RX_TAIL)
+	{
+		*data = CH_RX_BUFFER[CH_RX_TAIL];
+		CH_RX_TAIL = (CH_RX_TAIL + 1) % USART_RX_BUFFER_SIZE;
+		RX_DataIsReady[USART_CH] = TRUE;
+	}
+	else ret = E_NOT_OK;                        /* RX ring empty */
+#if CH_FLOW_CONTROL
+	if (CH_RTS_PAUSED == TRUE && CH_RX_USED() <= USART_RTS_LOW_WATER)
+	{
+		DIO_FAST_LOW(CH_RTS);                   /* Drained enough, let the modem talk again */
+		CH_RTS_PAUSED = FALSE;
+	}
+	if (CH_TX_HEAD != CH_TX_TAIL)
+	{
+		SET_BIT(CH_UCSRB, UDRIE0_BIT);          /* Resume a transmission stopped by CTS */
+	}
+#endif
+	GIE_ExitCritical(State);
+#else
+	uint8 Status = 0;
+
+	while (BIT_IS_CLEAR(CH_UCSRA, RXC0_BIT));
+	Status = CH_UCSRA;                          /* Error flags belong to the byte in UDR, read them first */
+	*data = CH_UDR;
+	RX_DataIsReady[USART_CH] = TRUE;
+	CH_STAT_INC(USART_BytesIn);
+	CH_STAT_ERRORS(Status);
+#endif
+	return ret;
+}
+
+uint8 USART_CH_SYM(TransmitSpace)(void)
+{
+#if CH_INTERRUPT
+	return (uint8)(CH_TX_TAIL - CH_TX_HEAD - 1) % USART_TX_BUFFER_SIZE;
+#else
+	return 0xFF;                                /* Polled writes always go through */
+#endif
+}
+
+static void USART_CH_SYM(Flush)(void)
+{
+#if CH_INTERRUPT
+	uint8 State = GIE_EnterCritical();
+	CH_RX_TAIL = CH_RX_HEAD;                    /* Drop whatever the ISR already queued */
+#if CH_FLOW_CONTROL
+	DIO_FAST_LOW(CH_RTS);
+	CH_RTS_PAUSED = FALSE;
+#endif
+	GIE_ExitCritical(State);
+#else
+	while (BIT_IS_SET(CH_UCSRA, RXC0_BIT))
+	{
+		(void)CH_UDR;
+	}
+#endif
+}
+
+#if USART_STATS
+static void USART_CH_SYM(GetStats)(USART_Stats_t* Stats, boolean Reset)
+{
+	uint8 State = GIE_EnterCritical();          /* The ISRs update the counters */
+	if (NULL != Stats)
+	{
+		*Stats = CH_STATS;
+	}
+	if (Reset == TRUE)
+	{
+		memset(&CH_STATS, 0, sizeof(CH_STATS));
+	}
+	GIE_ExitCritical(State);
+}
+#endif
+
+/* Needs interrupts enabled in interrupt mode, the queued bytes leave at the old rate first */
+static Std_ReturnType USART_CH_SYM(SetUBRR)(uint16 UBRR, uint8 DoubleSpeed)
+{
+	uint32 Start = Timer_GetMillis();
+#if CH_INTERRUPT
+	while (CH_TX_HEAD != CH_TX_TAIL)
+	{
+		SET_BIT(CH_UCSRB, UDRIE0_BIT);          /* A CTS pause may have parked the ring */
+		if ((uint32)(Timer_GetMillis() - Start) >= USART_DRAIN_TIMEOUT_MS)
+		{
+			return E_NOT_OK;                    /* Peer holds CTS, keep the old rate */
+		}
+	}
+#endif
+	while (BIT_IS_CLEAR(CH_UCSRA, UDRE0_BIT))
+	{
+		if ((uint32)(Timer_GetMillis() - Start) >= USART_DRAIN_TIMEOUT_MS)
+		{
+			return E_NOT_OK;
+		}
+	}
+
+	CH_UBRRH = (uint8)(UBRR >> 8);
+	CH_UBRRL = (uint8)(UBRR);
+
+	if (DoubleSpeed)
+	{
+		SET_BIT(CH_UCSRA, U2X0_BIT);
+	}
+	else
+	{
+		CLEAR_BIT(CH_UCSRA, U2X0_BIT);
+	}
+
+	return E_OK;
+}
+
+#if CH_INTERRUPT
+ISR(USART_CH_SYM(RX_vect))
+{
+	uint8  Status = CH_UCSRA;                   /* Error flags belong to the byte in UDR, read them first */
+	uint8  Data = CH_UDR;                       /* Always read, a full ring must not keep RXC set */
+	uint16 Next = (CH_RX_HEAD + 1) % USART_RX_BUFFER_SIZE;
+
+	TRACE_ISR_IN(TRACE_VECTOR_USART_RX(USART_CH));
+	CH_STAT_INC(USART_BytesIn);
+	CH_STAT_ERRORS(Status);
+
+#if USART_BRIDGE
+	if (CH_BRIDGE != USART_BridgeOff && CH_PEER_TRANSMIT(Data) != E_OK)
+	{
+		CH_STAT_INC(USART_Dropped);             /* Peer TX ring full */
+	}
+#endif
+	if (CH_BRIDGE_KEEPS())
+	{
+		if (Next != CH_RX_TAIL)
+		{
+			CH_RX_BUFFER[CH_RX_HEAD] = Data;
+			CH_RX_HEAD = Next;
+			CH_STAT_MAX(USART_RXHighWater, CH_RX_USED());
+		}
+		else
+		{
+			CH_STAT_INC(USART_Dropped);
+		}
+	}
+	TRACE_ISR_OUT(TRACE_VECTOR_USART_RX(USART_CH));
+#if CH_FLOW_CONTROL
+	if (CH_RTS_PAUSED == FALSE && CH_RX_USED() >= USART_RTS_HIGH_WATER)
+	{
+		DIO_FAST_HIGH(CH_RTS);                  /* Ask the modem to hold off before the ring fills */
+		CH_RTS_PAUSED = TRUE;
+	}
+#endif
+}
+
+ISR(USART_CH_SYM(UDRE_vect))
+{
+#if CH_FLOW_CONTROL
+	if (DIO_FAST_IS_HIGH(CH_CTS))
+	{
+		CLEAR_BIT(CH_UCSRB, UDRIE0_BIT);        /* Re-armed by the next Transmit_Byte, Receive_Byte or SetUBRR */
+		return;
+	}
+#endif
+	TRACE_ISR_IN(TRACE_VECTOR_USART_UDRE(USART_CH));
+	if (CH_TX_HEAD != CH_TX_TAIL)
+	{
+		CH_UDR = CH_TX_BUFFER[CH_TX_TAIL];
+		CH_TX_TAIL = (uint8)(CH_TX_TAIL + 1) % USART_TX_BUFFER_SIZE;
+		CH_STAT_INC(USART_BytesOut);
+	}
+
+	/* Only disable the interrupt if the buffer is empty */
+	if (CH_TX_HEAD == CH_TX_TAIL)
+	{
+		CLEAR_BIT(CH_UCSRB, UDRIE0_BIT);
+	}
+	TRACE_ISR_OUT(TRACE_VECTOR_USART_UDRE(USART_CH));
+}
+#endif
+
+#undef CH_UCSRA
+#undef CH_UCSRB
+#undef CH_UCSRC
+#undef CH_UBRRL
+#undef CH_UBRRH
+#undef CH_UDR
+#undef CH_BAUD
+#undef CH_DOUBLE_SPEED
+#undef CH_INTERRUPT
+#undef CH_FLOW_CONTROL
+#undef CH_RX_BUFFER
+#undef CH_RX_HEAD
+#undef CH_RX_TAIL
+#undef CH_TX_BUFFER
+#undef CH_TX_HEAD
+#undef CH_TX_TAIL
+#undef CH_RTS
+#undef CH_CTS
+#undef CH_RTS_PAUSED
+#undef CH_RX_USED
+#undef CH_STATS
+#undef CH_BRIDGE
+#undef CH_PEER_TRANSMIT
+#undef CH_BRIDGE_KEEPS
+#undef CH_STAT_INC
+#undef CH_STAT_MAX
+#undef CH_STAT_ERRORS
@@ -0,0 +1,79 @@
+﻿/********************************************************************************************************
+ *  [FILE NAME]   :      <Watchdog.h>                                                                   *
+ *  [AUTHOR]      :      <David S. Alexander>                                                           *
+ *  [DATE CREATED]:      <Oct 18, 2026>                                                                 *
+ *  [Description] :      <Header file for the AVR watchdog timer and the reset cause>                   *
+ ********************************************************************************************************/
+
+#ifndef WATCHDOG_H_
+#define WATCHDOG_H_
+
+/*******************************************************************************
+ *                                 Includes                                    *
+ *******************************************************************************/
+
+#include "../../Includes/STD_TYPES.h"
+#include "../../Includes/DEVICE_CONFIG.h"
+#include "../../Includes/BIT_MACROS.h"
+#include "../../Includes/STD_LIBRARIES.h"
+#include "Global_Interrupt.h"
+
+/*******************************************************************************
+ *                             Macro Declarations                              *
+ *******************************************************************************/
+
+#define WDTCR_REG     SFR_IO8(0x21)    /* Watchdog Timer Control Register */
+#define MCUCSR_REG    SFR_IO8(0x34)    /* MCU Control and Status Register, reset flags */
+
+/* WDTCR */
+#define WDCE_Bit      4
+#define WDE_Bit       3
+
+/* MCUCSR */
+#define WDRF_Bit      3
+#define BORF_Bit      2
+#define EXTRF_Bit     1
+#define PORF_Bit      0
+
+#define WATCHDOG_RESET_FLAGS  ((1 << WDRF_Bit) | (1 << BORF_Bit) | (1 << EXTRF_Bit) | (1 << PORF_Bit))
+
+/* Resets the watchdog count, a single wdr */
+#define Watchdog_Kick()       __asm__ __volatile__ ("wdr")
+
+/*******************************************************************************
+ *                         Data Types Declaration                              *
+ *******************************************************************************/
+
+/* WDP2:0, periods of the 1 MHz watchdog oscillator at 5 V (longer at 3 V) */
+typedef enum
+{
+	WATCHDOG_16MS,
+	WATCHDOG_32MS,
+	WATCHDOG_65MS,
+	WATCHDOG_130MS,
+	WATCHDOG_260MS,
+	WATCHDOG_520MS,
+	WATCHDOG_1S,
+	WATCHDOG_2S
+
+} Watchdog_Period_t;
+
+typedef enum
+{
+	WATCHDOG_ResetPowerOn  = (1 << PORF_Bit),
+	WATCHDOG_ResetExternal = (1 << EXTRF_Bit),
+	WATCHDOG_ResetBrownOut = (1 << BORF_Bit),
+	WATCHDOG_ResetWatchdog = (1 << WDRF_Bit)
+
+} Watchdog_ResetCause_t;
+
+/*******************************************************************************
+ *                            Functions Declaration                            *
+ *******************************************************************************/
+
+Std_ReturnType Watchdog_Enable(Watchdog_Period_t Period);
+void           Watchdog_Disable(void);
+boolean        Watchdog_Enabled(void);
+uint8          Watchdog_ResetCause(void);
+
+#endif /* WATCHDOG_H_ */
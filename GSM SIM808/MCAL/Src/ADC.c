@@ -7,7 +7,25 @@
 
 #include "../Inc/ADC.h"
 
-static uint8 ADC_Complete = FALSE;
+static volatile uint8  ADC_Complete = FALSE;
+static volatile uint16 ADC_Last;
+
+/* Scanner state, the ISR fills ADC_ScanTable[ADC_ScanFront ^ 1] while readers use ADC_ScanFront */
+static ADC_Index       ADC_ScanChannels[ADC_SCAN_MAX_CHANNELS];
+static volatile uint16 ADC_ScanTable[2][ADC_SCAN_MAX_CHANNELS];
+static volatile uint8  ADC_ScanFront = 0;
+static volatile uint8  ADC_ScanRounds = 0;
+static volatile uint8  ADC_Scanning = FALSE;
+static volatile uint8  ADC_ScanReady = FALSE;
+static volatile uint8  ADC_ScanBusy = FALSE;
+static ADC_ScanMode    ADC_ScanPacing = ADC_ScanContinuous;
+static uint8           ADC_ScanCount = 0;
+static uint8           ADC_ScanSlot = 0;
+static uint8           ADC_ScanSamples = 0;
+static uint8           ADC_ScanDiscard = 0;
+static uint16          ADC_ScanSum = 0;
+static uint8           ADC_ScanSavedIE = 0;
+
 /**
 * @brief Configures the ADMUX register with the specified ADC settings.
 * @param ADC_Config A pointer to an ADC_Channel struct containing the desired ADC settings.
@@ -147,36 +165,244 @@ Std_ReturnType ADC_Read(ADC_Index ADC_Ch, uint16 *ADC_Result)
 	{
 		return E_NOT_OK;
 	}
+
+	/* The scanner owns the multiplexer, serve the channel from its table at 10 bit */
+	if (ADC_Scanning == TRUE)
+	{
+		for (uint8 Slot = 0; Slot < ADC_ScanCount; Slot++)
+		{
+			if (ADC_ScanChannels[Slot] == ADC_Ch && ADC_ScanGet(Slot, ADC_Result) == E_OK)
+			{
+				*ADC_Result >>= ADC_SCAN_OVERSAMPLE_BITS;
+				return E_OK;
+			}
+		}
+		return E_NOT_OK;
+	}
+
 	ADMUX_REG = (ADMUX_REG & 0xF0) | ((uint8)ADC_Ch & 0x0F);
-	//ADMUX_REG |= (uint8)ADC_Ch;
-	
+	ADC_Complete = FALSE;
+
 	/* Start ADC conversion */
 	SET_BIT(ADCSRA_REG, ADSC_Bit);                       // Set ADSC bit
 
 	if (BIT_IS_CLEAR(ADCSRA_REG, ADIE_Bit))              // ADC Interrupt Disabled
 	{
 		/* Wait for conversion to complete */
-		while (BIT_IS_SET(ADCSRA_REG, ADSC_Bit));        
-		
-		/* Read ADC result */
-		*ADC_Result = ADCL_REG | (ADCH_REG << 8);
+		while (BIT_IS_SET(ADCSRA_REG, ADSC_Bit));
+
+		/* Read ADC result, the 16 bit access reads ADCL before ADCH */
+		*ADC_Result = ADC_REG;
 	}
-	
 	else
 	{
-		if (ADC_Complete == TRUE)
+		/* Wait for the ISR to latch the result of this conversion */
+		while (ADC_Complete == FALSE);
+
+		*ADC_Result = GIE_AtomicRead16(&ADC_Last);
+	}
+
+	return E_OK;
+}
+
+/**
+* @brief Starts sequencing a list of channels from the ADC interrupt.
+*        Every channel is converted ADC_SCAN_SAMPLES times and decimated to ADC_SCAN_RESOLUTION bits,
+*        the first ADC_SCAN_DISCARD conversions after a mux change are dropped to let the S/H settle.
+*        A round is published at once when its last channel completes.
+* @param Channels The channels to scan, slot N of the results belongs to Channels[N].
+* @param Count The number of channels, 1..ADC_SCAN_MAX_CHANNELS.
+* @param Mode ADC_ScanContinuous chains rounds, ADC_ScanOnDemand runs the first round and then waits for ADC_ScanTrigger().
+* @return The status of the function.
+*     - E_OK: The function executed successfully.
+*     - E_NOT_OK: The ADC is not initialized or the list is invalid.
+*/
+Std_ReturnType ADC_ScanStart(const ADC_Index *Channels, uint8 Count, ADC_ScanMode Mode)
+{
+	Std_ReturnType ret = E_OK;
+
+	if (NULL == Channels || Count == 0 || Count > ADC_SCAN_MAX_CHANNELS || BIT_IS_CLEAR(ADCSRA_REG, ADEN_Bit) ||
+	Mode > ADC_ScanOnDemand)
+	{
+		ret = E_NOT_OK;
+	}
+	else
+	{
+		for (uint8 Slot = 0; Slot < Count; Slot++)
 		{
-			/* Read ADC result */
-			*ADC_Result = ADCL_REG | (ADCH_REG << 8);
-			ADC_Complete = FALSE;
-			/* clear ADIF bit */
-			SET_BIT(ADCSRA_REG, ADIF_Bit);
+			if (Channels[Slot] > ADC_CHANNEL7)
+			{
+				ret = E_NOT_OK;
+			}
 		}
 	}
 
+	if (ret == E_OK)
+	{
+		ADC_ScanStop();
+		memcpy(ADC_ScanChannels, Channels, Count * sizeof(ADC_Index));
+
+		ADC_ScanCount = Count;
+		ADC_ScanPacing = Mode;
+		ADC_ScanSlot = 0;
+		ADC_ScanSamples = 0;
+		ADC_ScanSum = 0;
+		ADC_ScanDiscard = ADC_SCAN_DISCARD;
+		ADC_ScanReady = FALSE;
+		ADC_ScanBusy = TRUE;
+		ADC_ScanSavedIE = BIT_IS_SET(ADCSRA_REG, ADIE_Bit);
+
+		/* Sums need right adjusted samples */
+		ADMUX_REG = (ADMUX_REG & 0xC0) | (uint8)Channels[0];
+
+		ADC_Scanning = TRUE;
+		SET_BIT(ADCSRA_REG, ADIF_Bit);                   // Drop a stale completion
+		SET_BIT(ADCSRA_REG, ADIE_Bit);
+		ENABLE_GIE();
+		SET_BIT(ADCSRA_REG, ADSC_Bit);                   // The ISR chains every following conversion
+	}
+
+	return ret;
+}
+
+/**
+* @brief Starts the next round in ADC_ScanOnDemand mode, e.g. from a periodic task.
+* @return The status of the function.
+*     - E_OK: The round was started.
+*     - E_NOT_OK: The scanner is stopped or the previous round is still running.
+*/
+Std_ReturnType ADC_ScanTrigger(void)
+{
+	Std_ReturnType ret = E_NOT_OK;
+	uint8 State = GIE_EnterCritical();
+
+	if (ADC_Scanning == TRUE && ADC_ScanBusy == FALSE)
+	{
+		ADC_ScanBusy = TRUE;
+		ADC_ScanDiscard = ADC_SCAN_DISCARD;
+		SET_BIT(ADCSRA_REG, ADSC_Bit);
+		ret = E_OK;
+	}
+	GIE_ExitCritical(State);
+
+	return ret;
+}
+
+/**
+* @brief Stops the scanner after the conversion in flight, the last published round stays readable.
+* @return The status of the function.
+*     - E_OK: The function executed successfully.
+*/
+Std_ReturnType ADC_ScanStop(void)
+{
+	uint8 State = GIE_EnterCritical();
+
+	if (ADC_Scanning == TRUE)
+	{
+		ADC_Scanning = FALSE;
+		ADC_ScanBusy = FALSE;
+		GIE_ExitCritical(State);
+
+		/* Let the last conversion finish so ADC_Read starts from a clean state */
+		while (BIT_IS_SET(ADCSRA_REG, ADSC_Bit));
+
+		State = GIE_EnterCritical();
+		if (ADC_ScanSavedIE == 0)
+		{
+			CLEAR_BIT(ADCSRA_REG, ADIE_Bit);
+		}
+		SET_BIT(ADCSRA_REG, ADIF_Bit);
+	}
+	GIE_ExitCritical(State);
+
 	return E_OK;
 }
+
+/**
+* @brief Returns the latest oversampled result of a scan slot in O(1).
+* @param Slot The position of the channel in the list given to ADC_ScanStart.
+* @param ADC_Result A pointer to a variable to store the ADC_SCAN_RESOLUTION bit result.
+* @return The status of the function.
+*     - E_OK: The function executed successfully.
+*     - E_NOT_OK: No round completed yet or the slot is not scanned.
+*/
+Std_ReturnType ADC_ScanGet(uint8 Slot, uint16 *ADC_Result)
+{
+	Std_ReturnType ret = E_OK;
+
+	if (NULL == ADC_Result || Slot >= ADC_ScanCount || ADC_ScanReady == FALSE)
+	{
+		ret = E_NOT_OK;
+	}
+	else
+	{
+		/* The ISR only writes the back buffer, the atomic read just keeps the two bytes whole */
+		*ADC_Result = GIE_AtomicRead16(&ADC_ScanTable[ADC_ScanFront][Slot]);
+	}
+
+	return ret;
+}
+
+/**
+* @brief Returns the number of completed scan rounds, wraps at 256.
+*        Results read between two equal values belong to the same round.
+*/
+uint8 ADC_ScanRound(void)
+{
+	return ADC_ScanRounds;
+}
+
 ISR(ADC_vect)
 {
-	ADC_Complete = TRUE;
+	uint16 Sample = ADC_REG;
+
+	if (ADC_Scanning == FALSE)
+	{
+		/* Single ADC_Read conversion */
+		ADC_Last = Sample;
+		ADC_Complete = TRUE;
+	}
+	else
+	{
+		if (ADC_ScanDiscard > 0)
+		{
+			ADC_ScanDiscard--;
+		}
+		else
+		{
+			ADC_ScanSum += Sample;
+			if (++ADC_ScanSamples == ADC_SCAN_SAMPLES)
+			{
+				/* Decimate: 4^n samples summed and shifted by n give n extra bits */
+				ADC_ScanTable[ADC_ScanFront ^ 1][ADC_ScanSlot] = ADC_ScanSum >> ADC_SCAN_OVERSAMPLE_BITS;
+				ADC_ScanSum = 0;
+				ADC_ScanSamples = 0;
+
+				if (++ADC_ScanSlot == ADC_ScanCount)
+				{
+					/* Publish the round, the next one fills the other buffer */
+					ADC_ScanSlot = 0;
+					ADC_ScanFront ^= 1;
+					ADC_ScanRounds++;
+					ADC_ScanReady = TRUE;
+					if (ADC_ScanPacing == ADC_ScanOnDemand)
+					{
+						ADC_ScanBusy = FALSE;
+					}
+				}
+
+				if (ADC_ScanCount > 1)
+				{
+					ADMUX_REG = (ADMUX_REG & 0xE0) | (uint8)ADC_ScanChannels[ADC_ScanSlot];
+					ADC_ScanDiscard = ADC_SCAN_DISCARD;
+				}
+			}
+		}
+
+		/* Single conversion mode, the new mux setting applies to this start */
+		if (ADC_ScanBusy == TRUE)
+		{
+			SET_BIT(ADCSRA_REG, ADSC_Bit);
+		}
+	}
 }
\ No newline at end of file
@@ -131,6 +131,24 @@ Std_ReturnType DIO_PortWrite(const DIO_PortIndex Port_Index, uint8 Logic)
     }
     return ret;
 }
+/*
+ * Description :
+ * Write only the Mask bits of the port, the other pins keep their level.
+ * The read-modify-write runs with interrupts off so an ISR driving another pin of the port is not undone.
+ */
+Std_ReturnType DIO_PortWriteMasked(const DIO_PortIndex Port_Index, uint8 Mask, uint8 Logic)
+{
+    Std_ReturnType ret = E_OK;
+    uint8 State = 0;
+    if ( Port_Index >= MAX_PORT_NUM || Port_Index < 0 ) ret = E_NOT_OK;
+    else
+    {
+        State = GIE_EnterCritical();
+        *PORT_REG[Port_Index] = (*PORT_REG[Port_Index] & (uint8)~Mask) | (Logic & Mask);
+        GIE_ExitCritical(State);
+    }
+    return ret;
+}
 Std_ReturnType DIO_PortRead(const DIO_PortIndex Port_Index, uint8 *Logic)
 {
     Std_ReturnType ret = E_OK;
@@ -0,0 +1,97 @@
+﻿/********************************************************************************************************
+*  [FILE NAME]   :      <EEPROM.c>                                                                      *
+*  [AUTHOR]      :      <David S. Alexander>                                                            *
+*  [DATE CREATED]:      <Oct 18, 2026>                                                                  *
+*  [Description] :      <Source file for the AVR internal EEPROM driver>                                *
+********************************************************************************************************/
+
+#include "../Inc/EEPROM.h"
+
+Std_ReturnType EEPROM_ReadByte(uint16 Address, uint8 *Data)
+{
+	Std_ReturnType ret = E_OK;
+
+	if (NULL == Data || Address >= EEPROM_SIZE)
+	{
+		ret = E_NOT_OK;
+	}
+	else
+	{
+		while (BIT_IS_SET(EECR_REG, EEWE_Bit));            /* Wait for a pending write */
+		EEAR_REG = Address;
+		SET_BIT(EECR_REG, EERE_Bit);
+		*Data = EEDR_REG;
+	}
+
+	return ret;
+}
+
+/**
+* @brief Writes one byte, skipping the erase/write cycle when the cell already holds the value.
+* @note Blocks for up to one write time (~8.5 ms) while a previous write completes.
+*/
+Std_ReturnType EEPROM_WriteByte(uint16 Address, uint8 Data)
+{
+	Std_ReturnType ret = E_OK;
+	uint8 Current = 0;
+	uint8 State = 0;
+
+	if (Address >= EEPROM_SIZE)
+	{
+		ret = E_NOT_OK;
+	}
+	else
+	{
+		EEPROM_ReadByte(Address, &Current);
+		if (Current != Data)
+		{
+			EEDR_REG = Data;
+
+			/* EEWE must follow EEMWE within four cycles, no interrupt may run in between */
+			State = GIE_EnterCritical();
+			SET_BIT(EECR_REG, EEMWE_Bit);
+			SET_BIT(EECR_REG, EEWE_Bit);
+			GIE_ExitCritical(State);
+		}
+	}
+
+	return ret;
+}
+
+Std_ReturnType EEPROM_ReadBlock(uint16 Address, uint8 *Data, uint16 Length)
+{
+	Std_ReturnType ret = E_OK;
+
+	if (NULL == Data || ((uint32)Address + Length) > EEPROM_SIZE)
+	{
+		ret = E_NOT_OK;
+	}
+	else
+	{
+		while (Length--)
+		{
+			EEPROM_ReadByte(Address++, Data++);
+		}
+	}
+
+	return ret;
+}
+
+Std_ReturnType EEPROM_UpdateBlock(uint16 Address, const uint8 *Data, uint16 Length)
+{
+	Std_ReturnType ret = E_OK;
+
+	if (NULL == Data || ((uint32)Address + Length) > EEPROM_SIZE)
+	{
+		ret = E_NOT_OK;
+	}
+	else
+	{
+		while (Length--)
+		{
+			EEPROM_WriteByte(Address++, *Data++);
+		}
+	}
+
+	return ret;
+}
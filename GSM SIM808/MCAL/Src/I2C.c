@@ -6,34 +6,38 @@
 ********************************************************************************************************/
 
 #include "../Inc/I2C.h"
+#include "../Inc/Trace.h"
 #include <math.h>
 
 Std_ReturnType I2C_Init(const I2C_Config_t* I2Ccfg)
 {
 	Std_ReturnType ret = E_OK;
+	uint8 State = 0;
 	if (NULL == I2Ccfg)
 	{
 		ret = E_NOT_OK;
 	}
 	else
 	{
-		/* Configure I2C Interrupt */
-		if (I2Ccfg->I2C_InterruptStatus == I2C_InterruptDisabled || I2Ccfg->I2C_InterruptStatus == I2C_InterruptEnabled)
+		/* Configure I2C Interrupt: transfers poll TWINT and there is no TWI_vect, so TWIE stays off either way */
+		if (I2Ccfg->I2C_InterruptStatus != I2C_InterruptDisabled && I2Ccfg->I2C_InterruptStatus != I2C_InterruptEnabled)
 		{
-			TWCR_REG |= I2Ccfg->I2C_InterruptStatus;
+			return E_NOT_OK;
 		}
-		else return E_NOT_OK;
 		
 		/* Configure I2C Prescaler */
-		if (I2Ccfg->I2C_Prescaler >= I2C_Prescaler_1 && I2Ccfg->I2C_Prescaler <= I2C_Prescaler_64 )
+		if (I2Ccfg->I2C_Prescaler < I2C_Prescaler_1 || I2Ccfg->I2C_Prescaler > I2C_Prescaler_64 )
 		{
-			TWSR_REG |= I2Ccfg->I2C_Prescaler;
+			return E_NOT_OK;
 		}
-		else return E_NOT_OK;
 		
+		/* Program the TWI with interrupts off, plain writes so a re-init does not OR into the old setup */
+		State = GIE_EnterCritical();
+		TWCR_REG = 0;
+		TWSR_REG = I2Ccfg->I2C_Prescaler;
 		
 		/* Set I2C Address */
-		TWAR_REG |= (I2Ccfg->I2C_Address & 0xFE);
+		TWAR_REG = (I2Ccfg->I2C_Address & 0xFE);
 		
 		/* Calculate and set I2C Bit Rate Register (TWBR) */
 		uint8 PrescalerVal = I2Ccfg->I2C_Prescaler == I2C_Prescaler_1   ? 1  :
@@ -45,6 +49,7 @@ Std_ReturnType I2C_Init(const I2C_Config_t* I2Ccfg)
 		
 		/* Enable TWI module */
 		SET_BIT(TWCR_REG, TWEN_BIT);
+		GIE_ExitCritical(State);
 	}
 	
 	return ret;
@@ -134,6 +139,8 @@ uint8 I2C_GetStatus(void)
 }
 Std_ReturnType I2C_Start()
 {
+	TRACE(TRACE_I2C_START, 0);
+
 	/* Set TWINT, TWSTA, and TWEN to start the I2C transmission */
 	TWCR_REG = (1 << TWINT_BIT) | (1 << TWSTA_BIT) | (1 << TWEN_BIT);
 	
@@ -151,6 +158,8 @@ Std_ReturnType I2C_Start()
 }
 Std_ReturnType I2C_Stop()
 {
+	TRACE(TRACE_I2C_STOP, I2C_GetStatus());
+
 	/* Set TWINT, TWSTO, and TWEN to send the stop condition */
 	TWCR_REG = (1 << TWINT_BIT) | (1 << TWEN_BIT) | (1 << TWSTO_BIT);
 	
@@ -0,0 +1,72 @@
+﻿/********************************************************************************************************
+*  [FILE NAME]   :      <Sleep.c>                                                                       *
+*  [AUTHOR]      :      <David S. Alexander>                                                            *
+*  [DATE CREATED]:      <Oct 18, 2026>                                                                  *
+*  [Description] :      <Source file for the AVR sleep modes and the external wake pin>                 *
+********************************************************************************************************/
+
+#include "../Inc/Sleep.h"
+
+#if SLEEP_WAKE_INT < 4 || SLEEP_WAKE_INT > 7
+#error "SLEEP_WAKE_INT must be one of INT4..INT7, INT3:0 share pins with the TWI and USART1"
+#endif
+
+static volatile boolean Sleep_Woken;
+
+/**
+* @brief Enables the interrupts and sleeps, sei and sleep run back to back so a pending interrupt still wakes.
+* @note  Call with the interrupts off after checking the wake condition to close the race.
+*/
+void Sleep_Enter(Sleep_Mode_t Mode)
+{
+	MCUCR_REG = (MCUCR_REG & ~SLEEP_MODE_MASK) | Mode | (1 << SE_Bit);
+	sei();
+	sleep_cpu();
+	CLEAR_BIT(MCUCR_REG, SE_Bit);
+}
+
+Std_ReturnType Sleep_WakePinEnable(Sleep_Trigger_t Trigger)
+{
+	uint8 State = 0;
+
+	if (Trigger > SLEEP_RisingEdge)
+	{
+		return E_NOT_OK;
+	}
+
+	State = GIE_EnterCritical();
+	CLEAR_BIT(EIMSK_REG, SLEEP_WAKE_INT);
+	EICRB_REG = (EICRB_REG & ~(0x03 << SLEEP_WAKE_SHIFT)) | (Trigger << SLEEP_WAKE_SHIFT);
+	EIFR_REG = (1 << SLEEP_WAKE_INT);                          /* Drop an edge seen while reconfiguring */
+	SET_BIT(EIMSK_REG, SLEEP_WAKE_INT);
+	GIE_ExitCritical(State);
+
+	return E_OK;
+}
+
+void Sleep_WakePinDisable(void)
+{
+	CLEAR_BIT(EIMSK_REG, SLEEP_WAKE_INT);
+}
+
+/* Reports and clears a wake pin event */
+boolean Sleep_WakePending(void)
+{
+	uint8   State = GIE_EnterCritical();
+	boolean Woken = FALSE;
+
+	Woken = Sleep_Woken;
+	Sleep_Woken = FALSE;
+	GIE_ExitCritical(State);
+
+	return Woken;
+}
+
+ISR(SLEEP_VECT(SLEEP_WAKE_INT))
+{
+	Sleep_Woken = TRUE;
+	if (((EICRB_REG >> SLEEP_WAKE_SHIFT) & 0x03) == SLEEP_LowLevel)
+	{
+		CLEAR_BIT(EIMSK_REG, SLEEP_WAKE_INT);                  /* A held low level would fire again at once */
+	}
+}
@@ -0,0 +1,92 @@
+﻿/********************************************************************************************************
+*  [FILE NAME]   :      <Timer.c>                                                                       *
+*  [AUTHOR]      :      <David S. Alexander>                                                            *
+*  [DATE CREATED]:      <Oct 18, 2026>                                                                  *
+*  [Description] :      <Source file for the AVR Timer1 free-running time base>                         *
+********************************************************************************************************/
+
+#include "../Inc/Timer.h"
+#include "../Inc/Sleep.h"
+
+volatile uint16 Timer_Overflows;
+static volatile uint8 Timer_Tick;                      /* 1 ms compare match count, wakes Timer_DelayMs() */
+static volatile uint32 Timer_Millis;                   /* Same count at full width, wraps mod 2^32 */
+
+Std_ReturnType Timer_Init(void)
+{
+	TCCR1A_REG = 0;                                    /* Normal mode, no output compare */
+	TCCR1B_REG = (1 << CS11_Bit) | (1 << CS10_Bit);    /* clk / 64 */
+	TCNT1_REG  = 0;
+	OCR1A_REG  = TIMER_TICKS_PER_MS;                   /* Moved on by one ms each match, TCNT1 keeps running */
+	Timer_Overflows = 0;
+	Timer_Millis = 0;
+	SET_BIT(TIMSK_REG, TOIE1_Bit);
+	SET_BIT(TIMSK_REG, OCIE1A_Bit);
+	ENABLE_GIE();
+
+	return E_OK;
+}
+
+uint32 Timer_GetTicks(void)
+{
+	uint8  State = 0;
+	uint16 Low = 0;
+	uint16 High = 0;
+
+	State = GIE_EnterCritical();
+	Low  = TCNT1_REG;
+	High = Timer_Overflows;
+	if (BIT_IS_SET(TIFR_REG, TOV1_Bit) && Low < 0x8000)
+	{
+		High++;                                        /* Wrapped, the overflow ISR has not run yet */
+	}
+	GIE_ExitCritical(State);
+
+	return ((uint32)High << 16) | Low;
+}
+
+/* Kept by the compare ISR, the tick count divided down would wrap after 2^32 ticks (~9.5 h) */
+uint32 Timer_GetMillis(void)
+{
+	return GIE_AtomicRead32(&Timer_Millis);
+}
+
+/**
+* @brief Waits whole 1 ms ticks in idle sleep, any other interrupt is served on the way.
+* @note  Busy waits when the tick or the interrupts are off, the first tick may be partial.
+*/
+void Timer_DelayMs(uint16 Ms)
+{
+	uint8 Tick = 0;
+	uint8 State = 0;
+
+	while (Ms--)
+	{
+		if (BIT_IS_CLEAR(TIMSK_REG, OCIE1A_Bit) || BIT_IS_CLEAR(_SREG, GIE_Bit))
+		{
+			_delay_ms(1);
+			continue;
+		}
+
+		Tick = Timer_Tick;
+		State = GIE_EnterCritical();                   /* No tick can slip in between the check and the sleep */
+		while (Tick == Timer_Tick)
+		{
+			Sleep_Enter(SLEEP_Idle);
+			DISABLE_GIE();
+		}
+		GIE_ExitCritical(State);
+	}
+}
+
+ISR(TIMER1_OVF_vect)
+{
+	Timer_Overflows++;
+}
+
+ISR(TIMER1_COMPA_vect)
+{
+	OCR1A_REG += TIMER_TICKS_PER_MS;
+	Timer_Tick++;
+	Timer_Millis++;
+}
@@ -0,0 +1,129 @@
+﻿/********************************************************************************************************
+*  [FILE NAME]   :      <Trace.c>                                                                       *
+*  [AUTHOR]      :      <David S. Alexander>                                                            *
+*  [DATE CREATED]:      <Oct 18, 2026>                                                                  *
+*  [Description] :      <Source file for the binary event trace ring>                                   *
+********************************************************************************************************/
+
+#include "../Inc/Trace.h"
+
+#define TRACE_EPOCH_NONE     0xFFFF       /* Forces an epoch event before the first record */
+
+static uint8          Trace_Buffer[TRACE_BUFFER_SIZE][4];
+static volatile uint8 Trace_Head;
+static volatile uint8 Trace_Tail;
+static uint16         Trace_Epoch = TRACE_EPOCH_NONE;
+static uint8          Trace_Lost;
+
+static void Trace_Put(uint8 Id, uint8 Arg, uint16 Ticks)
+{
+	uint8 *Event = Trace_Buffer[Trace_Head];
+
+	Event[0] = Id;
+	Event[1] = Arg;
+	Event[2] = (uint8)Ticks;
+	Event[3] = (uint8)(Ticks >> 8);
+	Trace_Head = (uint8)(Trace_Head + 1) % TRACE_BUFFER_SIZE;
+}
+
+Std_ReturnType Trace_Init(void)
+{
+	uint8 State = GIE_EnterCritical();
+
+	Trace_Head = 0;
+	Trace_Tail = 0;
+	Trace_Epoch = TRACE_EPOCH_NONE;
+	Trace_Lost = 0;
+	GIE_ExitCritical(State);
+
+	return E_OK;
+}
+
+/**
+* @brief Stamps an event with TCNT1, callable from ISRs.
+* @note  A full ring drops the event and reports the count with the next one that fits.
+*/
+void Trace_Record(uint8 Id, uint8 Arg)
+{
+	uint8  State = 0;
+	uint16 Ticks = 0;
+	uint8  Epoch = 0;
+	uint8  Need = 1;
+
+	State = GIE_EnterCritical();
+	Ticks = TCNT1_REG;
+	Epoch = (uint8)Timer_Overflows;
+	if (BIT_IS_SET(TIFR_REG, TOV1_Bit) && Ticks < 0x8000)
+	{
+		Epoch++;                                       /* Wrapped, the overflow ISR has not run yet */
+	}
+
+	if (Epoch != Trace_Epoch) Need++;
+	if (Trace_Lost != 0)      Need++;
+
+	if (((uint8)(Trace_Tail - Trace_Head - 1) % TRACE_BUFFER_SIZE) < Need)
+	{
+		if (Trace_Lost < 0xFF) Trace_Lost++;
+	}
+	else
+	{
+		if (Trace_Lost != 0)
+		{
+			Trace_Put(TRACE_LOST, Trace_Lost, Ticks);
+			Trace_Lost = 0;
+		}
+		if (Epoch != Trace_Epoch)
+		{
+			Trace_Put(TRACE_EPOCH, Epoch, Ticks);
+			Trace_Epoch = Epoch;
+		}
+		Trace_Put(Id, Arg, Ticks);
+	}
+	GIE_ExitCritical(State);
+}
+
+/* 8-bit hash of an AT command name up to '=', '?' or the line end, mirrored in Tools/trace_decode.py */
+uint8 Trace_Hash(const uint8 *Str)
+{
+	uint8 Hash = 0;
+
+	if (NULL == Str)
+	{
+		return 0;
+	}
+
+	for (uint8 Index = 0; Index < 16 && Str[Index] > ' ' && Str[Index] != '=' && Str[Index] != '?'; Index++)
+	{
+		Hash = (uint8)((Hash * 83) + Str[Index]);
+	}
+
+	return Hash;
+}
+
+/**
+* @brief Moves whole frames to the debug UART while its TX ring has room, never blocks.
+*/
+Std_ReturnType Trace_Drain(const USART_Config_t *USART)
+{
+	uint8 Frame[TRACE_FRAME_SIZE];
+
+	if (NULL == USART)
+	{
+		return E_NOT_OK;
+	}
+
+	while (Trace_Tail != Trace_Head && USART_TransmitSpace(USART) >= TRACE_FRAME_SIZE)
+	{
+		Frame[0] = TRACE_SYNC;
+		memcpy(&Frame[1], Trace_Buffer[Trace_Tail], 4);
+		Trace_Tail = (uint8)(Trace_Tail + 1) % TRACE_BUFFER_SIZE;    /* Only the consumer moves the tail */
+		Frame[5] = Frame[0] ^ Frame[1] ^ Frame[2] ^ Frame[3] ^ Frame[4];
+
+		for (uint8 Index = 0; Index < TRACE_FRAME_SIZE; Index++)
+		{
+			USART_Transmit_Byte(USART, Frame[Index]);
+		}
+	}
+
+	return E_OK;
+}
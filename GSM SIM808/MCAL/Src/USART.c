@@ -7,82 +7,88 @@
 *********************************************************************************************************/
 
 #include "../Inc/USART.h"
+#include "../Inc/Trace.h"
 #include <string.h>
-#include <math.h>
 
-/* UCSRx Registers */
-volatile uint8 *UCSRA_REG[]    = {&UCSR0A_REG, &UCSR1A_REG};
-volatile uint8 *UCSRB_REG[]    = {&UCSR0B_REG, &UCSR1B_REG};
-volatile uint8 *UCSRC_REG[]    = {&UCSR0C_REG, &UCSR1C_REG};
+/* USART_CH_SYM(Transmit_Byte) -> USART0_Transmit_Byte while USART_CH is 0 */
+#define USART_SYM_(CH, SUFFIX)     USART##CH##SUFFIX
+#define USART_SYM(CH, SUFFIX)      USART_SYM_(CH, SUFFIX)
+#define USART_CH_SYM(NAME)         USART_SYM(USART_CH, _##NAME)
 
-/* UBRRxL Registers */
-volatile uint8 *UBRRL_REG[]    = {&UBRR0L_REG, &UBRR1L_REG};
-	
-/* UBRRxH Registers */
-volatile uint8 *UBRRH_REG[]    = {&UBRR0H_REG, &UBRR1H_REG};
-
-/* UDRx Registers */
-volatile uint8 *UDR_REG[]      = {&UDR0_REG, &UDR1_REG};
-
-static uint8 RX_Buffer[USART_CHANNELS][USART_RX_BUFFER_SIZE];
-static volatile uint8 RX_BufferHead[USART_CHANNELS];
-static volatile uint8 RX_BufferTail[USART_CHANNELS];
-
-static uint8 TX_Buffer[USART_CHANNELS][USART_TX_BUFFER_SIZE];
-static volatile uint8 TX_BufferHead[USART_CHANNELS];
-static volatile uint8 TX_BufferTail[USART_CHANNELS];
-
-static volatile uint8 TX_IndexBuffer[USART_CHANNELS];
 static volatile uint8 RX_IndexBuffer[USART_CHANNELS];
+static uint32 USART_CurrentBaud[USART_CHANNELS];
+static USART_TransmitHook_t USART_TransmitHooks[USART_CHANNELS];
 
 static volatile boolean RX_DataIsReady[USART_CHANNELS];
 static volatile boolean RX_DataIsAvailable[USART_CHANNELS];
 
-static void USART_TX_InterruptHandler(USART_Channel_t Channel)
+/* Per mille error of one divisor, USART_BAUD_ERROR_NONE when UBRR is out of range */
+static uint16 USART_DivisorError(uint32 BaudRate, uint8 DoubleSpeed)
 {
-	//TX_BufferHead[Channel] = (TX_BufferHead[Channel] + 1) % USART_TX_BUFFER_SIZE;
+	if (BaudRate == 0 || F_CPU < (USART_DIVISOR(DoubleSpeed) * BaudRate) || USART_UBRR(BaudRate, DoubleSpeed) > USART_UBRR_MAX)
+	{
+		return USART_BAUD_ERROR_NONE;
+	}
+
+	return (uint16)USART_BAUD_ERROR(BaudRate, DoubleSpeed);
 }
 
-static void USART_RX_InterruptHandler(USART_Channel_t Channel)
+/* Run-time UBRR for a rate other than the static one, integer only */
+static Std_ReturnType USART_ComputeUBRR(uint32 BaudRate, uint8 DoubleSpeed, uint16 *UBRR)
 {
-	if (((RX_BufferHead[Channel] + 1) % USART_RX_BUFFER_SIZE) != RX_BufferTail[Channel])
+	if (USART_DivisorError(BaudRate, DoubleSpeed) > USART_BAUD_ERROR_MAX)
 	{
-		RX_Buffer[Channel][RX_BufferHead[Channel]] = *UDR_REG[Channel];
-		RX_BufferHead[Channel] = (RX_BufferHead[Channel] + 1) % USART_RX_BUFFER_SIZE;
-		if (BIT_IS_SET(*UCSRA_REG[Channel], FE0_BIT) || BIT_IS_SET(*UCSRA_REG[Channel], DOR0_BIT) || BIT_IS_SET(*UCSRA_REG[Channel], UPE0_BIT))
-		{
-			if (UDR_REG[Channel]);      /* Clear error flags */
-		}
+		return E_NOT_OK;
 	}
+
+	*UBRR = (uint16)USART_UBRR(BaudRate, DoubleSpeed);
+	return E_OK;
 }
 
-static void USART_UDRE_InterruptHandler(USART_Channel_t Channel)
+#if USART_VIRTUAL_CHANNELS
+static const USART_VirtualDriver_t *USART_Virtual = NULL;
+
+/* Index handed to the virtual driver, USART_VIRTUAL_CHANNELS when it does not own the channel */
+static uint8 USART_VirtualIndex(uint8 Channel)
 {
-	if (TX_BufferHead[Channel] != TX_BufferTail[Channel])
-	{
-		*UDR_REG[Channel] = (uint8)(TX_Buffer[Channel][TX_BufferTail[Channel]]);
-		TX_BufferTail[Channel] = (TX_BufferTail[Channel] + 1) % USART_TX_BUFFER_SIZE;
-	}
-	
-	/* Only disable the interrupt if the buffer is empty */
-	if (TX_BufferHead[Channel] == TX_BufferTail[Channel])
-	{
-		CLEAR_BIT(*UCSRB_REG[Channel], UDRIE0_BIT);
-	}
+	return (NULL != USART_Virtual && Channel >= USART_CHANNEL_VIRTUAL0 && Channel < USART_CHANNELS) ?
+	       (uint8)(Channel - USART_CHANNEL_VIRTUAL0) : USART_VIRTUAL_CHANNELS;
 }
+#endif
+
+#if USART_BRIDGE && !(USART0_ENABLED && USART0_INTERRUPT && USART1_ENABLED && USART1_INTERRUPT)
+#error "USART_BRIDGE needs both channels enabled and interrupt driven"
+#endif
+
+#if USART0_ENABLED
+#define USART_CH   0
+#define USART_PEER 1
+#include "../Inc/USART_Channel.h"
+#undef USART_CH
+#undef USART_PEER
+#endif
+
+#if USART1_ENABLED
+#define USART_CH   1
+#define USART_PEER 0
+#include "../Inc/USART_Channel.h"
+#undef USART_CH
+#undef USART_PEER
+#endif
 
 Std_ReturnType USART_Init(const USART_Config_t* USARTcfg)
 {
 	Std_ReturnType ret = E_OK;
 	
 	uint8  UCSRA_Init = 0;
-	uint8  UCSRB_Init = 0;
 	uint8  UCSRC_Init = 0;
-	uint16 UBRR_Init  = 0;
-	
-	uint8 Divisor = 16;
-	if ( USARTcfg->USART_DoubleSpeedStatus == USART_DoubleSpeedEnabled && USARTcfg->USART_OperationMode == USART_AsynchronousMode ) Divisor = 8;
+	uint8  State = 0;
 	
+	if (NULL == USARTcfg)
+	{
+		return E_NOT_OK;
+	}
+
 	/* Set the USART Data Size */
 	UCSRC_Init |= (USARTcfg->USART_DataSize & 0x03) << UCSZ00_BIT;
 
@@ -108,78 +114,246 @@ Std_ReturnType USART_Init(const USART_Config_t* USARTcfg)
 	UCSRC_Init |= (USARTcfg->USART_ParityCheck << 4);
 
 	/* Set the USART Double Transmission Speed */
-	if (USARTcfg->USART_DoubleSpeedStatus == USART_DoubleSpeedEnabled)
+	if (USARTcfg->USART_DoubleSpeedStatus == USART_DoubleSpeedEnabled && USARTcfg->USART_OperationMode == USART_AsynchronousMode)
 	{
 		UCSRA_Init |= (1 << U2X0_BIT);
 	}
 
-	/* Set the USART Interrupt Status */
-	if (USARTcfg->USART_InterruptStatus == USART_InterruptEnabled)
+	/* No RX interrupt may fire on a half programmed channel */
+	State = GIE_EnterCritical();
+	switch (USARTcfg->USART_Channel)
 	{
-		ENABLE_GIE();
-		UCSRB_Init |= (1 << RXCIE0_BIT) | (1 << TXCIE0_BIT) | (1 << UDRIE0_BIT);
+#if USART0_ENABLED
+		case USART_CHANNEL0: ret = USART0_Init(USARTcfg, UCSRA_Init, UCSRC_Init); break;
+#endif
+#if USART1_ENABLED
+		case USART_CHANNEL1: ret = USART1_Init(USARTcfg, UCSRA_Init, UCSRC_Init); break;
+#endif
+		default:             ret = E_NOT_OK;                                        break;
 	}
+	GIE_ExitCritical(State);
 
-	UBRR_Init = round((double)F_CPU / (double)Divisor / (double)USARTcfg->USART_BaudRate - 1);
-	
-	*UBRRH_REG[USARTcfg->USART_Channel] = (UBRR_Init & 0xFF00) >> 8;
-	*UBRRL_REG[USARTcfg->USART_Channel] = (UBRR_Init & 0x00FF);
+#if USART_VIRTUAL_CHANNELS
+	if (USART_VirtualIndex(USARTcfg->USART_Channel) < USART_VIRTUAL_CHANNELS)
+	{
+		ret = E_OK;                                                    /* Nothing to program, the driver owns the link */
+	}
+#endif
 
-	*UCSRA_REG[USARTcfg->USART_Channel] = UCSRA_Init;
-	*UCSRB_REG[USARTcfg->USART_Channel] = UCSRB_Init | (1 << RXEN0_BIT) | (1 << TXEN0_BIT);
-	*UCSRC_REG[USARTcfg->USART_Channel] = UCSRC_Init;
+	if (ret == E_OK)
+	{
+		USART_CurrentBaud[USARTcfg->USART_Channel] = (uint32)USARTcfg->USART_BaudRate;
+	}
+
+	/* Interrupt driven channels need GIE, turned on only once the channel is fully set up */
+	if (ret == E_OK && USARTcfg->USART_InterruptStatus == USART_InterruptEnabled)
+	{
+		ENABLE_GIE();
+	}
 	
 	return ret;
 }
 
-Std_ReturnType USART_Transmit_Byte(const USART_Config_t* USARTcfg, uint8 data)
+uint16 USART_BaudRateError(uint32 BaudRate, uint8* DoubleSpeed)
+{
+	uint16 Normal = USART_DivisorError(BaudRate, 0);
+	uint16 Double = USART_DivisorError(BaudRate, 1);
+
+	/* U2X halves the receiver sampling, only take it when it is strictly closer */
+	if (NULL != DoubleSpeed)
+	{
+		*DoubleSpeed = (Double < Normal) ? 1 : 0;
+	}
+
+	return (Double < Normal) ? Double : Normal;
+}
+
+Std_ReturnType USART_SetBaudRate(const USART_Config_t* USARTcfg, uint32 BaudRate)
 {
 	Std_ReturnType ret = E_OK;
-	if (USARTcfg->USART_InterruptStatus == USART_InterruptEnabled)
+	uint8  DoubleSpeed = 0;
+	uint16 UBRR = 0;
+
+	if (NULL == USARTcfg || USARTcfg->USART_OperationMode != USART_AsynchronousMode ||
+	    USART_BaudRateError(BaudRate, &DoubleSpeed) > USART_BAUD_ERROR_MAX)
 	{
-		if ( (TX_BufferHead[USARTcfg->USART_Channel] + 1) % USART_TX_BUFFER_SIZE  != TX_BufferTail[USARTcfg->USART_Channel])
-		{
-			TX_Buffer[USARTcfg->USART_Channel][TX_BufferHead[USARTcfg->USART_Channel]] = data;
-			TX_BufferHead[USARTcfg->USART_Channel] = (TX_BufferHead[USARTcfg->USART_Channel] + 1) % USART_TX_BUFFER_SIZE;
-			SET_BIT(*UCSRB_REG[USARTcfg->USART_Channel], UDRIE0_BIT);
-		}
-		else return ret;
+		return E_NOT_OK;
 	}
-	else if (USARTcfg->USART_InterruptStatus == USART_InterruptDisabled)
+
+	UBRR = (uint16)USART_UBRR(BaudRate, DoubleSpeed);
+
+	switch (USARTcfg->USART_Channel)
+	{
+#if USART0_ENABLED
+		case USART_CHANNEL0: ret = USART0_SetUBRR(UBRR, DoubleSpeed); break;
+#endif
+#if USART1_ENABLED
+		case USART_CHANNEL1: ret = USART1_SetUBRR(UBRR, DoubleSpeed); break;
+#endif
+		default:             ret = E_NOT_OK;                          break;
+	}
+
+	if (ret == E_OK)
 	{
-		while (BIT_IS_CLEAR(*UCSRA_REG[USARTcfg->USART_Channel],UDRE0_BIT));
-		*UDR_REG[USARTcfg->USART_Channel] = data;
+		USART_CurrentBaud[USARTcfg->USART_Channel] = BaudRate;
 	}
+
 	return ret;
 }
 
+uint32 USART_GetBaudRate(const USART_Config_t* USARTcfg)
+{
+	return (NULL == USARTcfg || USARTcfg->USART_Channel >= USART_CHANNELS) ? 0 : USART_CurrentBaud[USARTcfg->USART_Channel];
+}
+
+static Std_ReturnType USART_ReadStats(const USART_Config_t* USARTcfg, USART_Stats_t* Stats, boolean Reset)
+{
+#if USART_STATS
+	switch ((NULL == USARTcfg) ? USART_CHANNELS : USARTcfg->USART_Channel)
+	{
+#if USART0_ENABLED
+		case USART_CHANNEL0: USART0_GetStats(Stats, Reset); return E_OK;
+#endif
+#if USART1_ENABLED
+		case USART_CHANNEL1: USART1_GetStats(Stats, Reset); return E_OK;
+#endif
+		default:             return E_NOT_OK;
+	}
+#else
+	return E_NOT_OK;                                                   /* Counters compiled out */
+#endif
+}
+
+Std_ReturnType USART_GetStats(const USART_Config_t* USARTcfg, USART_Stats_t* Stats)
+{
+	return (NULL == Stats) ? E_NOT_OK : USART_ReadStats(USARTcfg, Stats, FALSE);
+}
+
+Std_ReturnType USART_ResetStats(const USART_Config_t* USARTcfg)
+{
+	return USART_ReadStats(USARTcfg, NULL, TRUE);
+}
+
+boolean USART_FlowControlEnabled(const USART_Config_t* USARTcfg)
+{
+	switch ((NULL == USARTcfg) ? USART_CHANNELS : USARTcfg->USART_Channel)
+	{
+#if USART0_ENABLED && USART0_FLOW_CONTROL
+		case USART_CHANNEL0: return TRUE;
+#endif
+#if USART1_ENABLED && USART1_FLOW_CONTROL
+		case USART_CHANNEL1: return TRUE;
+#endif
+		default:             return FALSE;
+	}
+}
+
+/**
+* @brief Routes a channel's received bytes to the other channel's TX ring from the RX ISR.
+* @note  Both directions of a pass-through need their own call, the peer's TX ring must keep up.
+*/
+Std_ReturnType USART_SetBridge(const USART_Config_t* USARTcfg, USART_Bridge_t Mode)
+{
+#if USART_BRIDGE
+	if (Mode > USART_BridgeTap)
+	{
+		return E_NOT_OK;
+	}
+
+	switch ((NULL == USARTcfg) ? USART_CHANNELS : USARTcfg->USART_Channel)
+	{
+		case USART_CHANNEL0: USART0_Bridge = Mode; return E_OK;
+		case USART_CHANNEL1: USART1_Bridge = Mode; return E_OK;
+		default:             break;
+	}
+#endif
+	return E_NOT_OK;
+}
+
+/**
+* @brief Hands the USART_CHANNEL_VIRTUALn byte paths to a protocol driver, NULL detaches it.
+*/
+Std_ReturnType USART_SetVirtualDriver(const USART_VirtualDriver_t* Driver)
+{
+#if USART_VIRTUAL_CHANNELS
+	if (NULL != Driver && (NULL == Driver->Transmit_Byte || NULL == Driver->Receive_Byte ||
+	                       NULL == Driver->TransmitSpace || NULL == Driver->Flush))
+	{
+		return E_NOT_OK;
+	}
+
+	USART_Virtual = Driver;
+	return E_OK;
+#else
+	return E_NOT_OK;
+#endif
+}
+
+Std_ReturnType USART_SetTransmitHook(const USART_Config_t* USARTcfg, USART_TransmitHook_t Hook)
+{
+	if (NULL == USARTcfg || USARTcfg->USART_Channel >= USART_CHANNELS)
+	{
+		return E_NOT_OK;
+	}
+
+	USART_TransmitHooks[USARTcfg->USART_Channel] = Hook;
+	return E_OK;
+}
+
+Std_ReturnType USART_Transmit_Byte(const USART_Config_t* USARTcfg, uint8 data)
+{
+	switch (USARTcfg->USART_Channel)
+	{
+#if USART0_ENABLED
+		case USART_CHANNEL0: return USART0_Transmit_Byte(data);
+#endif
+#if USART1_ENABLED
+		case USART_CHANNEL1: return USART1_Transmit_Byte(data);
+#endif
+		default:             break;
+	}
+
+#if USART_VIRTUAL_CHANNELS
+	uint8 Index = USART_VirtualIndex(USARTcfg->USART_Channel);
+	if (Index < USART_VIRTUAL_CHANNELS)
+	{
+		return USART_Virtual->Transmit_Byte(Index, data);
+	}
+#endif
+	return E_NOT_OK;
+}
+
 Std_ReturnType USART_Receive_Byte(const USART_Config_t* USARTcfg, uint8* data)
 {
-	Std_ReturnType ret = E_OK;
-	uint8 BufferIndex = RX_BufferHead[USARTcfg->USART_Channel];
-	if (USARTcfg->USART_InterruptStatus == USART_InterruptEnabled )
+	switch (USARTcfg->USART_Channel)
 	{
-		if (BufferIndex != RX_BufferTail[USARTcfg->USART_Channel])
-		{
-			*data = RX_Buffer[USARTcfg->USART_Channel][RX_BufferTail[USARTcfg->USART_Channel]];	
-			RX_BufferTail[USARTcfg->USART_Channel] = (RX_BufferTail[USARTcfg->USART_Channel] + 1) % USART_RX_BUFFER_SIZE;	
-			RX_DataIsReady[USARTcfg->USART_Channel] = TRUE;
-		}
+#if USART0_ENABLED
+		case USART_CHANNEL0: return USART0_Receive_Byte(data);
+#endif
+#if USART1_ENABLED
+		case USART_CHANNEL1: return USART1_Receive_Byte(data);
+#endif
+		default:             break;
 	}
 
-	else if (USARTcfg->USART_InterruptStatus == USART_InterruptDisabled)
+#if USART_VIRTUAL_CHANNELS
+	uint8 Index = USART_VirtualIndex(USARTcfg->USART_Channel);
+	if (Index < USART_VIRTUAL_CHANNELS && USART_Virtual->Receive_Byte(Index, data) == E_OK)
 	{
-		// Wait for data to be received
-		while(BIT_IS_CLEAR(*UCSRA_REG[USARTcfg->USART_Channel], RXC0_BIT));
-		*data = *UDR_REG[USARTcfg->USART_Channel];
 		RX_DataIsReady[USARTcfg->USART_Channel] = TRUE;
+		return E_OK;
 	}
-	return ret;
+#endif
+	return E_NOT_OK;
 }
 
 Std_ReturnType USART_Transmit_String(const USART_Config_t* USARTcfg, const uint8* data)
 {
 	Std_ReturnType ret = E_OK;
+	if (NULL != USART_TransmitHooks[USARTcfg->USART_Channel])
+	{
+		USART_TransmitHooks[USARTcfg->USART_Channel]();
+	}
 	while (*data)
 	{
 		USART_Transmit_Byte(USARTcfg, *data++);
@@ -187,18 +361,35 @@ Std_ReturnType USART_Transmit_String(const USART_Config_t* USARTcfg, const uint8
 	return ret;
 }
 
+Std_ReturnType USART_Transmit_String_P(const USART_Config_t* USARTcfg, const char* data)
+{
+	Std_ReturnType ret = E_OK;
+	uint8 Character = pgm_read_byte(data);
+	if (NULL != USART_TransmitHooks[USARTcfg->USART_Channel])
+	{
+		USART_TransmitHooks[USARTcfg->USART_Channel]();
+	}
+	while (Character)
+	{
+		USART_Transmit_Byte(USARTcfg, Character);
+		Character = pgm_read_byte(++data);
+	}
+	return ret;
+}
+
 Std_ReturnType USART_Receive_String(const USART_Config_t* USARTcfg, uint8* str)
 {
 	Std_ReturnType ret = E_OK;
 	uint8 ReceivedCharacter = ZERO_INIT;
 
-	USART_Receive_Byte(USARTcfg, &ReceivedCharacter);
+	ret = USART_Receive_Byte(USARTcfg, &ReceivedCharacter);       /* E_NOT_OK when nothing was waiting */
 	
 	if ( RX_DataIsReady[USARTcfg->USART_Channel] == TRUE )
 	{	
 		RX_DataIsReady[USARTcfg->USART_Channel] = FALSE;
 		if ( ReceivedCharacter == USARTcfg->USART_EndCharacter )
 		{
+			str[RX_IndexBuffer[USARTcfg->USART_Channel]] = '\0';       /* Callers no longer have to clear the whole buffer */
 			RX_IndexBuffer[USARTcfg->USART_Channel] = ZERO_INIT;
 			RX_DataIsAvailable[USARTcfg->USART_Channel] = TRUE;
 		}
@@ -232,38 +423,51 @@ Std_ReturnType USART_StringReady(const USART_Config_t* USARTcfg, USART_StringSta
 	}
 	return ret;
 }
-Std_ReturnType USART_Flush(const USART_Config_t* USARTcfg)
-{
-	while (*UCSRA_REG[USARTcfg->USART_Channel] & (1<<RXC0) ) if (*UDR_REG[USARTcfg->USART_Channel]);
-	return E_OK;
-}
-
-ISR(USART0_RX_vect)
-{
-	USART_RX_InterruptHandler(USART_CHANNEL0);
-}
-
-ISR(USART1_RX_vect)
-{
-	USART_RX_InterruptHandler(USART_CHANNEL1);
-}
-
-ISR(USART0_TX_vect)
+uint8 USART_TransmitSpace(const USART_Config_t* USARTcfg)
 {
-	USART_TX_InterruptHandler(USART_CHANNEL0);
-}
+	switch ((NULL == USARTcfg) ? USART_CHANNELS : USARTcfg->USART_Channel)
+	{
+#if USART0_ENABLED
+		case USART_CHANNEL0: return USART0_TransmitSpace();
+#endif
+#if USART1_ENABLED
+		case USART_CHANNEL1: return USART1_TransmitSpace();
+#endif
+		default:             break;
+	}
 
-ISR(USART1_TX_vect)
-{
-	USART_TX_InterruptHandler(USART_CHANNEL0);
+#if USART_VIRTUAL_CHANNELS
+	uint8 Index = USART_VirtualIndex(USARTcfg->USART_Channel);
+	if (Index < USART_VIRTUAL_CHANNELS)
+	{
+		return USART_Virtual->TransmitSpace(Index);
+	}
+#endif
+	return 0;
 }
 
-ISR(USART0_UDRE_vect)
+Std_ReturnType USART_Flush(const USART_Config_t* USARTcfg)
 {
-	USART_UDRE_InterruptHandler(USART_CHANNEL0);
+	switch (USARTcfg->USART_Channel)
+	{
+#if USART0_ENABLED
+		case USART_CHANNEL0: USART0_Flush(); break;
+#endif
+#if USART1_ENABLED
+		case USART_CHANNEL1: USART1_Flush(); break;
+#endif
+#if USART_VIRTUAL_CHANNELS
+		default:
+			if (USART_VirtualIndex(USARTcfg->USART_Channel) >= USART_VIRTUAL_CHANNELS)
+			{
+				return E_NOT_OK;
+			}
+			USART_Virtual->Flush(USART_VirtualIndex(USARTcfg->USART_Channel));
+			break;
+#else
+		default:             return E_NOT_OK;
+#endif
+	}
+	RX_IndexBuffer[USARTcfg->USART_Channel] = ZERO_INIT;        /* Forget a half assembled line */
+	return E_OK;
 }
-
-ISR(USART1_UDRE_vect)
-{
-	USART_UDRE_InterruptHandler(USART_CHANNEL1);
-}
\ No newline at end of file
@@ -0,0 +1,65 @@
+﻿/********************************************************************************************************
+*  [FILE NAME]   :      <Watchdog.c>                                                                    *
+*  [AUTHOR]      :      <David S. Alexander>                                                            *
+*  [DATE CREATED]:      <Oct 18, 2026>                                                                  *
+*  [Description] :      <Source file for the AVR watchdog timer and the reset cause>                    *
+********************************************************************************************************/
+
+#include "../Inc/Watchdog.h"
+
+#define WATCHDOG_CAUSE_UNREAD  0xFF
+
+static uint8 Watchdog_Cause = WATCHDOG_CAUSE_UNREAD;
+
+/**
+* @brief Starts or retimes the watchdog.
+* @note  Changing the period needs WDCE and the new value within four cycles, done with interrupts off.
+*/
+Std_ReturnType Watchdog_Enable(Watchdog_Period_t Period)
+{
+	uint8 State = 0;
+
+	if (Period > WATCHDOG_2S)
+	{
+		return E_NOT_OK;
+	}
+
+	State = GIE_EnterCritical();
+	Watchdog_Kick();
+	WDTCR_REG = (1 << WDCE_Bit) | (1 << WDE_Bit);
+	WDTCR_REG = (1 << WDE_Bit) | Period;
+	GIE_ExitCritical(State);
+
+	return E_OK;
+}
+
+/* Has no effect while the WDTON fuse is programmed */
+void Watchdog_Disable(void)
+{
+	uint8 State = GIE_EnterCritical();
+
+	Watchdog_Kick();
+	WDTCR_REG = (1 << WDCE_Bit) | (1 << WDE_Bit);
+	WDTCR_REG = 0;
+	GIE_ExitCritical(State);
+}
+
+boolean Watchdog_Enabled(void)
+{
+	return BIT_IS_SET(WDTCR_REG, WDE_Bit) ? TRUE : FALSE;
+}
+
+/**
+* @brief Returns the Watchdog_ResetCause_t flags of the last reset.
+* @note  The first call reads and clears MCUCSR, so the next reset reports only its own cause.
+*/
+uint8 Watchdog_ResetCause(void)
+{
+	if (Watchdog_Cause == WATCHDOG_CAUSE_UNREAD)
+	{
+		Watchdog_Cause = MCUCSR_REG & WATCHDOG_RESET_FLAGS;
+		MCUCSR_REG &= ~WATCHDOG_RESET_FLAGS;
+	}
+
+	return Watchdog_Cause;
+}
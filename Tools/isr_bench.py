@@ -0,0 +1,145 @@
+#!/usr/bin/env python3
+"""
+ISR cost and RX throughput benchmark of the MCAL drivers on simavr.
+
+    python Tools/isr_bench.py
+    python Tools/isr_bench.py --save Tools/isr_bench/baseline.json
+    python Tools/isr_bench.py --baseline Tools/isr_bench/baseline.json
+
+Builds Tools/isr_bench/bench_fw.c with the MCAL sources using avr-gcc.
+Builds the simavr harness Tools/isr_bench/isr_bench.c, which needs libsimavr
+and libelf. Then runs the firmware once per baud rate. Each run feeds USART0
+at line rate and counts the echo. The ADC scanner and Timer1 interrupt at the
+same time. The report lists per vector the cycles from entry to RETI and the
+worst entry latency. It also lists the longest interrupt-off window outside
+the ISRs and the echo rate with lost bytes.
+
+With --baseline the run is compared against a saved one. The exit status is
+1 when a vector got slower by more than --tolerance percent, when the
+interrupt-off window grew by more than that, or when bytes are lost that the
+baseline did not lose.
+"""
+
+import argparse
+import json
+import os
+import shutil
+import subprocess
+import sys
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+BENCH = os.path.join(ROOT, "Tools", "isr_bench")
+MCAL = os.path.join(ROOT, "GSM SIM808", "MCAL")
+
+SOURCES = ["USART.c", "ADC.c", "Timer.c", "Sleep.c", "EEPROM.c", "DIO.c", "Global_Interrupt.c", "Trace.c"]
+BAUDS = [9600, 19200, 38400, 57600, 115200, 250000, 500000]
+
+AVR_FLAGS = ["-mmcu=atmega128", "-DF_CPU=8000000UL", "-Os", "-std=gnu99", "-funsigned-char",
+             "-funsigned-bitfields", "-fshort-enums", "-ffunction-sections", "-fdata-sections",
+             "-Wl,--gc-sections"]
+
+
+def run(command):
+    result = subprocess.run(command, stdout=subprocess.PIPE, stderr=subprocess.PIPE, universal_newlines=True)
+    if result.returncode not in (0, 1) or not result.stdout.strip():
+        sys.exit("%s failed:\n%s" % (os.path.basename(command[0]), result.stderr))
+    return result.stdout
+
+
+def build(out, avr_gcc, cc, simavr_prefix):
+    os.makedirs(out, exist_ok=True)
+    firmware = os.path.join(out, "bench_fw.elf")
+    harness = os.path.join(out, "isr_bench")
+
+    subprocess.check_call([avr_gcc] + AVR_FLAGS + ["-I", os.path.join(MCAL, "Inc"), os.path.join(BENCH, "bench_fw.c")] +
+                          [os.path.join(MCAL, "Src", name) for name in SOURCES] + ["-o", firmware])
+
+    include, lib = [], []
+    if simavr_prefix:
+        include = ["-I", os.path.join(simavr_prefix, "include")]
+        lib = ["-L", os.path.join(simavr_prefix, "lib")]
+    subprocess.check_call([cc, "-O2", "-std=gnu99"] + include + [os.path.join(BENCH, "isr_bench.c")] + lib +
+                          ["-lsimavr", "-lelf", "-o", harness])
+
+    return firmware, harness
+
+
+def measure(firmware, harness, bauds, count):
+    results = {}
+    for baud in bauds:
+        results[str(baud)] = json.loads(run([harness, firmware, "--baud", str(baud), "--bytes", str(count)]))
+    return results
+
+
+def print_report(results):
+    for baud, result in sorted(results.items(), key=lambda item: int(item[0])):
+        lost = result["fed"] - result["echoed"]
+        print("%s bps: %d/%d bytes echoed (%d lost), %d bytes/s, longest cli %d cycles at PC %s%s" %
+              (baud, result["echoed"], result["fed"], lost, result["bytes_per_s"], result["max_cli_cycles"],
+               result["max_cli_pc"], ", CRASHED" if result["crashed"] else ""))
+        for name, vector in sorted(result["vectors"].items()):
+            print("  %-14s %7d calls  %4d min %7.1f avg %4d max cycles  %5d max latency" %
+                  (name, vector["calls"], vector["min"], vector["avg"], vector["max"], vector["max_latency"]))
+
+
+def compare(results, baseline, tolerance):
+    """Return the regressions against the baseline as text lines."""
+    regressions = []
+    limit = 1.0 + tolerance / 100.0
+
+    for baud, old in baseline.items():
+        new = results.get(baud)
+        if new is None:
+            continue
+        if new["fed"] - new["echoed"] > old["fed"] - old["echoed"]:
+            regressions.append("%s bps: %d bytes lost, baseline %d" %
+                               (baud, new["fed"] - new["echoed"], old["fed"] - old["echoed"]))
+        if new["max_cli_cycles"] > old["max_cli_cycles"] * limit:
+            regressions.append("%s bps: longest cli %d cycles, baseline %d" %
+                               (baud, new["max_cli_cycles"], old["max_cli_cycles"]))
+        for name, vector in old["vectors"].items():
+            current = new["vectors"].get(name)
+            if current is not None and current["max"] > vector["max"] * limit:
+                regressions.append("%s bps: %s max %d cycles, baseline %d" % (baud, name, current["max"], vector["max"]))
+
+    return regressions
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    parser.add_argument("--baud", type=int, action="append", help="baud rate to run, repeatable (default: %s)" %
+                        ", ".join(str(baud) for baud in BAUDS))
+    parser.add_argument("--bytes", type=int, default=2000, help="bytes fed per run")
+    parser.add_argument("--baseline", help="JSON file of an earlier run to compare against")
+    parser.add_argument("--save", help="write the results as JSON for a later --baseline")
+    parser.add_argument("--tolerance", type=float, default=5.0, help="allowed growth in percent before a regression")
+    parser.add_argument("--out", default=os.path.join(ROOT, "_isr_bench"), help="build directory")
+    parser.add_argument("--avr-gcc", default="avr-gcc")
+    parser.add_argument("--cc", default="cc")
+    parser.add_argument("--simavr", help="simavr install prefix when it is not on the default paths")
+    args = parser.parse_args()
+
+    for tool in (args.avr_gcc, args.cc):
+        if shutil.which(tool) is None:
+            sys.exit("%s not found" % tool)
+
+    firmware, harness = build(args.out, args.avr_gcc, args.cc, args.simavr)
+    results = measure(firmware, harness, args.baud or BAUDS, args.bytes)
+    print_report(results)
+
+    if args.save:
+        with open(args.save, "w") as handle:
+            json.dump(results, handle, indent=1, sort_keys=True)
+
+    if args.baseline:
+        with open(args.baseline) as handle:
+            regressions = compare(results, json.load(handle), args.tolerance)
+        print("\nAgainst baseline: %s" % ("no regressions" if not regressions else "%d regressions" % len(regressions)))
+        for line in regressions:
+            print("  " + line)
+        if regressions:
+            sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,72 @@
+/********************************************************************************************************
+*  [FILE NAME]   :      <bench_fw.c>                                                                    *
+*  [AUTHOR]      :      <David S. Alexander>                                                            *
+*  [DATE CREATED]:      <Oct 18, 2026>                                                                  *
+*  [Description] :      <ISR benchmark firmware, run under simavr by Tools/isr_bench.py>                 *
+********************************************************************************************************/
+
+#include "USART.h"
+#include "ADC.h"
+#include "Timer.h"
+#include "EEPROM.h"
+
+/*
+ * Loads every interrupt source the application uses at once: USART0 echoes
+ * each received byte (RX and UDRE ISRs), the ADC scanner converts back to back
+ * (ADC_vect) and Timer1 ticks (TIMER1_COMPA/OVF). The harness writes the baud
+ * rate into the EEPROM before reset, feeds USART0 at line rate and counts the
+ * echo. The echo runs through the same ring buffers and accessors as the
+ * modem traffic, so a byte the drivers lose is missing from the echo.
+ */
+
+#define BENCH_EEPROM_BAUD     0            /* uint32 little endian, 0xFFFFFFFF keeps USART0_BAUD */
+
+static USART_Config_t Bench_UART =
+{
+	.USART_BaudRate          = USART_115200bps,
+	.USART_Channel           = USART_CHANNEL0,
+	.USART_DataSize          = USART_8BitsDataSize,
+	.USART_InterruptStatus   = USART_InterruptEnabled,
+	.USART_OperationMode     = USART_AsynchronousMode,
+	.USART_ParityCheck       = USART_ParityCheckDisabled,
+	.USART_DoubleSpeedStatus = USART_DoubleSpeedEnabled,
+	.USART_EndCharacter      = '\n'
+};
+
+static ADC_Channel Bench_ADC =
+{
+	.ResultAdjust     = Right_Adjusted,
+	.Prescaller       = CLK_64,
+	.VoltageReference = External_AVCC,
+	.InturruptMode    = ADCInterruptEnabled
+};
+
+static const ADC_Index Bench_Channels[] = { ADC_CHANNEL0, ADC_CHANNEL1 };
+
+int main(void)
+{
+	uint8  Baud[4];
+	uint32 BaudRate = 0;
+	uint8  Data = 0;
+
+	EEPROM_ReadBlock(BENCH_EEPROM_BAUD, Baud, sizeof(Baud));
+	BaudRate = (uint32)Baud[0] | ((uint32)Baud[1] << 8) | ((uint32)Baud[2] << 16) | ((uint32)Baud[3] << 24);
+
+	Timer_Init();
+	USART_Init(&Bench_UART);
+	if (BaudRate != 0xFFFFFFFFUL)
+	{
+		USART_SetBaudRate(&Bench_UART, BaudRate);
+	}
+
+	ADC_Init(&Bench_ADC);
+	ADC_ScanStart(Bench_Channels, sizeof(Bench_Channels) / sizeof(Bench_Channels[0]), ADC_ScanContinuous);
+
+	while (1)
+	{
+		if (USART_Receive_Byte(&Bench_UART, &Data) == E_OK)
+		{
+			while (USART_Transmit_Byte(&Bench_UART, Data) != E_OK);
+		}
+	}
+}
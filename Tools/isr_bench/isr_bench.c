@@ -0,0 +1,297 @@
+/********************************************************************************************************
+*  [FILE NAME]   :      <isr_bench.c>                                                                   *
+*  [AUTHOR]      :      <David S. Alexander>                                                            *
+*  [DATE CREATED]:      <Oct 18, 2026>                                                                  *
+*  [Description] :      <simavr harness measuring ISR cost, interrupt-off windows and RX throughput>    *
+********************************************************************************************************/
+
+/*
+ * Host program, linked against libsimavr:
+ *
+ *     isr_bench bench_fw.elf --baud 115200 --bytes 2000
+ *
+ * Runs the firmware on simavr's cycle counting ATmega128 model and prints
+ * one JSON object on stdout:
+ *   - per vector: calls, min/avg/max cycles from vector entry to RETI, and
+ *     the max latency from the flag being raised to the vector being taken
+ *   - the longest stretch with the I bit clear outside any ISR, and the PC
+ *     of the instruction that started it (byte address, for avr-addr2line)
+ *   - the bytes fed into USART0 at line rate, the bytes echoed back and the
+ *     sustained echo rate in bytes per second
+ * Tools/isr_bench.py builds both sides, runs a list of baud rates and
+ * compares the results against a saved baseline.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include <simavr/sim_avr.h>
+#include <simavr/sim_elf.h>
+#include <simavr/sim_irq.h>
+#include <simavr/sim_interrupts.h>
+#include <simavr/avr_uart.h>
+#include <simavr/avr_eeprom.h>
+
+#define BENCH_FREQUENCY       8000000UL    /* Must match F_CPU of the firmware */
+#define BENCH_VECTORS         35           /* ATmega128 vector table, reset included */
+#define BENCH_SETTLE_MS       5            /* Idle run after reset before the first byte is fed */
+
+typedef struct
+{
+	uint32_t  Calls;
+	uint64_t  Total;
+	uint32_t  Min;
+	uint32_t  Max;
+	uint32_t  MaxLatency;
+	avr_cycle_count_t Raised;
+	avr_cycle_count_t Entered;
+	int       Pending;
+
+} Bench_Vector_t;
+
+static const char *Bench_VectorNames[BENCH_VECTORS] =
+{
+	[5]  = "INT4",
+	[12] = "TIMER1_COMPA",
+	[14] = "TIMER1_OVF",
+	[18] = "USART0_RX",
+	[19] = "USART0_UDRE",
+	[20] = "USART0_TX",
+	[21] = "ADC",
+	[30] = "USART1_RX",
+	[31] = "USART1_UDRE",
+	[32] = "USART1_TX",
+};
+
+static avr_t          *Bench_Avr;
+static Bench_Vector_t  Bench_Table[BENCH_VECTORS];
+static int             Bench_Depth;
+static int             Bench_XOff;
+static uint32_t        Bench_Echoed;
+static avr_cycle_count_t Bench_FirstFeed;
+static avr_cycle_count_t Bench_LastEcho;
+
+static void Bench_OnPending(struct avr_irq_t *irq, uint32_t value, void *param)
+{
+	Bench_Vector_t *Vector = param;
+
+	(void)irq;
+	if (value && !Vector->Pending)
+	{
+		Vector->Raised = Bench_Avr->cycle;
+		Vector->Pending = 1;
+	}
+}
+
+static void Bench_OnRunning(struct avr_irq_t *irq, uint32_t value, void *param)
+{
+	Bench_Vector_t *Vector = param;
+	uint32_t Cycles = 0;
+
+	(void)irq;
+	if (value)
+	{
+		Vector->Entered = Bench_Avr->cycle;
+		if (Vector->Pending && (Vector->Entered - Vector->Raised) > Vector->MaxLatency)
+		{
+			Vector->MaxLatency = (uint32_t)(Vector->Entered - Vector->Raised);
+		}
+		Vector->Pending = 0;
+		Bench_Depth++;
+	}
+	else if (Bench_Depth > 0)
+	{
+		Cycles = (uint32_t)(Bench_Avr->cycle - Vector->Entered);
+		Vector->Calls++;
+		Vector->Total += Cycles;
+		Vector->Min = (Vector->Calls == 1 || Cycles < Vector->Min) ? Cycles : Vector->Min;
+		Vector->Max = (Cycles > Vector->Max) ? Cycles : Vector->Max;
+		Bench_Depth--;
+	}
+}
+
+static void Bench_OnOutput(struct avr_irq_t *irq, uint32_t value, void *param)
+{
+	(void)irq;
+	(void)value;
+	(void)param;
+	Bench_Echoed++;
+	Bench_LastEcho = Bench_Avr->cycle;
+}
+
+static void Bench_OnXOn(struct avr_irq_t *irq, uint32_t value, void *param)
+{
+	(void)irq;
+	(void)value;
+	(void)param;
+	Bench_XOff = 0;
+}
+
+static void Bench_OnXOff(struct avr_irq_t *irq, uint32_t value, void *param)
+{
+	(void)irq;
+	(void)value;
+	(void)param;
+	Bench_XOff = 1;
+}
+
+static void Bench_Usage(void)
+{
+	fprintf(stderr, "usage: isr_bench FIRMWARE.elf [--baud RATE] [--bytes COUNT]\n");
+	exit(2);
+}
+
+int main(int argc, char **argv)
+{
+	elf_firmware_t Firmware;
+	avr_eeprom_desc_t EEPROM;
+	uint8_t  Baud[4];
+	uint32_t BaudRate = 115200;
+	uint32_t Bytes = 2000;
+	uint32_t Fed = 0;
+	uint32_t Flags = 0;
+	uint32_t MaxCli = 0;
+	uint32_t MaxCliPC = 0;
+	uint32_t CliPC = 0;
+	avr_cycle_count_t CliStart = 0;
+	avr_cycle_count_t Deadline = 0;
+	avr_irq_t *Irq = NULL;
+	avr_irq_t *Input = NULL;
+	int  Armed = 0;
+	int  Cli = 0;
+	int  First = 1;
+	int  State = cpu_Running;
+
+	if (argc < 2)
+	{
+		Bench_Usage();
+	}
+	for (int Index = 2; Index < argc; Index++)
+	{
+		if (!strcmp(argv[Index], "--baud") && Index + 1 < argc)       BaudRate = strtoul(argv[++Index], NULL, 0);
+		else if (!strcmp(argv[Index], "--bytes") && Index + 1 < argc) Bytes = strtoul(argv[++Index], NULL, 0);
+		else Bench_Usage();
+	}
+
+	memset(&Firmware, 0, sizeof(Firmware));
+	if (elf_read_firmware(argv[1], &Firmware) != 0)
+	{
+		fprintf(stderr, "isr_bench: cannot read %s\n", argv[1]);
+		return 1;
+	}
+
+	Bench_Avr = avr_make_mcu_by_name("atmega128");
+	if (NULL == Bench_Avr)
+	{
+		fprintf(stderr, "isr_bench: simavr has no atmega128 core\n");
+		return 1;
+	}
+	avr_init(Bench_Avr);
+	avr_load_firmware(Bench_Avr, &Firmware);
+	Bench_Avr->frequency = BENCH_FREQUENCY;
+
+	/* bench_fw.c reads the rate at reset */
+	Baud[0] = (uint8_t)BaudRate;
+	Baud[1] = (uint8_t)(BaudRate >> 8);
+	Baud[2] = (uint8_t)(BaudRate >> 16);
+	Baud[3] = (uint8_t)(BaudRate >> 24);
+	EEPROM.ee = Baud;
+	EEPROM.offset = 0;
+	EEPROM.size = sizeof(Baud);
+	avr_ioctl(Bench_Avr, AVR_IOCTL_EEPROM_SET, &EEPROM);
+
+	for (int Vector = 1; Vector < BENCH_VECTORS; Vector++)
+	{
+		Irq = avr_get_interrupt_irq(Bench_Avr, Vector);
+		if (NULL != Irq)
+		{
+			avr_irq_register_notify(Irq + AVR_INT_IRQ_PENDING, Bench_OnPending, &Bench_Table[Vector]);
+			avr_irq_register_notify(Irq + AVR_INT_IRQ_RUNNING, Bench_OnRunning, &Bench_Table[Vector]);
+		}
+	}
+
+	/* Keep the echo off the console, count it instead */
+	avr_ioctl(Bench_Avr, AVR_IOCTL_UART_GET_FLAGS('0'), &Flags);
+	Flags &= ~AVR_UART_FLAG_STDIO;
+	avr_ioctl(Bench_Avr, AVR_IOCTL_UART_SET_FLAGS('0'), &Flags);
+
+	Input = avr_io_getirq(Bench_Avr, AVR_IOCTL_UART_GETIRQ('0'), UART_IRQ_INPUT);
+	avr_irq_register_notify(avr_io_getirq(Bench_Avr, AVR_IOCTL_UART_GETIRQ('0'), UART_IRQ_OUTPUT), Bench_OnOutput, NULL);
+	avr_irq_register_notify(avr_io_getirq(Bench_Avr, AVR_IOCTL_UART_GETIRQ('0'), UART_IRQ_OUT_XON), Bench_OnXOn, NULL);
+	avr_irq_register_notify(avr_io_getirq(Bench_Avr, AVR_IOCTL_UART_GETIRQ('0'), UART_IRQ_OUT_XOFF), Bench_OnXOff, NULL);
+	Bench_XOff = 0;                                                /* simavr buffers the input and raises XOFF when that fills */
+
+	/* Feed time at line rate plus the same again for the echo to drain, 10 bits per byte */
+	Deadline = avr_usec_to_cycles(Bench_Avr, BENCH_SETTLE_MS * 1000UL) +
+	           2 * avr_usec_to_cycles(Bench_Avr, (uint64_t)Bytes * 10 * 1000000 / BaudRate) +
+	           avr_usec_to_cycles(Bench_Avr, 100000);
+
+	while (State != cpu_Done && State != cpu_Crashed && Bench_Avr->cycle < Deadline && Bench_Echoed < Bytes)
+	{
+		uint32_t PC = Bench_Avr->pc;
+
+		State = avr_run(Bench_Avr);
+
+		/* The reset state has I clear, windows count from the first sei */
+		if (Bench_Avr->sreg[S_I])
+		{
+			if (Cli && (uint32_t)(Bench_Avr->cycle - CliStart) > MaxCli)
+			{
+				MaxCli = (uint32_t)(Bench_Avr->cycle - CliStart);
+				MaxCliPC = CliPC;
+			}
+			Armed = 1;
+			Cli = 0;
+		}
+		else if (Armed && !Cli && Bench_Depth == 0)
+		{
+			Cli = 1;
+			CliStart = Bench_Avr->cycle;
+			CliPC = PC;
+		}
+
+		if (Armed && Fed < Bytes && !Bench_XOff && Bench_Avr->cycle >= avr_usec_to_cycles(Bench_Avr, BENCH_SETTLE_MS * 1000UL))
+		{
+			if (Fed == 0)
+			{
+				Bench_FirstFeed = Bench_Avr->cycle;
+			}
+			avr_raise_irq(Input, (uint8_t)(Fed * 7 + 1));
+			Fed++;
+		}
+	}
+
+	printf("{\"baud\": %u, \"bytes\": %u, \"fed\": %u, \"echoed\": %u, \"bytes_per_s\": %.0f, ",
+	       BaudRate, Bytes, Fed, Bench_Echoed,
+	       (Bench_Echoed > 0 && Bench_LastEcho > Bench_FirstFeed) ?
+	       (double)Bench_Echoed * BENCH_FREQUENCY / (double)(Bench_LastEcho - Bench_FirstFeed) : 0.0);
+	printf("\"max_cli_cycles\": %u, \"max_cli_pc\": \"0x%04x\", \"crashed\": %s, \"vectors\": {",
+	       MaxCli, MaxCliPC, (State == cpu_Crashed) ? "true" : "false");
+	for (int Vector = 1; Vector < BENCH_VECTORS; Vector++)
+	{
+		Bench_Vector_t *Entry = &Bench_Table[Vector];
+		char Name[16];
+
+		if (Entry->Calls == 0)
+		{
+			continue;
+		}
+		if (NULL != Bench_VectorNames[Vector])
+		{
+			snprintf(Name, sizeof(Name), "%s", Bench_VectorNames[Vector]);
+		}
+		else
+		{
+			snprintf(Name, sizeof(Name), "vector_%d", Vector);
+		}
+		printf("%s\"%s\": {\"calls\": %u, \"min\": %u, \"avg\": %.1f, \"max\": %u, \"max_latency\": %u}",
+		       First ? "" : ", ", Name, Entry->Calls, Entry->Min, (double)Entry->Total / Entry->Calls,
+		       Entry->Max, Entry->MaxLatency);
+		First = 0;
+	}
+	printf("}}\n");
+
+	return (State == cpu_Crashed) ? 1 : 0;
+}
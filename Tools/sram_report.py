@@ -0,0 +1,119 @@
+#!/usr/bin/env python3
+"""
+SRAM usage report for the SIM808 firmware, read from the linker map file.
+
+    python Tools/sram_report.py "GSM SIM808/Debug/SIM808.map"
+    python Tools/sram_report.py new.map --baseline old.map
+
+Lists the static RAM per object file and the largest symbols: .data, .bss,
+.noinit and .rodata copied into SRAM (string literals that are not PSTR or
+PROGMEM). With --baseline the two builds are compared and the SRAM saved is
+printed, e.g. before and after moving strings into flash.
+"""
+
+import argparse
+import re
+import sys
+from collections import defaultdict
+
+RAM_ORIGIN = 0x800000
+SECTION_RE = re.compile(r"^ (\.(?:data|bss|noinit|rodata)(?:\.\S+)?|COMMON)\s*(?:0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)\s+(.+))?$")
+ADDRESS_RE = re.compile(r"^\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)\s+(.+)$")
+
+
+def parse_map(path):
+    """Return {(kind, symbol, object): size} for every RAM input section."""
+    sections = {}
+    pending = None
+
+    with open(path, encoding="utf-8", errors="replace") as handle:
+        for line in handle:
+            line = line.rstrip("\r\n")
+            match = SECTION_RE.match(line)
+            if match:
+                name, address, size, obj = match.groups()
+                if address is None:
+                    pending = name                  # Address and size wrap onto the next line
+                    continue
+            elif pending is not None and ADDRESS_RE.match(line):
+                address, size, obj = ADDRESS_RE.match(line).groups()
+                name, pending = pending, None
+            else:
+                pending = None
+                continue
+
+            address, size = int(address, 16), int(size, 16)
+            if size == 0 or address < RAM_ORIGIN:
+                continue
+            kind = "bss" if name == "COMMON" else name.split(".")[1]
+            symbol = name.split(".", 2)[2] if name.count(".") >= 2 else "(anonymous)"
+            obj = obj.strip().replace("\\", "/").split("/")[-1]
+            sections[(kind, symbol, obj)] = sections.get((kind, symbol, obj), 0) + size
+
+    return sections
+
+
+def totals(sections):
+    result = defaultdict(int)
+    for (kind, _, _), size in sections.items():
+        result[kind] += size
+    return result
+
+
+def print_report(sections, ram_size, top):
+    kinds = totals(sections)
+    used = sum(kinds.values())
+
+    print("Static SRAM: %d of %d bytes (%.1f%%), stack and heap get the remaining %d" %
+          (used, ram_size, 100.0 * used / ram_size, ram_size - used))
+    for kind in ("data", "rodata", "bss", "noinit"):
+        print("  .%-7s %6d" % (kind, kinds.get(kind, 0)))
+    if kinds.get("rodata"):
+        print("  (.rodata in SRAM is constant data such as string literals, PSTR/PROGMEM keeps it in flash)")
+
+    per_object = defaultdict(int)
+    for (_, _, obj), size in sections.items():
+        per_object[obj] += size
+    print("\nPer object file:")
+    for obj, size in sorted(per_object.items(), key=lambda item: -item[1]):
+        print("  %-28s %6d" % (obj, size))
+
+    print("\nLargest symbols:")
+    for (kind, symbol, obj), size in sorted(sections.items(), key=lambda item: -item[1])[:top]:
+        print("  %-28s %6d  .%s  %s" % (symbol, size, kind, obj))
+
+
+def print_delta(sections, baseline):
+    keys = set(sections) | set(baseline)
+    changes = []
+    for key in keys:
+        delta = sections.get(key, 0) - baseline.get(key, 0)
+        if delta:
+            changes.append((delta, key))
+
+    before, after = sum(baseline.values()), sum(sections.values())
+    print("\nAgainst baseline: %d -> %d bytes, %d bytes of SRAM %s" %
+          (before, after, abs(before - after), "saved" if after <= before else "added"))
+    for delta, (kind, symbol, obj) in sorted(changes):
+        print("  %+6d  %-28s .%s  %s" % (delta, symbol, kind, obj))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    parser.add_argument("map", help="linker map file of the build to inspect")
+    parser.add_argument("--baseline", help="map file of a previous build to compare against")
+    parser.add_argument("--ram", type=int, default=4096, help="SRAM size in bytes (ATmega128: 4096)")
+    parser.add_argument("--top", type=int, default=15, help="number of symbols to list")
+    args = parser.parse_args()
+
+    sections = parse_map(args.map)
+    if not sections:
+        sys.exit("no RAM sections found in %s" % args.map)
+
+    print_report(sections, args.ram, args.top)
+    if args.baseline:
+        print_delta(sections, parse_map(args.baseline))
+
+
+if __name__ == "__main__":
+    main()
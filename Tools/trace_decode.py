@@ -0,0 +1,201 @@
+#!/usr/bin/env python3
+"""
+Decoder for the binary trace frames sent by Trace_Drain() on the debug UART.
+
+    python Tools/trace_decode.py capture.bin
+    python Tools/trace_decode.py capture.bin --timeline
+    cat /dev/ttyUSB0 | python Tools/trace_decode.py - --timeline
+
+The capture is the raw byte stream of the debug UART; the modem echo text in
+between is skipped. Frames are 6 bytes: 0xA5, id, arg, TCNT1 (little endian)
+and the XOR of the first five bytes. TRACE_EPOCH events carry the low byte of
+the Timer1 overflow count, which extends TCNT1 to an absolute time.
+
+The summary lists AT command latency (echo to final result), URC counts,
+ISR and I2C transaction durations, dropped events and the longest gaps.
+"""
+
+import argparse
+import sys
+from collections import defaultdict
+
+SYNC = 0xA5
+FRAME_SIZE = 6
+
+# Trace_Event_t
+EPOCH, LOST, CMD, RESULT, URC, ISR_ENTER, ISR_EXIT, I2C_START, I2C_STOP = range(9)
+USER = 0x40
+
+RESULTS = {0: "match", 1: "ERROR", 2: "timeout"}
+VECTORS = {0: "USART0_RX", 1: "USART0_UDRE", 2: "USART1_RX", 3: "USART1_UDRE"}
+
+# Commands sent by the driver, hashed like Trace_Hash()
+COMMANDS = [
+    "AT", "ATE1", "ATD", "AT+CFUN", "AT+CGNSINF", "AT+CGNSPWR", "AT+CGNSURC",
+    "AT+CIFSR", "AT+CIICR", "AT+CIMI", "AT+CIPCLOSE", "AT+CIPHEAD", "AT+CIPMUX",
+    "AT+CIPSEND", "AT+CIPSHUT", "AT+CIPSTART", "AT+CMGF", "AT+CMGL", "AT+CMGR",
+    "AT+CMGS", "AT+CNMI", "AT+COPS", "AT+CSQ", "AT+CSTT", "AT+HTTPACTION",
+    "AT+HTTPINIT", "AT+HTTPPARA", "AT+HTTPREAD", "AT+HTTPTERM", "AT+IFC",
+    "AT+IPR", "AT+SAPBR", "AT+CBC", "AT+CMUX", "AT+CSCLK", "AT+CMEE",
+]
+
+
+def trace_hash(name):
+    """Same as Trace_Hash(): h = h * 83 + c over the name, 8 bits."""
+    value = 0
+    for char in name.encode("ascii")[:16]:
+        value = (value * 83 + char) & 0xFF
+    return value
+
+
+def command_names(extra):
+    names = defaultdict(list)
+    for name in COMMANDS + extra:
+        names[trace_hash(name)].append(name)
+    return {key: "/".join(value) for key, value in names.items()}
+
+
+def frames(data):
+    """Yield (id, arg, ticks) for every frame with a valid check byte."""
+    index = 0
+    while index + FRAME_SIZE <= len(data):
+        if data[index] != SYNC:
+            index += 1
+            continue
+        frame = data[index:index + FRAME_SIZE]
+        if frame[0] ^ frame[1] ^ frame[2] ^ frame[3] ^ frame[4] != frame[5]:
+            index += 1                                  # 0xA5 inside another frame, resync
+            continue
+        yield frame[1], frame[2], frame[3] | (frame[4] << 8)
+        index += FRAME_SIZE
+
+
+def timeline(data):
+    """Yield (time_us, id, arg) with TCNT1 extended by the epoch events."""
+    epoch = 0
+    high = 0                                            # Epoch wraps of the 8-bit count
+    for event, arg, ticks in frames(data):
+        if event == EPOCH:
+            if arg < (epoch & 0xFF):
+                high += 1
+            epoch = (high << 8) | arg
+        yield ((epoch << 16) | ticks), event, arg
+
+
+def describe(event, arg, names):
+    if event == EPOCH:
+        return "epoch %d" % arg
+    if event == LOST:
+        return "LOST %d events" % arg
+    if event == CMD:
+        return "cmd %s" % names.get(arg, "#%02X" % arg)
+    if event == RESULT:
+        return "result %s" % RESULTS.get(arg, arg)
+    if event == URC:
+        return "urc handler %d" % arg
+    if event in (ISR_ENTER, ISR_EXIT):
+        return "isr %s %s" % ("enter" if event == ISR_ENTER else "exit", VECTORS.get(arg, arg))
+    if event == I2C_START:
+        return "i2c start"
+    if event == I2C_STOP:
+        return "i2c stop status 0x%02X" % arg
+    if event >= USER:
+        return "user %d arg %d" % (event - USER, arg)
+    return "id %d arg %d" % (event, arg)
+
+
+def stats_line(label, values):
+    values = sorted(values)
+    return "  %-24s n=%-5d min=%9.3f  avg=%9.3f  max=%9.3f ms" % (
+        label, len(values), values[0], sum(values) / len(values), values[-1])
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("capture", help="raw debug UART capture, - for stdin")
+    parser.add_argument("--tick-us", type=float, default=8.0, help="Timer1 tick in microseconds (8 at 8 MHz / 64)")
+    parser.add_argument("--timeline", action="store_true", help="print every event")
+    parser.add_argument("--command", action="append", default=[], help="extra AT command name to recognise")
+    parser.add_argument("--gaps", type=int, default=5, help="longest gaps to list")
+    args = parser.parse_args()
+
+    data = sys.stdin.buffer.read() if args.capture == "-" else open(args.capture, "rb").read()
+    names = command_names(args.command)
+    scale = args.tick_us / 1000.0
+
+    latency = defaultdict(list)
+    results = defaultdict(int)
+    urcs = defaultdict(int)
+    isr = defaultdict(list)
+    i2c = []
+    lost = 0
+    gaps = []
+    pending_cmd = None
+    isr_open = {}
+    i2c_open = None
+    previous = None
+    start = None
+    count = 0
+
+    for ticks, event, arg in timeline(data):
+        now = ticks * scale
+        start = now if start is None else start
+        count += 1
+        if args.timeline:
+            print("%12.3f ms  %s" % (now - start, describe(event, arg, names)))
+        if previous is not None and event != EPOCH:
+            gaps.append((now - previous, previous - start))
+        if event != EPOCH:
+            previous = now
+
+        if event == CMD:
+            pending_cmd = (names.get(arg, "#%02X" % arg), now)
+        elif event == RESULT:
+            results[RESULTS.get(arg, arg)] += 1
+            if pending_cmd is not None:
+                latency["%s (%s)" % (pending_cmd[0], RESULTS.get(arg, arg))].append(now - pending_cmd[1])
+                pending_cmd = None
+        elif event == URC:
+            urcs[arg] += 1
+        elif event == ISR_ENTER:
+            isr_open[arg] = now
+        elif event == ISR_EXIT and arg in isr_open:
+            isr[VECTORS.get(arg, arg)].append(now - isr_open.pop(arg))
+        elif event == I2C_START:
+            i2c_open = now
+        elif event == I2C_STOP and i2c_open is not None:
+            i2c.append(now - i2c_open)
+            i2c_open = None
+        elif event == LOST:
+            lost += arg
+
+    if count == 0:
+        print("No trace frames found")
+        return 1
+
+    print("\n%d events, %d lost on a full ring" % (count, lost))
+    if latency:
+        print("\nAT command latency (echo to final result):")
+        for label in sorted(latency, key=lambda key: -max(latency[key])):
+            print(stats_line(label, latency[label]))
+    if results:
+        print("\nResults: " + ", ".join("%s=%d" % item for item in sorted(results.items())))
+    if urcs:
+        print("URCs:    " + ", ".join("handler %d=%d" % item for item in sorted(urcs.items())))
+    if isr:
+        print("\nISR duration:")
+        for label in sorted(isr):
+            print(stats_line(label, isr[label]))
+    if i2c:
+        print("\nI2C transactions:")
+        print(stats_line("start to stop", i2c))
+    if gaps and args.gaps > 0:
+        print("\nLongest gaps between events:")
+        for gap, at in sorted(gaps, reverse=True)[:args.gaps]:
+            print("  %9.3f ms after t=%.3f ms" % (gap, at))
+
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,302 @@
+/********************************************************************************************************
+*  [FILE NAME]   :      <track_check.c>                                                                 *
+*  [AUTHOR]      :      <David S. Alexander>                                                            *
+*  [DATE CREATED]:      <Oct 18, 2026>                                                                  *
+*  [Description] :      <Host check of the track simplifier tolerance and batch size>                   *
+********************************************************************************************************/
+
+/*
+ * Host program, built with any C99 compiler:
+ *
+ *     gcc -std=gnu99 -O2 Tools/track_check.c -lm -o track_check && ./track_check
+ *
+ * Compiles HAL/Src/Track.c unchanged, feeds it synthetic 1 Hz tracks, flushes
+ * and decodes the batch, and checks for every scenario:
+ *   - every fed fix lies within TRACK_TOLERANCE (plus the encoding quantum)
+ *     of the decoded path
+ *   - on the straight road, the batch costs at most TRACK_CHECK_MAX_BYTES
+ *     per fix, against TRACK_CHECK_CGNSINF_BYTES for a raw +CGNSINF line
+ * The "return" scenario drives back to the last kept point inside one
+ * window, so the segment to check has zero length. The "reverse" scenario
+ * turns around on the same line, so the apex lies past the segment end.
+ * Prints one line per scenario and exits with 1 when a check fails.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+
+/* Target types: long is 32 bits on the AVR, so the platform header is not used on the host */
+#define STD_TYPES_H_
+#define GSM_SIM808_H_
+
+#define FALSE                 (0u)
+#define TRUE                  (1u)
+#define E_OK                  (Std_ReturnType)0x01
+#define E_NOT_OK              0x00
+
+typedef uint8_t               uint8;
+typedef int8_t                sint8;
+typedef uint16_t              uint16;
+typedef int16_t               sint16;
+typedef uint32_t              uint32;
+typedef int32_t               sint32;
+typedef uint8                 Std_ReturnType;
+typedef uint8                 boolean;
+typedef struct USART_Config   USART_Config_t;
+
+#include "../GSM SIM808/HAL/Src/Track.c"
+
+#define TRACK_CHECK_CGNSINF_BYTES   94             /* Typical +CGNSINF line with a valid fix */
+#define TRACK_CHECK_MAX_BYTES       6              /* Encoded bytes per fix allowed on the straight road */
+#define TRACK_CHECK_MAX_FIXES       900
+#define TRACK_CHECK_SLACK           2.0            /* Meters, quantum and integer projection */
+
+#define TRACK_CHECK_LATITUDE        30044400L      /* Degrees * 1e6 */
+#define TRACK_CHECK_LONGITUDE       31235700L
+
+typedef struct
+{
+	double x;
+	double y;
+
+} Check_Point_t;
+
+static Check_Point_t Check_Fed[TRACK_CHECK_MAX_FIXES];
+static uint16        Check_FedCount;
+static Check_Point_t Check_Kept[TRACK_CHECK_MAX_FIXES];
+static uint16        Check_KeptCount;
+static uint32        Check_Bytes;
+
+/* Host stand-in for the flash table in GNSS_SIM808.c */
+uint16 GNSS_CosLatitude(sint32 Latitude)
+{
+	double Cos = cos((double)Latitude / GNSS_COORDINATE_SCALE * M_PI / 180.0) * 32768.0;
+
+	return (Cos < GNSS_COS_MIN) ? GNSS_COS_MIN : (uint16)Cos;
+}
+
+static Check_Point_t Check_Meters(sint32 Latitude, sint32 Longitude)
+{
+	Check_Point_t Point;
+
+	Point.x = (double)(Longitude - TRACK_CHECK_LONGITUDE) * 0.11132 * cos(TRACK_CHECK_LATITUDE / 1e6 * M_PI / 180.0);
+	Point.y = (double)(Latitude - TRACK_CHECK_LATITUDE) * 0.11132;
+
+	return Point;
+}
+
+static uint32 Check_Varint(uint16 *Index)
+{
+	uint32 Value = 0;
+	uint8  Shift = 0;
+
+	do
+	{
+		Value |= (uint32)(Track_Batch[*Index] & 0x7F) << Shift;
+		Shift += 7;
+	} while (Track_Batch[(*Index)++] & 0x80);
+
+	return Value;
+}
+
+static sint32 Check_Zigzag(uint32 Value)
+{
+	return (Value & 1) ? -(sint32)((Value + 1) >> 1) : (sint32)(Value >> 1);
+}
+
+static uint32 Check_LittleEndian(uint16 Index)
+{
+	return (uint32)Track_Batch[Index] | ((uint32)Track_Batch[Index + 1] << 8) |
+	       ((uint32)Track_Batch[Index + 2] << 16) | ((uint32)Track_Batch[Index + 3] << 24);
+}
+
+/* Decode the batch as documented in Track.h, appending the points to Check_Kept */
+static void Check_Decode(void)
+{
+	const uint8 *Data = NULL;
+	uint16 Length = 0;
+	uint16 Index = 12;
+	sint32 Latitude = 0, Longitude = 0;
+
+	Track_GetBatch(&Data, &Length);
+	if (Length == 0)
+	{
+		return;
+	}
+	Latitude  = (sint32)Check_LittleEndian(1);
+	Longitude = (sint32)Check_LittleEndian(5);
+	Check_Kept[Check_KeptCount++] = Check_Meters(Latitude * TRACK_QUANTUM, Longitude * TRACK_QUANTUM);
+	while (Index < Length)
+	{
+		Latitude  += Check_Zigzag(Check_Varint(&Index));
+		Longitude += Check_Zigzag(Check_Varint(&Index));
+		(void)Check_Varint(&Index);
+		Check_Kept[Check_KeptCount++] = Check_Meters(Latitude * TRACK_QUANTUM, Longitude * TRACK_QUANTUM);
+	}
+	Check_Bytes += Length;
+}
+
+static void Check_Feed(sint32 Latitude, sint32 Longitude, uint32 Second)
+{
+	GNSS_Fix_t Fix;
+
+	memset(&Fix, 0, sizeof(Fix));
+	Fix.GNSS_Status    = GNSS_FixValid;
+	Fix.GNSS_Hour      = (uint8)(Second / 3600);
+	Fix.GNSS_Minute    = (uint8)((Second / 60) % 60);
+	Fix.GNSS_Second    = (uint8)(Second % 60);
+	Fix.GNSS_Latitude  = Latitude;
+	Fix.GNSS_Longitude = Longitude;
+
+	if (Track_AddFix(&Fix) == E_NOT_OK)
+	{
+		Check_Decode();                          /* Batch full: "upload" it and retry */
+		Track_ClearBatch();
+		Track_AddFix(&Fix);
+	}
+	Check_Fed[Check_FedCount++] = Check_Meters(Latitude, Longitude);
+}
+
+static double Check_SegmentDistance(Check_Point_t P, Check_Point_t A, Check_Point_t B)
+{
+	double dx = B.x - A.x, dy = B.y - A.y;
+	double Length = dx * dx + dy * dy;
+	double t = (Length > 0) ? ((P.x - A.x) * dx + (P.y - A.y) * dy) / Length : 0;
+
+	t = (t < 0) ? 0 : ((t > 1) ? 1 : t);
+
+	return hypot(P.x - (A.x + t * dx), P.y - (A.y + t * dy));
+}
+
+/* Worst distance of a fed fix from the decoded path */
+static double Check_Deviation(void)
+{
+	double Worst = 0;
+
+	for (uint16 Fed = 0; Fed < Check_FedCount; Fed++)
+	{
+		double Best = hypot(Check_Fed[Fed].x - Check_Kept[0].x, Check_Fed[Fed].y - Check_Kept[0].y);
+
+		for (uint16 Kept = 1; Kept < Check_KeptCount; Kept++)
+		{
+			double Distance = Check_SegmentDistance(Check_Fed[Fed], Check_Kept[Kept - 1], Check_Kept[Kept]);
+			Best = (Distance < Best) ? Distance : Best;
+		}
+		Worst = (Best > Worst) ? Best : Worst;
+	}
+
+	return Worst;
+}
+
+static void Check_Start(void)
+{
+	Track_Init();
+	Check_FedCount = 0;
+	Check_KeptCount = 0;
+	Check_Bytes = 0;
+}
+
+static void Check_Finish(void)
+{
+	Track_Flush();
+	Check_Decode();
+	Track_ClearBatch();
+}
+
+/* Straight road east at 14 m/s with +-2 m of lateral jitter */
+static void Check_Straight(void)
+{
+	for (uint16 Second = 0; Second < 600; Second++)
+	{
+		sint32 Jitter = ((Second * 7) % 5 - 2) * 9;          /* 9 units of latitude ~ 1 m */
+		Check_Feed(TRACK_CHECK_LATITUDE + Jitter, TRACK_CHECK_LONGITUDE + (sint32)Second * 145, 43200 + Second);
+	}
+}
+
+/* Out and back to the anchor within one window: 12 m north, 70 m north-east, anchor again */
+static void Check_Return(void)
+{
+	static const sint16 North[] = { 0, 108, 360, 0 };
+	static const sint16 East[]  = { 0, 0, 620, 0 };
+	uint16 Second = 0;
+
+	for (Second = 0; Second < sizeof(North) / sizeof(North[0]); Second++)
+	{
+		Check_Feed(TRACK_CHECK_LATITUDE + North[Second], TRACK_CHECK_LONGITUDE + East[Second], 43200 + Second);
+	}
+	for (uint16 Step = 1; Step <= 20; Step++)
+	{
+		Check_Feed(TRACK_CHECK_LATITUDE, TRACK_CHECK_LONGITUDE + (sint32)Step * 145, 43200 + Second++);
+	}
+}
+
+/* 120 m north and back along the same line, then on east */
+static void Check_Reverse(void)
+{
+	static const sint16 North[] = { 0, 108, 400, 750, 1080, 750, 400, 108, 0 };
+	uint16 Second = 0;
+
+	for (Second = 0; Second < sizeof(North) / sizeof(North[0]); Second++)
+	{
+		Check_Feed(TRACK_CHECK_LATITUDE + North[Second], TRACK_CHECK_LONGITUDE, 43200 + Second);
+	}
+	for (uint16 Step = 1; Step <= 20; Step++)
+	{
+		Check_Feed(TRACK_CHECK_LATITUDE, TRACK_CHECK_LONGITUDE + (sint32)Step * 145, 43200 + Second++);
+	}
+}
+
+/* Square block of 200 m sides, the last side ends at the start */
+static void Check_Block(void)
+{
+	static const sint8 Direction[4][2] = { { 1, 0 }, { 0, 1 }, { -1, 0 }, { 0, -1 } };
+	sint32 Latitude = TRACK_CHECK_LATITUDE, Longitude = TRACK_CHECK_LONGITUDE;
+	uint16 Second = 0;
+
+	Check_Feed(Latitude, Longitude, 43200);
+	for (uint8 Side = 0; Side < 4; Side++)
+	{
+		for (uint8 Step = 0; Step < 10; Step++)
+		{
+			Latitude  += Direction[Side][1] * 180;
+			Longitude += Direction[Side][0] * 207;
+			Check_Feed(Latitude, Longitude, 43200 + ++Second);
+		}
+	}
+}
+
+static int Check_Run(const char *Name, void (*Scenario)(void), boolean Size)
+{
+	double Deviation = 0;
+	double PerFix = 0;
+	int Failed = 0;
+
+	Check_Start();
+	Scenario();
+	Check_Finish();
+
+	Deviation = Check_Deviation();
+	PerFix = (double)Check_Bytes / Check_FedCount;
+	Failed = (Deviation > TRACK_TOLERANCE + TRACK_CHECK_SLACK) ||
+	         (Size == TRUE && PerFix > TRACK_CHECK_MAX_BYTES);
+
+	printf("%-9s fixes %4u  kept %3u  bytes %5lu  (%.2f per fix, %.0fx below +CGNSINF)  worst deviation %5.1f m  %s\n",
+	       Name, Check_FedCount, Check_KeptCount, (unsigned long)Check_Bytes, PerFix,
+	       TRACK_CHECK_CGNSINF_BYTES / PerFix, Deviation, Failed ? "FAIL" : "ok");
+
+	return Failed;
+}
+
+int main(void)
+{
+	int Failed = 0;
+
+	Failed |= Check_Run("straight", Check_Straight, TRUE);
+	Failed |= Check_Run("return", Check_Return, FALSE);
+	Failed |= Check_Run("reverse", Check_Reverse, FALSE);
+	Failed |= Check_Run("block", Check_Block, FALSE);
+
+	return Failed ? 1 : 0;
+}